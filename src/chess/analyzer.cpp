@@ -0,0 +1,148 @@
+#include "analyzer.h"
+
+#include <QElapsedTimer>
+
+using namespace Chess;
+
+uint64_t AnalysisInfo::nodesPerSecond() const
+{
+    return elapsedMs > 0 ? nodes * 1000 / elapsedMs : 0;
+}
+
+Analyzer::Analyzer()
+    : m_thread(&Analyzer::run, this)
+{
+}
+
+Analyzer::~Analyzer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isQuitting = true;
+        m_stopSearch = true;
+    }
+
+    m_wakeUp.notify_one();
+    m_thread.join();
+}
+
+void Analyzer::analyze(const Position &position)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingPosition = position;
+        m_isRunning = true;
+        m_generation++;
+        m_latestInfo.reset();
+        m_stopSearch = true;
+    }
+
+    m_wakeUp.notify_one();
+}
+
+void Analyzer::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingPosition.reset();
+    m_isRunning = false;
+    m_generation++;
+    m_latestInfo.reset();
+    m_stopSearch = true;
+}
+
+void Analyzer::waitForIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_searchDone.wait(lock, [this]() {
+        return !m_isSearching && !m_pendingPosition;
+    });
+}
+
+bool Analyzer::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_isRunning;
+}
+
+std::optional<AnalysisInfo> Analyzer::takeLatestInfo()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::optional<AnalysisInfo> info;
+    std::swap(info, m_latestInfo);
+
+    return info;
+}
+
+void Analyzer::run()
+{
+    Search search(&m_transpositionTable);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true)
+    {
+        m_wakeUp.wait(lock, [this]() {
+            return m_isQuitting || m_pendingPosition;
+        });
+
+        if(m_isQuitting)
+        {
+            return;
+        }
+
+        // set under the lock, a newer position can't have been missed
+        Position position = *m_pendingPosition;
+        m_pendingPosition.reset();
+        m_stopSearch = false;
+        m_isSearching = true;
+
+        uint64_t generation = m_generation;
+
+        lock.unlock();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        auto toInfo = [&](const SearchResult& result) {
+            AnalysisInfo info;
+            info.position = position;
+            info.score = position.currentPlayer() == Color::White ? result.score : -result.score;
+            info.depth = result.depth;
+            info.principalVariation = result.principalVariation;
+            info.nodes = result.nodes;
+            info.statistics = result.statistics;
+            info.elapsedMs = timer.elapsed();
+            return info;
+        };
+
+        SearchLimits limits;
+        limits.depth = MAX_PLY;
+        limits.stop = &m_stopSearch;
+        limits.onIteration = [&](const SearchResult& result) {
+            publish(toInfo(result), generation);
+        };
+
+        SearchResult result = search.search(position, limits);
+
+        // ended without being stopped, e.g. on a mate, in the tables or at the maximum depth
+        if(!result.isAborted)
+        {
+            AnalysisInfo info = toInfo(result);
+            info.isFinished = true;
+            publish(info, generation);
+        }
+
+        lock.lock();
+        m_isSearching = false;
+        m_searchDone.notify_all();
+    }
+}
+
+void Analyzer::publish(AnalysisInfo info, uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(generation == m_generation)
+    {
+        m_latestInfo = std::move(info);
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include "chess.h"
+#include "search.h"
+#include "transpositiontable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Chess
+{
+
+// What the analysis knows about a position so far, from its deepest completed iteration
+struct AnalysisInfo
+{
+    // The analyzed position, the principal variation starts from here
+    Position position;
+
+    // From white's point of view
+    int score = 0;
+    int depth = 0;
+    QVector<Move> principalVariation;
+
+    uint64_t nodes = 0;
+    qint64 elapsedMs = 0;
+
+    SearchStatistics statistics;
+
+    // No deeper result is coming, the search ended on its own
+    bool isFinished = false;
+
+    uint64_t nodesPerSecond() const;
+};
+
+// Searches a position on a thread of its own without any limit, until another position is set or it is stopped.
+// A new position aborts the running search right away and starts the next one with the transposition table
+// of the previous, so moves along the analyzed line come back at depth quickly.
+// Results aren't pushed anywhere, only the latest one is kept to be taken at whatever rate the caller likes.
+class Analyzer
+{
+public:
+    Analyzer();
+
+    // Aborts the search and joins the thread
+    ~Analyzer();
+
+    Analyzer(const Analyzer&) = delete;
+    Analyzer& operator=(const Analyzer&) = delete;
+
+    void analyze(const Position& position);
+    void stop();
+
+    // Blocks until the thread is done with the search it is running, if any. Analysis only ends
+    // on its own in rare cases, so this is meant to follow stop.
+    void waitForIdle();
+
+    bool isRunning() const;
+
+    // The latest result if there is one that wasn't taken before. Results of a position from before the last
+    // analyze or stop call are never returned.
+    std::optional<AnalysisInfo> takeLatestInfo();
+private:
+    void run();
+    void publish(AnalysisInfo info, uint64_t generation);
+private:
+    TranspositionTable m_transpositionTable;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+
+    std::optional<Position> m_pendingPosition;
+    bool m_isRunning = false;
+    bool m_isQuitting = false;
+
+    // The thread is inside a search, unlike m_isRunning this stays set until the search returns
+    bool m_isSearching = false;
+    std::condition_variable m_searchDone;
+
+    // Counts analyze and stop calls, results of older searches are dropped
+    uint64_t m_generation = 0;
+
+    std::optional<AnalysisInfo> m_latestInfo;
+
+    std::atomic<bool> m_stopSearch{false};
+
+    std::thread m_thread;
+};
+
+}
+
+#endif // ANALYZER_H
@@ -0,0 +1,54 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "chess.h"
+#include "search.h"
+
+#include <cstdint>
+
+namespace Chess
+{
+
+// Openings, middlegames, endgames and positions with checks, promotions, castling and en passant,
+// so a change to any part of the move generation or the search shows up in the node counts.
+const QVector<QString>& benchPositions();
+
+struct BenchResult
+{
+    int depth = 0;
+    int positionCount = 0;
+
+    uint64_t nodes = 0;
+    qint64 elapsedMs = 0;
+
+    // Hash of the node count and best move of every position. The same on every machine and build for the
+    // same search, a different one means the search or the move generation changed what it does.
+    uint64_t signature = 0;
+
+    // Summed over all positions
+    SearchStatistics statistics;
+
+    double nodesPerSecond() const;
+};
+
+// Searches every bench position to the depth, each with an empty transposition table.
+// Loaded tablebases change the node counts, the signature is only comparable without them.
+BenchResult runBench(int depth, const SearchFeatures& features = SearchFeatures());
+
+struct MicroBenchmark
+{
+    QString name;
+
+    uint64_t calls = 0;
+    qint64 elapsedNs = 0;
+
+    double nanosecondsPerCall() const;
+};
+
+// Calls each of getLegalMoves, doMove with undoMove, isKingInCheck, getAlgebraicNotation and
+// MoveHistory::currentPosition on the bench positions for at least the given time
+QVector<MicroBenchmark> runMicroBenchmarks(qint64 minimumMsPerBenchmark);
+
+}
+
+#endif // BENCH_H
@@ -0,0 +1,187 @@
+#include "binarydata.h"
+
+#include <QtEndian>
+
+using namespace Chess;
+
+void Chess::appendUInt16(QByteArray &data, uint16_t value)
+{
+    char bytes[2];
+    qToLittleEndian<quint16>(value, bytes);
+    data.append(bytes, sizeof(bytes));
+}
+
+void Chess::appendUInt32(QByteArray &data, uint32_t value)
+{
+    char bytes[4];
+    qToLittleEndian<quint32>(value, bytes);
+    data.append(bytes, sizeof(bytes));
+}
+
+void Chess::appendUInt64(QByteArray &data, uint64_t value)
+{
+    char bytes[8];
+    qToLittleEndian<quint64>(value, bytes);
+    data.append(bytes, sizeof(bytes));
+}
+
+void Chess::appendVarint(QByteArray &data, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        data.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    data.append(static_cast<char>(value));
+}
+
+void Chess::appendString(QByteArray &data, const QString &string)
+{
+    QByteArray utf8 = string.toUtf8();
+    appendVarint(data, utf8.size());
+    data.append(utf8);
+}
+
+BinaryReader::BinaryReader(const uchar *data, size_t size)
+    : m_data(data),
+    m_size(size)
+{
+}
+
+bool BinaryReader::isAtEnd() const
+{
+    return m_position == m_size;
+}
+
+std::optional<uint8_t> BinaryReader::readUInt8()
+{
+    if(m_size - m_position < 1)
+    {
+        return std::nullopt;
+    }
+
+    return m_data[m_position++];
+}
+
+std::optional<uint16_t> BinaryReader::readUInt16()
+{
+    if(m_size - m_position < 2)
+    {
+        return std::nullopt;
+    }
+
+    uint16_t value = qFromLittleEndian<quint16>(m_data + m_position);
+    m_position += 2;
+    return value;
+}
+
+std::optional<uint32_t> BinaryReader::readUInt32()
+{
+    if(m_size - m_position < 4)
+    {
+        return std::nullopt;
+    }
+
+    uint32_t value = qFromLittleEndian<quint32>(m_data + m_position);
+    m_position += 4;
+    return value;
+}
+
+std::optional<uint64_t> BinaryReader::readUInt64()
+{
+    if(m_size - m_position < 8)
+    {
+        return std::nullopt;
+    }
+
+    uint64_t value = qFromLittleEndian<quint64>(m_data + m_position);
+    m_position += 8;
+    return value;
+}
+
+std::optional<uint64_t> BinaryReader::readVarint()
+{
+    uint64_t value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        std::optional<uint8_t> byte = readUInt8();
+        if(!byte)
+        {
+            return std::nullopt;
+        }
+
+        value |= static_cast<uint64_t>(*byte & 0x7f) << shift;
+        if(!(*byte & 0x80))
+        {
+            return value;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<QString> BinaryReader::readString()
+{
+    std::optional<uint64_t> size = readVarint();
+    if(!size || *size > m_size - m_position)
+    {
+        return std::nullopt;
+    }
+
+    QString string = QString::fromUtf8(reinterpret_cast<const char*>(m_data + m_position), *size);
+    m_position += *size;
+    return string;
+}
+
+static int squareIndex(QPoint pos)
+{
+    return pos.y() * Board::WIDTH + pos.x();
+}
+
+static QPoint squareFromIndex(int index)
+{
+    return QPoint(index % Board::WIDTH, index / Board::WIDTH);
+}
+
+static uint16_t promotionIndex(uint8_t flags)
+{
+    if(flags & PromotionKnight) return 1;
+    if(flags & PromotionBishop) return 2;
+    if(flags & PromotionRook) return 3;
+    if(flags & PromotionQueen) return 4;
+    return 0;
+}
+
+static uint8_t promotionFlags(int index)
+{
+    switch(index)
+    {
+    case 1: return PromotionKnight;
+    case 2: return PromotionBishop;
+    case 3: return PromotionRook;
+    case 4: return PromotionQueen;
+    default: return 0;
+    }
+}
+
+uint16_t Chess::packMove(const Move &move)
+{
+    return squareIndex(move.from) | squareIndex(move.to) << 6 | promotionIndex(move.flags) << 12;
+}
+
+std::optional<Move> Chess::unpackMove(const Position &position, uint16_t packedMove)
+{
+    QPoint from = squareFromIndex(packedMove & 0x3f);
+    QPoint to = squareFromIndex((packedMove >> 6) & 0x3f);
+    uint8_t promotion = promotionFlags((packedMove >> 12) & 0x7);
+
+    for (const Move& move : position.getLegalMoves(from)) {
+        if(move.to == to && (move.flags & PromotionAny) == promotion)
+        {
+            return move;
+        }
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,52 @@
+#ifndef BINARYDATA_H
+#define BINARYDATA_H
+
+#include "chess.h"
+
+#include <QByteArray>
+
+namespace Chess
+{
+
+// Helpers shared by game files and the network protocol. Everything is little endian,
+// strings are a varint byte count followed by UTF-8.
+
+void appendUInt16(QByteArray& data, uint16_t value);
+void appendUInt32(QByteArray& data, uint32_t value);
+void appendUInt64(QByteArray& data, uint64_t value);
+
+// 7 bits per byte, the high bit marks that another byte follows
+void appendVarint(QByteArray& data, uint64_t value);
+
+void appendString(QByteArray& data, const QString& string);
+
+// Bounds checked reading, every read fails once the data ran out
+class BinaryReader
+{
+public:
+    BinaryReader(const uchar* data, size_t size);
+
+    bool isAtEnd() const;
+
+    std::optional<uint8_t> readUInt8();
+    std::optional<uint16_t> readUInt16();
+    std::optional<uint32_t> readUInt32();
+    std::optional<uint64_t> readUInt64();
+    std::optional<uint64_t> readVarint();
+    std::optional<QString> readString();
+private:
+    const uchar* m_data;
+    size_t m_size;
+    size_t m_position = 0;
+};
+
+// A move in 16 bits, from square | to square << 6 | promotion << 12.
+// Squares count from a8 to h1 like Board does.
+uint16_t packMove(const Move& move);
+
+// Returns nothing if the packed move isn't legal in the position
+std::optional<Move> unpackMove(const Position& position, uint16_t packedMove);
+
+}
+
+#endif // BINARYDATA_H
@@ -0,0 +1,216 @@
+#include "boardrenderer.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace Chess;
+
+static constexpr std::array<PieceType, 6> ATLAS_PIECE_TYPES = {
+    PieceType::Pawn, PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen, PieceType::King,
+};
+
+BoardRenderer::BoardRenderer(QSizeF size, Color viewForPlayer, int boardWidth, int boardHeight)
+    : m_size(size),
+    m_viewForPlayer(viewForPlayer),
+    m_boardWidth(boardWidth),
+    m_boardHeight(boardHeight)
+{
+}
+
+QPoint BoardRenderer::getViewAdjustedPos(QPoint pos) const
+{
+    if(m_viewForPlayer == Color::White)
+    {
+        return pos;
+    }
+
+    int x = m_boardWidth - pos.x() - 1;
+    int y = m_boardHeight - pos.y() - 1;
+
+    return QPoint(x, y);
+}
+
+QRectF BoardRenderer::getSquareRect(QPoint pos) const
+{
+    return QRectF(getSquarePos(pos), getSquareSize());
+}
+
+QPointF BoardRenderer::getSquarePos(QPoint pos) const
+{
+    QSizeF size = getSquareSize();
+    QPoint viewPos = getViewAdjustedPos(pos);
+    float x = viewPos.x() * size.width();
+    float y = viewPos.y() * size.height();
+    return QPointF(x, y);
+}
+
+QSizeF BoardRenderer::getSquareSize() const
+{
+    float squareWidth = m_size.width() / m_boardWidth;
+    float squareHeight = m_size.height() / m_boardHeight;
+    return QSizeF(squareWidth, squareHeight);
+}
+
+QPoint BoardRenderer::getPosFromPoint(QPointF point) const
+{
+    QSizeF size = getSquareSize();
+
+    int x = std::clamp(static_cast<int>(point.x() / size.width()), 0, m_boardWidth - 1);
+    int y = std::clamp(static_cast<int>(point.y() / size.height()), 0, m_boardHeight - 1);
+
+    return getViewAdjustedPos(QPoint(x, y));
+}
+
+QSize BoardRenderer::spriteSize(qreal devicePixelRatio) const
+{
+    return (getSquareSize() * devicePixelRatio).toSize();
+}
+
+float BoardRenderer::strokeWidth() const
+{
+    return m_size.width() / 180.0f;
+}
+
+void BoardRenderer::paintSquares(QPainter &painter) const
+{
+    for (int y = 0; y < m_boardHeight; ++y) {
+        for (int x = 0; x < m_boardWidth; ++x) {
+            QRectF square = getSquareRect(QPoint(x, y));
+
+            bool isLight = (x + y) % 2 == 0;
+            QColor squareColor = isLight ? LIGHT_COLOR : DARK_COLOR;
+            painter.fillRect(square, squareColor);
+        }
+    }
+}
+
+void BoardRenderer::paintSquareOutline(QPainter &painter, QPoint pos, QColor color) const
+{
+    QRectF square = getSquareRect(pos);
+
+    QPen pen;
+    pen.setWidth(strokeWidth());
+    pen.setColor(color);
+
+    painter.setPen(pen);
+    painter.setBrush(Qt::NoBrush);
+
+    float inset = pen.widthF() / 2;
+    painter.drawRect(square.adjusted(inset, inset, -inset, -inset));
+}
+
+void BoardRenderer::paintMoveIndicator(QPainter &painter, const Move &move) const
+{
+    if(move.isCapture())
+    {
+        paintSquareOutline(painter, move.to, MOVE_INDICATOR_COLOR);
+        return;
+    }
+
+    QRectF square = getSquareRect(move.to);
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QBrush(MOVE_INDICATOR_COLOR));
+
+    float inset = square.width() / 3.0f;
+    painter.drawEllipse(square.adjusted(inset, inset, -inset, -inset));
+}
+
+QPointF BoardRenderer::snapToDevicePixels(QPointF pos, qreal devicePixelRatio) const
+{
+    return QPointF(std::round(pos.x() * devicePixelRatio) / devicePixelRatio,
+                   std::round(pos.y() * devicePixelRatio) / devicePixelRatio);
+}
+
+void BoardRenderer::paintPieceSprite(QPainter &painter, const QPixmap &atlas, Piece piece, QPointF pos) const
+{
+    QSize spriteSize(atlas.width() / ATLAS_PIECE_TYPES.size(), atlas.height() / COLOR_COUNT);
+    QPointF spritePos = snapToDevicePixels(pos, atlas.devicePixelRatio());
+
+    painter.drawPixmap(spritePos, atlas, getPieceAtlasRect(piece, spriteSize));
+}
+
+void BoardRenderer::paintPieceSprite(QPainter &painter, const QImage &atlas, Piece piece, QPointF pos) const
+{
+    QSize spriteSize(atlas.width() / ATLAS_PIECE_TYPES.size(), atlas.height() / COLOR_COUNT);
+    QPointF spritePos = snapToDevicePixels(pos, atlas.devicePixelRatio());
+
+    painter.drawImage(spritePos, atlas, getPieceAtlasRect(piece, spriteSize));
+}
+
+void BoardRenderer::paintPieces(QPainter &painter, const Board &board, const QImage &atlas) const
+{
+    for (int y = 0; y < m_boardHeight; ++y) {
+        for (int x = 0; x < m_boardWidth; ++x) {
+            QPoint pos(x, y);
+
+            auto piece = board.pieceAt(pos);
+            if(piece)
+            {
+                paintPieceSprite(painter, atlas, *piece, getSquarePos(pos));
+            }
+        }
+    }
+}
+
+QImage BoardRenderer::createPieceAtlas(QSize spriteSize)
+{
+    QImage atlas(spriteSize.width() * ATLAS_PIECE_TYPES.size(), spriteSize.height() * COLOR_COUNT, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+
+    QPainter painter(&atlas);
+    for (Color color : {Color::White, Color::Black}) {
+        for (PieceType type : ATLAS_PIECE_TYPES) {
+            Piece piece{color, type};
+
+            // scaling once here is what lets the pieces be blitted unscaled
+            QImage image(QString(":/resources/chess/%1.png").arg(getPieceKey(piece)));
+            QImage sprite = image.scaled(spriteSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            painter.drawImage(getPieceAtlasRect(piece, spriteSize).topLeft(), sprite);
+        }
+    }
+    painter.end();
+
+    return atlas;
+}
+
+QRect BoardRenderer::getPieceAtlasRect(Piece piece, QSize spriteSize)
+{
+    int column = static_cast<int>(piece.type);
+    int row = indexOfColor(piece.color);
+
+    return QRect(QPoint(column * spriteSize.width(), row * spriteSize.height()), spriteSize);
+}
+
+QString BoardRenderer::getPieceKey(Piece piece)
+{
+    switch(piece.color)
+    {
+    case Color::White:
+        switch(piece.type)
+        {
+        case PieceType::Pawn: return "white_pawn";
+        case PieceType::Knight: return "white_knight";
+        case PieceType::Bishop: return "white_bishop";
+        case PieceType::Rook: return "white_rook";
+        case PieceType::Queen: return "white_queen";
+        case PieceType::King: return "white_king";
+        }
+        break;
+    case Color::Black:
+        switch(piece.type)
+        {
+        case PieceType::Pawn: return "black_pawn";
+        case PieceType::Knight: return "black_knight";
+        case PieceType::Bishop: return "black_bishop";
+        case PieceType::Rook: return "black_rook";
+        case PieceType::Queen: return "black_queen";
+        case PieceType::King: return "black_king";
+        }
+        break;
+    }
+    return "";
+}
@@ -0,0 +1,71 @@
+#ifndef BOARDRENDERER_H
+#define BOARDRENDERER_H
+
+#include "chess.h"
+
+#include <QImage>
+#include <QPixmap>
+
+class QPainter;
+
+namespace Chess
+{
+
+// Board geometry and painting for any paint device, independent of a widget.
+// BoardView paints through it on screen and the offscreen renderer into QImages,
+// so both draw exactly the same board. Only the QImage functions may be used outside the GUI thread.
+class BoardRenderer
+{
+public:
+    static constexpr QColor LIGHT_COLOR = QColor(150, 120, 75);
+    static constexpr QColor DARK_COLOR = QColor(100, 80, 50);
+    static constexpr QColor MOVE_INDICATOR_COLOR = QColor(20, 60, 40);
+
+    // Size is in logical pixels, the painter's device decides the pixel ratio
+    BoardRenderer(QSizeF size, Color viewForPlayer, int boardWidth = Board::WIDTH, int boardHeight = Board::HEIGHT);
+
+    // Positioning
+    QPoint getViewAdjustedPos(QPoint pos) const;
+    QRectF getSquareRect(QPoint pos) const;
+    QPointF getSquarePos(QPoint pos) const;
+    QSizeF getSquareSize() const;
+    QPoint getPosFromPoint(QPointF point) const;
+
+    // Size of a piece sprite in device pixels
+    QSize spriteSize(qreal devicePixelRatio) const;
+
+    // Painting
+    float strokeWidth() const;
+
+    void paintSquares(QPainter& painter) const;
+
+    // Outlines are drawn inset, so nothing is painted outside the square
+    void paintSquareOutline(QPainter& painter, QPoint pos, QColor color) const;
+    void paintMoveIndicator(QPainter& painter, const Move& move) const;
+
+    // Draws the piece from an atlas of createPieceAtlas at a logical position,
+    // snapped to whole device pixels so the sprite isn't resampled
+    void paintPieceSprite(QPainter& painter, const QPixmap& atlas, Piece piece, QPointF pos) const;
+    void paintPieceSprite(QPainter& painter, const QImage& atlas, Piece piece, QPointF pos) const;
+
+    void paintPieces(QPainter& painter, const Board& board, const QImage& atlas) const;
+
+    // All twelve piece images pre-scaled to the sprite size, one row per color.
+    // Works on QImage only, so it is safe to call from any thread.
+    static QImage createPieceAtlas(QSize spriteSize);
+    static QRect getPieceAtlasRect(Piece piece, QSize spriteSize);
+
+    // Name of the piece image in the resources, e.g. "white_knight"
+    static QString getPieceKey(Piece piece);
+private:
+    QPointF snapToDevicePixels(QPointF pos, qreal devicePixelRatio) const;
+private:
+    QSizeF m_size;
+    Color m_viewForPlayer;
+    int m_boardWidth;
+    int m_boardHeight;
+};
+
+}
+
+#endif // BOARDRENDERER_H
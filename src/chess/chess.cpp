@@ -1,6 +1,19 @@
 #include "chess.h"
+#include "analyzer.h"
+#include "boardrenderer.h"
+#include "chessclock.h"
+#include "evaluation.h"
+#include "gamefile.h"
+#include "gameserver.h"
+#include "networkclient.h"
+#include "openingbook.h"
+#include "profiler.h"
+#include "search.h"
+#include "tablebase.h"
+#include "zobrist.h"
 
 #include <cassert>
+#include <cmath>
 #include <random>
 
 #include <QLabel>
@@ -23,6 +36,10 @@
 #include <QGroupBox>
 #include <QComboBox>
 #include <QFormLayout>
+#include <QLineEdit>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QPushButton>
 
 #include <QTimer>
 
@@ -148,7 +165,9 @@ std::optional<Piece> &Board::pieceAt(QPoint pos)
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
     m_currentPosition(),
-    m_history(m_currentPosition)
+    m_history(m_currentPosition),
+    m_openingBook(std::make_unique<OpeningBook>()),
+    m_clock(std::make_unique<ChessClock>())
 {
     setFixedSize(1600, 900);
     setWindowTitle("Chess");
@@ -163,9 +182,13 @@ MainWindow::MainWindow(QWidget *parent)
     auto newGameAction = new QAction("&New");
     auto saveAction = new QAction(style->standardIcon(QStyle::SP_DialogSaveButton), "&Save");
     auto loadAction = new QAction(style->standardIcon(QStyle::SP_DialogOpenButton), "&Load");
+    auto hostServerAction = new QAction("&Host Server");
     auto exitAction = new QAction(style->standardIcon(QStyle::SP_DialogCloseButton), "&Exit");
 
     connect(newGameAction, &QAction::triggered, this, &MainWindow::onNewAction);
+    connect(saveAction, &QAction::triggered, this, &MainWindow::onSaveAction);
+    connect(loadAction, &QAction::triggered, this, &MainWindow::onLoadAction);
+    connect(hostServerAction, &QAction::triggered, this, &MainWindow::onHostServerAction);
     connect(exitAction, &QAction::triggered, this, &QApplication::quit);
 
 
@@ -173,10 +196,23 @@ MainWindow::MainWindow(QWidget *parent)
     fileMenu->addAction(saveAction);
     fileMenu->addAction(loadAction);
     fileMenu->addSeparator();
+    fileMenu->addAction(hostServerAction);
+    fileMenu->addSeparator();
     fileMenu->addAction(exitAction);
 
     menuBar->addMenu(fileMenu);
 
+    auto analysisMenu = new QMenu("&Analysis");
+
+    auto liveAnalysisAction = new QAction("&Live Analysis");
+    liveAnalysisAction->setCheckable(true);
+
+    connect(liveAnalysisAction, &QAction::toggled, this, &MainWindow::onLiveAnalysisToggled);
+
+    analysisMenu->addAction(liveAnalysisAction);
+
+    menuBar->addMenu(analysisMenu);
+
     setMenuBar(menuBar);
 
     // Board
@@ -187,9 +223,42 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(m_boardView, &BoardView::squareClicked, this, &MainWindow::onSquareClicked);
 
+    // Clocks
+
+    auto clockBox = new QGroupBox("Clocks");
+    clockBox->setFixedSize(360, 100);
+
+    auto clockLayout = new QVBoxLayout();
+
+    m_clockView = new ClockView();
+    m_clockView->setClock(m_clock.get());
+
+    clockLayout->addWidget(m_clockView);
+
+    clockBox->setLayout(clockLayout);
+
+    m_flagTimer = new QTimer(this);
+    m_flagTimer->setSingleShot(true);
+    m_flagTimer->setTimerType(Qt::PreciseTimer);
+
+    connect(m_flagTimer, &QTimer::timeout, this, &MainWindow::onFlagTimeout);
+
+    // Analysis
+
+    auto analysisBox = new QGroupBox("Analysis");
+    analysisBox->setFixedSize(360, 190);
+
+    auto analysisLayout = new QVBoxLayout();
+
+    m_analysisPanel = new AnalysisPanel();
+
+    analysisLayout->addWidget(m_analysisPanel);
+
+    analysisBox->setLayout(analysisLayout);
+
     // History
     auto historyBox = new QGroupBox("History");
-    historyBox->setFixedSize(360, 720);
+    historyBox->setFixedSize(360, 420);
 
     auto historyLayout = new QVBoxLayout();
 
@@ -205,21 +274,38 @@ MainWindow::MainWindow(QWidget *parent)
     auto centralWidget = new QWidget();
     auto centralLayout = new QHBoxLayout();
 
+    auto sideLayout = new QVBoxLayout();
+    sideLayout->addWidget(clockBox);
+    sideLayout->addWidget(analysisBox);
+    sideLayout->addWidget(historyBox);
+
     centralLayout->addWidget(m_boardView);
-    centralLayout->addWidget(historyBox);
+    centralLayout->addLayout(sideLayout);
 
     centralWidget->setLayout(centralLayout);
 
     setCentralWidget(centralWidget);
 }
 
+MainWindow::~MainWindow()
+{
+    // a search still running would post its result to a deleted window
+    cancelBotSearch();
+    m_searchPool.waitForDone();
+
+    m_analysisPanel->setAnalyzer(nullptr);
+}
+
 void MainWindow::onSquareClicked(QPoint pos)
 {
-    if(!isHumansTurn())
+    if(m_isWaitingForOpponent || m_isOutOfTime || !isHumansTurn())
     {
         return;
     }
 
+    m_boardView->resetPaintCount();
+    BoardView::UpdateBatch batch(m_boardView);
+
     if(!m_selectedPos)
     {
         selectPieceAt(pos);
@@ -240,11 +326,241 @@ void MainWindow::onNewAction()
     }
 }
 
+void MainWindow::onSaveAction()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Save Game", QString(), "Chess games (*.chessgame);;Game archives (*.chessarchive)");
+    if(path.isEmpty())
+    {
+        return;
+    }
+
+    SavedGame game{m_matchSettings, m_history};
+
+    // an archive is saved with the current game as its only entry
+    bool isSaved = path.endsWith(".chessarchive") ? GameArchive::write(path, {game}) : saveGame(path, game);
+    if(!isSaved)
+    {
+        QMessageBox::warning(this, "Save Game", QString("Could not save the game to %1").arg(path));
+    }
+}
+
+void MainWindow::onLoadAction()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Load Game", QString(), "Chess games (*.chessgame *.chessarchive)");
+    if(path.isEmpty())
+    {
+        return;
+    }
+
+    std::optional<SavedGame> game;
+
+    if(path.endsWith(".chessarchive"))
+    {
+        GameArchive archive;
+        if(archive.open(path) && archive.gameCount() > 0)
+        {
+            bool isAccepted = false;
+            int number = QInputDialog::getInt(this, "Load Game", QString("Game (1 - %1):").arg(archive.gameCount()),
+                                              1, 1, archive.gameCount(), 1, &isAccepted);
+            if(!isAccepted)
+            {
+                return;
+            }
+
+            game = archive.game(number - 1);
+        }
+    }
+    else
+    {
+        game = loadGame(path);
+    }
+
+    if(!game)
+    {
+        QMessageBox::warning(this, "Load Game", QString("Could not load a game from %1").arg(path));
+        return;
+    }
+
+    startGame(game->settings, game->history);
+}
+
+void MainWindow::onHostServerAction()
+{
+    if(m_gameServer)
+    {
+        QMessageBox::information(this, "Host Server", QString("Already hosting games on port %1.").arg(m_gameServer->serverPort()));
+        return;
+    }
+
+    m_gameServer = std::make_unique<GameServer>();
+    if(!m_gameServer->listen(QHostAddress::Any, GameServer::DEFAULT_PORT))
+    {
+        QMessageBox::warning(this, "Host Server", QString("Could not start the server: %1").arg(m_gameServer->errorString()));
+        m_gameServer.reset();
+        return;
+    }
+
+    QMessageBox::information(this, "Host Server", QString("Hosting games on port %1.").arg(m_gameServer->serverPort()));
+}
+
+void MainWindow::onNetworkGameJoined(uint32_t gameId, Color color)
+{
+    // the creator of a game picks the colors, whoever joins plays the one that is left
+    PlayerType localPlayer = m_matchSettings.white == PlayerType::Network ? m_matchSettings.black : m_matchSettings.white;
+    m_matchSettings.white = color == Color::White ? localPlayer : PlayerType::Network;
+    m_matchSettings.black = color == Color::Black ? localPlayer : PlayerType::Network;
+
+    m_boardView->setViewForPlayer(color);
+    setWindowTitle(QString("Chess - Network Game %1").arg(gameId));
+}
+
+void MainWindow::onNetworkGameWatched(uint32_t gameId)
+{
+    setWindowTitle(QString("Chess - Watching Network Game %1").arg(gameId));
+}
+
+void MainWindow::onNetworkGameStarted()
+{
+    m_isWaitingForOpponent = false;
+
+    // spectators may join a running game, it is shown from the server's position on
+    m_history = MoveHistory(m_networkClient->position());
+    m_currentPosition = m_history.headPosition();
+
+    BoardView::UpdateBatch batch(m_boardView);
+
+    m_boardView->setBoard(&m_currentPosition.board());
+    m_historyView->setHistory(&m_history);
+
+    showCheckIndicator();
+    startClock();
+    updateLiveAnalysis();
+
+    if(!isHumansTurn())
+    {
+        doAiMove();
+    }
+}
+
+void MainWindow::onNetworkMoveReceived(const Move &move)
+{
+    if(getCurrentPlayerType() != PlayerType::Network || !m_currentPosition.getLegalMoves().contains(move))
+    {
+        onNetworkGameEnded(QString("The server sent the unexpected move %1.").arg(getUciNotation(move)));
+        return;
+    }
+
+    playMove(move);
+}
+
+void MainWindow::onNetworkGameEnded(const QString &message)
+{
+    if(!m_networkClient)
+    {
+        return;
+    }
+
+    // called from the client's signals, so it can't be deleted right away
+    m_networkClient->disconnect(this);
+    m_networkClient.release()->deleteLater();
+
+    m_isWaitingForOpponent = true;
+
+    QMessageBox::information(this, "Network Game", message);
+}
+
+void MainWindow::startNetworkGame()
+{
+    m_isWaitingForOpponent = true;
+    setWindowTitle("Chess - Waiting for Opponent");
+
+    m_networkClient = std::make_unique<NetworkClient>();
+
+    connect(m_networkClient.get(), &NetworkClient::connected, this, [this]() {
+        bool isSpectating = m_matchSettings.white == PlayerType::Network && m_matchSettings.black == PlayerType::Network;
+        if(isSpectating && !m_matchSettings.networkGameId)
+        {
+            onNetworkGameEnded("Enter the network game to watch.");
+        }
+        else if(isSpectating)
+        {
+            m_networkClient->watchGame(*m_matchSettings.networkGameId);
+        }
+        else if(m_matchSettings.networkGameId)
+        {
+            m_networkClient->joinGame(*m_matchSettings.networkGameId);
+        }
+        else
+        {
+            m_networkClient->createGame(m_matchSettings.white == PlayerType::Network ? Color::Black : Color::White);
+        }
+    });
+
+    connect(m_networkClient.get(), &NetworkClient::gameJoined, this, &MainWindow::onNetworkGameJoined);
+    connect(m_networkClient.get(), &NetworkClient::watchingGame, this, &MainWindow::onNetworkGameWatched);
+    connect(m_networkClient.get(), &NetworkClient::gameStarted, this, &MainWindow::onNetworkGameStarted);
+    connect(m_networkClient.get(), &NetworkClient::moveReceived, this, &MainWindow::onNetworkMoveReceived);
+    connect(m_networkClient.get(), &NetworkClient::playerLeft, this, [this]() {
+        onNetworkGameEnded("A player left the game.");
+    });
+    connect(m_networkClient.get(), &NetworkClient::errorReceived, this, &MainWindow::onNetworkGameEnded);
+
+    m_networkClient->connectToServer(m_matchSettings.serverHost, m_matchSettings.serverPort);
+}
+
 void MainWindow::startNewGame(const MatchSettings &settings)
+{
+    startGame(settings, MoveHistory(Position()));
+}
+
+void MainWindow::startGame(const MatchSettings &settings, const MoveHistory &history)
 {
     m_matchSettings = settings;
 
-    m_currentPosition = Position();
+    m_openingBook->close();
+    if(!settings.openingBookPath.isEmpty() && !m_openingBook->open(settings.openingBookPath))
+    {
+        QMessageBox::warning(this, "Opening Book", QString("Could not open the opening book %1").arg(settings.openingBookPath));
+    }
+
+    m_bookRandom.seed(settings.openingBookSeed ? *settings.openingBookSeed : std::random_device()());
+
+    cancelBotSearch();
+
+    Tablebases& tablebases = Tablebases::instance();
+    if(settings.tablebasePath != tablebases.directory())
+    {
+        // the bot and the analysis probe the tables, neither may be searching while they are unmapped
+        m_searchPool.waitForDone();
+        if(m_analyzer)
+        {
+            m_analyzer->stop();
+            m_analyzer->waitForIdle();
+        }
+
+        if(settings.tablebasePath.isEmpty())
+        {
+            tablebases.unload();
+        }
+        else if(tablebases.load(settings.tablebasePath) == 0)
+        {
+            QMessageBox::warning(this, "Tablebases", QString("No endgame tables found in %1").arg(settings.tablebasePath));
+        }
+    }
+
+    m_selectedPos.reset();
+    m_networkClient.reset();
+    m_isWaitingForOpponent = false;
+    setWindowTitle("Chess");
+
+    stopClock();
+    *m_clock = ChessClock(settings.timeControl);
+    m_isOutOfTime = false;
+
+    m_history = history;
+    m_currentPosition = m_history.headPosition();
+
+    BoardView::UpdateBatch batch(m_boardView);
 
     m_boardView->clearHighlights();
     m_boardView->clearMoveIndicators();
@@ -253,9 +569,25 @@ void MainWindow::startNewGame(const MatchSettings &settings)
     Color startingPlayer = m_currentPosition.currentPlayer();
     m_boardView->setViewForPlayer(startingPlayer);
 
-    m_history.clear();
     m_historyView->setHistory(&m_history);
 
+    if(isNetworkGame())
+    {
+        startNetworkGame();
+        return;
+    }
+
+    // a loaded game may already be over
+    if(isGameOver())
+    {
+        showGameResult();
+        return;
+    }
+
+    showCheckIndicator();
+    startClock();
+    updateLiveAnalysis();
+
     if(!isHumansTurn())
     {
         doAiMove();
@@ -269,15 +601,10 @@ void MainWindow::selectPieceAt(QPoint pos)
     {
         m_selectedPos = pos;
 
-        m_boardView->clearHighlights();
-        m_boardView->clearMoveIndicators();
-
-        QVector<Move> legalMoves = m_currentPosition.getLegalMoves(pos);
-        for (const Move& move : legalMoves) {
-            m_boardView->addMoveIndicator(move);
-        }
+        BoardView::UpdateBatch batch(m_boardView);
 
-        m_boardView->addHighlight(pos, Qt::white);
+        m_boardView->setMoveIndicators(m_currentPosition.getLegalMoves(pos));
+        m_boardView->setHighlights({BoardView::Highlight{pos, Qt::white}});
 
         showCheckIndicator();
     }
@@ -285,12 +612,37 @@ void MainWindow::selectPieceAt(QPoint pos)
 
 void MainWindow::playMove(Move move)
 {
+    if(m_isOutOfTime)
+    {
+        return;
+    }
+
+    // the flag check may not have fired yet, a move made too late still loses
+    Color player = m_currentPosition.currentPlayer();
+    if(!m_clock->punch())
+    {
+        loseOnTime(player);
+        return;
+    }
+
+    scheduleFlagCheck();
+    m_clockView->updateClock();
+
+    if(m_networkClient && getCurrentPlayerType() != PlayerType::Network)
+    {
+        m_networkClient->sendMove(move);
+    }
+
+    BoardView::UpdateBatch batch(m_boardView);
+
     m_currentPosition.doMove(move);
-    m_boardView->update();
+    m_boardView->animateMove(move);
 
     m_history.addMove(move);
     m_historyView->setHistory(&m_history);
 
+    updateLiveAnalysis();
+
     m_boardView->clearHighlights();
     m_boardView->clearMoveIndicators();
 
@@ -298,10 +650,19 @@ void MainWindow::playMove(Move move)
 
     if(isGameOver())
     {
+        stopClock();
         showGameResult();
         return;
     }
 
+    if(std::optional<GameResult> result = tablebaseAdjudication())
+    {
+        stopClock();
+        m_boardView->clearHighlights();
+        showGameResult(*result);
+        return;
+    }
+
     if(!isHumansTurn())
     {
         doAiMove();
@@ -377,7 +738,6 @@ void MainWindow::showGameResult()
 {
     m_boardView->clearHighlights();
     m_boardView->clearMoveIndicators();
-    m_boardView->repaint();
 
     if(m_currentPosition.isKingInCheck(Color::White))
     {
@@ -434,6 +794,10 @@ void MainWindow::showGameResult(GameResult gameResult)
     case EndReason::Resignation:
         msgBox->setText(QString("%1 wins by RESIGNATION").arg(winner));
         break;
+    case EndReason::TablebaseAdjudication:
+        msgBox->setText(gameResult.winner ? QString("%1 wins by TABLEBASE ADJUDICATION").arg(winner)
+                                          : QString("The game ends in a DRAW by TABLEBASE ADJUDICATION."));
+        break;
     }
 
     msgBox->show();
@@ -444,6 +808,32 @@ bool MainWindow::isGameOver() const
     return m_currentPosition.getLegalMoves().empty();
 }
 
+std::optional<GameResult> MainWindow::tablebaseAdjudication() const
+{
+    bool isBotGame = m_matchSettings.white != PlayerType::Human && m_matchSettings.black != PlayerType::Human;
+    if(!isBotGame || !m_matchSettings.adjudicateWithTablebases)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Wdl> wdl = Tablebases::instance().probeWdl(m_currentPosition);
+    if(!wdl)
+    {
+        return std::nullopt;
+    }
+
+    Color currentPlayer = m_currentPosition.currentPlayer();
+
+    switch(*wdl)
+    {
+    case Wdl::Win: return GameResult{EndReason::TablebaseAdjudication, currentPlayer};
+    case Wdl::Loss: return GameResult{EndReason::TablebaseAdjudication, oppositeColor(currentPlayer)};
+    case Wdl::Draw: return GameResult{EndReason::TablebaseAdjudication};
+    }
+
+    return std::nullopt;
+}
+
 PlayerType MainWindow::getCurrentPlayerType() const
 {
     Color currentPlayer = m_currentPosition.currentPlayer();
@@ -455,6 +845,11 @@ bool MainWindow::isHumansTurn() const
     return getCurrentPlayerType() == PlayerType::Human;
 }
 
+bool MainWindow::isNetworkGame() const
+{
+    return m_matchSettings.white == PlayerType::Network || m_matchSettings.black == PlayerType::Network;
+}
+
 Move calculateMove_EasyAI(Position position)
 {
     QVector<Move> legalMoves = position.getLegalMoves();
@@ -486,69 +881,203 @@ void MainWindow::doAiMove()
 
     }
     break;
+    case PlayerType::HardBot:
+    {
+        QTimer::singleShot(1, this, [this]() {
+            if(std::optional<Move> move = tryBookMove())
+            {
+                playMove(*move);
+                return;
+            }
+
+            startBotSearch();
+        });
+    }
+    break;
+    case PlayerType::Network:
+    {
+        // onNetworkMoveReceived plays the move once the server sends it
+    }
+    break;
     }
 }
 
-static QString getPieceKey(Piece piece)
+void MainWindow::startBotSearch()
 {
-    switch(piece.color)
+    static constexpr int UNTIMED_DEPTH = 3;
+
+    SearchLimits limits;
+    limits.depth = UNTIMED_DEPTH;
+
+    const TimeControl& timeControl = m_clock->timeControl();
+    if(timeControl.isTimed())
     {
-    case Color::White:
-        switch(piece.type)
-        {
-        case PieceType::Pawn: return "white_pawn";
-        case PieceType::Knight: return "white_knight";
-        case PieceType::Bishop: return "white_bishop";
-        case PieceType::Rook: return "white_rook";
-        case PieceType::Queen: return "white_queen";
-        case PieceType::King: return "white_king";
-        }
-        break;
-    case Color::Black:
-        switch(piece.type)
-        {
-        case PieceType::Pawn: return "black_pawn";
-        case PieceType::Knight: return "black_knight";
-        case PieceType::Bishop: return "black_bishop";
-        case PieceType::Rook: return "black_rook";
-        case PieceType::Queen: return "black_queen";
-        case PieceType::King: return "black_king";
-        }
-        break;
+        Color player = m_currentPosition.currentPlayer();
+        MoveTimeBudget budget = allocateMoveTime(timeControl, m_clock->remainingMs(player), m_clock->movesPlayed(player));
+
+        // iterative deepening goes as deep as the time allows
+        limits.depth = MAX_PLY;
+        limits.softTimeMs = budget.softMs;
+        limits.hardTimeMs = budget.hardMs;
     }
-    return "";
+
+    cancelBotSearch();
+
+    m_stopSearch = std::make_shared<std::atomic<bool>>(false);
+    uint64_t generation = m_searchGeneration;
+
+    m_searchPool.start([this, position = m_currentPosition, limits, stop = m_stopSearch, generation]() mutable {
+        limits.stop = stop.get();
+        SearchResult result = Search().search(position, limits);
+
+        QMetaObject::invokeMethod(this, [this, result, generation]() {
+            if(generation == m_searchGeneration && result.bestMove)
+            {
+                playMove(*result.bestMove);
+            }
+        }, Qt::QueuedConnection);
+    });
 }
 
-QPixmap BoardView::getPiecePixmap(Piece piece)
+void MainWindow::cancelBotSearch()
 {
-    QString key = getPieceKey(piece);
-
-    QPixmap pixmap;
-    if(!QPixmapCache::find(key, &pixmap))
+    if(m_stopSearch)
     {
-        auto resourcePath = QString(":/resources/chess/%1.png").arg(key);
-        pixmap = QPixmap(resourcePath);
-        QPixmapCache::insert(key, pixmap);
+        *m_stopSearch = true;
+        m_stopSearch.reset();
     }
 
-    return pixmap;
+    m_searchGeneration++;
 }
 
-//static void paintSomething(QPaintEvent *event)
-//{
-//    QPainter painter(this);
-//    painter.setRenderHint(QPainter::Antialiasing);
-
-//    QRectF widgetRect = rect().toRectF();
+void MainWindow::startClock()
+{
+    if(m_clock->timeControl().isTimed())
+    {
+        m_clock->start(m_currentPosition.currentPlayer());
+        scheduleFlagCheck();
+    }
 
-//    QColor lightColor = QColor(150, 120, 75);
-//    QColor darkColor = QColor(100, 60, 50);
-//    QColor backgroundColor = m_squareColor == Light ? lightColor : darkColor;
-//    painter.fillRect(widgetRect, backgroundColor);
+    m_clockView->updateClock();
+}
 
+void MainWindow::scheduleFlagCheck()
+{
+    std::optional<Color> player = m_clock->runningPlayer();
+    if(!player || !m_clock->timeControl().isTimed())
+    {
+        m_flagTimer->stop();
+        return;
+    }
 
-//    if(m_highlightColor)
-//    {
+    // rounded up, firing early only means checking again
+    auto remaining = m_clock->remaining(*player);
+    m_flagTimer->start(static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count()));
+}
+
+void MainWindow::stopClock()
+{
+    m_clock->stop();
+    m_flagTimer->stop();
+    m_clockView->updateClock();
+}
+
+void MainWindow::onFlagTimeout()
+{
+    std::optional<Color> player = m_clock->runningPlayer();
+    if(!player || m_isOutOfTime)
+    {
+        return;
+    }
+
+    if(!m_clock->isOutOfTime(*player))
+    {
+        scheduleFlagCheck();
+        return;
+    }
+
+    loseOnTime(*player);
+}
+
+void MainWindow::loseOnTime(Color player)
+{
+    m_isOutOfTime = true;
+
+    cancelBotSearch();
+    stopClock();
+
+    m_selectedPos.reset();
+    m_boardView->clearMoveIndicators();
+
+    showGameResult(GameResult{EndReason::OutOfTime, oppositeColor(player)});
+}
+
+void MainWindow::onLiveAnalysisToggled(bool isEnabled)
+{
+    m_isLiveAnalysisEnabled = isEnabled;
+
+    // the thread and its transposition table are only worth having once someone wants analysis
+    if(isEnabled && !m_analyzer)
+    {
+        m_analyzer = std::make_unique<Analyzer>();
+        m_analysisPanel->setAnalyzer(m_analyzer.get());
+    }
+
+    if(!isEnabled && m_analyzer)
+    {
+        m_analyzer->stop();
+    }
+
+    updateLiveAnalysis();
+}
+
+void MainWindow::updateLiveAnalysis()
+{
+    if(m_isLiveAnalysisEnabled)
+    {
+        m_analyzer->analyze(m_currentPosition);
+    }
+
+    m_analysisPanel->updateAnalysis();
+}
+
+std::optional<Move> MainWindow::tryBookMove()
+{
+    return m_openingBook->pickMove(m_currentPosition, m_bookRandom);
+}
+
+QPixmap BoardView::getPieceAtlas(QSize spriteSize, qreal devicePixelRatio)
+{
+    QString key = QString("piece_atlas_%1x%2@%3").arg(spriteSize.width()).arg(spriteSize.height()).arg(devicePixelRatio);
+
+    QPixmap atlas;
+    if(QPixmapCache::find(key, &atlas))
+    {
+        return atlas;
+    }
+
+    atlas = QPixmap::fromImage(BoardRenderer::createPieceAtlas(spriteSize));
+    atlas.setDevicePixelRatio(devicePixelRatio);
+    QPixmapCache::insert(key, atlas);
+
+    return atlas;
+}
+
+//static void paintSomething(QPaintEvent *event)
+//{
+//    QPainter painter(this);
+//    painter.setRenderHint(QPainter::Antialiasing);
+
+//    QRectF widgetRect = rect().toRectF();
+
+//    QColor lightColor = QColor(150, 120, 75);
+//    QColor darkColor = QColor(100, 60, 50);
+//    QColor backgroundColor = m_squareColor == Light ? lightColor : darkColor;
+//    painter.fillRect(widgetRect, backgroundColor);
+
+
+//    if(m_highlightColor)
+//    {
 
 //        QPen pen;
 //        pen.setWidth(5);
@@ -561,14 +1090,41 @@ QPixmap BoardView::getPiecePixmap(Piece piece)
 
 BoardView::BoardView(const Board *board, QWidget *parent)
     : QWidget(parent),
-    m_board(board)
+    m_board(board),
+    m_animation(new QVariantAnimation(this))
 {
     setMouseTracking(true);
+
+    // QVariantAnimation runs on Qt's shared animation timer, a plain timer of about 16 ms that isn't tied
+    // to the display's refresh. Any number of boards animate off that single timer.
+    m_animation->setStartValue(0.0);
+    m_animation->setEndValue(1.0);
+    m_animation->setEasingCurve(QEasingCurve::OutCubic);
+
+    connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant& value) {
+        onAnimationFrame(value.toReal());
+    });
+    connect(m_animation, &QVariantAnimation::finished, this, &BoardView::onAnimationFinished);
 }
 
 void BoardView::setViewForPlayer(Color color)
 {
+    // flipping the board mid animation would make the piece jump, flip once it has landed
+    if(isAnimating())
+    {
+        m_pendingViewForPlayer = color;
+        return;
+    }
+
+    m_pendingViewForPlayer.reset();
+
+    if(m_viewForPlayer == color)
+    {
+        return;
+    }
+
     m_viewForPlayer = color;
+    m_boardLayer = QPixmap();
 
     if(m_hoveredPos)
     {
@@ -577,42 +1133,252 @@ void BoardView::setViewForPlayer(Color color)
         m_hoveredPos = QPoint(flippedX, flippedY);
     }
 
-    update();
+    invalidate(rect());
 }
 
 void BoardView::setBoard(const Board *board)
 {
+    finishAnimation();
+
     m_board = board;
 
-    update();
+    invalidate(rect());
 }
 
 void BoardView::addHighlight(QPoint pos, QColor color)
 {
     m_highlights.append(Highlight{pos, color});
 
-    update();
+    updateSquare(pos);
+}
+
+void BoardView::setHighlights(const QVector<Highlight> &highlights)
+{
+    UpdateBatch batch(this);
+
+    clearHighlights();
+
+    for (const Highlight& highlight : highlights) {
+        addHighlight(highlight.pos, highlight.color);
+    }
 }
 
 void BoardView::addMoveIndicator(const Move& move)
 {
     m_moves.append(move);
 
-    update();
+    updateSquare(move.to);
+}
+
+void BoardView::setMoveIndicators(const QVector<Move> &moves)
+{
+    UpdateBatch batch(this);
+
+    clearMoveIndicators();
+
+    for (const Move& move : moves) {
+        addMoveIndicator(move);
+    }
 }
 
 void BoardView::clearMoveIndicators()
 {
-    m_moves.clear();
+    for (const Move& move : m_moves) {
+        updateSquare(move.to);
+    }
 
-    update();
+    m_moves.clear();
 }
 
 void BoardView::clearHighlights()
 {
+    for (const Highlight& highlight : m_highlights) {
+        updateSquare(highlight.pos);
+    }
+
     m_highlights.clear();
+}
+
+void BoardView::beginUpdate()
+{
+    m_updateDepth++;
+}
+
+void BoardView::endUpdate()
+{
+    assert(m_updateDepth > 0);
+
+    m_updateDepth--;
+    if(m_updateDepth == 0 && !m_pendingRegion.isEmpty())
+    {
+        update(m_pendingRegion);
+        m_pendingRegion = QRegion();
+    }
+}
+
+BoardView::UpdateBatch::UpdateBatch(BoardView *view)
+    : m_view(view)
+{
+    m_view->beginUpdate();
+}
+
+BoardView::UpdateBatch::~UpdateBatch()
+{
+    m_view->endUpdate();
+}
+
+int BoardView::paintCount() const
+{
+    return m_paintCount;
+}
+
+void BoardView::resetPaintCount()
+{
+    m_paintCount = 0;
+}
 
-    update();
+void BoardView::animateMove(const Move &move)
+{
+    finishAnimation();
+
+    UpdateBatch batch(this);
+
+    m_pieceAnimations = {PieceAnimation{move.piece, move.from, move.to}};
+
+    // same rook squares as Position::doMove
+    int baseRank = move.from.y();
+    Piece rook{move.piece.color, PieceType::Rook};
+
+    if(move.flags & CastleKingSide)
+    {
+        m_pieceAnimations.append(PieceAnimation{rook, QPoint(7, baseRank), QPoint(5, baseRank)});
+    }
+
+    if(move.flags & CastleQueenSide)
+    {
+        m_pieceAnimations.append(PieceAnimation{rook, QPoint(0, baseRank), QPoint(3, baseRank)});
+    }
+
+    m_capturedPieces.clear();
+    if(move.isCapture())
+    {
+        // en passant moves carry no captured piece, the pawn stands beside the target square
+        if(move.flags & EnPassant)
+        {
+            Piece pawn{oppositeColor(move.piece.color), PieceType::Pawn};
+            m_capturedPieces.append(PlacedPiece{pawn, QPoint(move.to.x(), move.from.y())});
+        }
+        else
+        {
+            m_capturedPieces.append(PlacedPiece{*move.capture, move.to});
+        }
+    }
+
+    // The board already shows the move, so these squares change either way
+    for (const PieceAnimation& animation : m_pieceAnimations) {
+        updateSquare(animation.from);
+        updateSquare(animation.to);
+    }
+
+    for (const PlacedPiece& captured : m_capturedPieces) {
+        updateSquare(captured.pos);
+    }
+
+    if(m_animationDuration <= 0 || !isVisible())
+    {
+        m_pieceAnimations.clear();
+        m_capturedPieces.clear();
+        return;
+    }
+
+    m_animationProgress = 0.0;
+    m_frameTimer.start();
+
+    m_animation->setDuration(m_animationDuration);
+    m_animation->start();
+}
+
+void BoardView::finishAnimation()
+{
+    if(isAnimating())
+    {
+        m_animation->stop();
+        onAnimationFinished();
+    }
+}
+
+bool BoardView::isAnimating() const
+{
+    return m_animation->state() == QAbstractAnimation::Running;
+}
+
+void BoardView::setAnimationDuration(int duration)
+{
+    m_animationDuration = duration;
+
+    if(duration <= 0)
+    {
+        finishAnimation();
+    }
+}
+
+int BoardView::animationDuration() const
+{
+    return m_animationDuration;
+}
+
+const FrameTimeHistogram &BoardView::frameTimeHistogram() const
+{
+    return m_frameTimes;
+}
+
+void BoardView::resetFrameTimeHistogram()
+{
+    m_frameTimes.clear();
+}
+
+QRectF BoardView::getAnimatedPieceRect(const PieceAnimation &animation, qreal progress) const
+{
+    QPointF from = getSquarePos(animation.from);
+    QPointF to = getSquarePos(animation.to);
+
+    return QRectF(from + (to - from) * progress, getSquareSize());
+}
+
+void BoardView::onAnimationFrame(qreal progress)
+{
+    // only the area swept by the sprites since the last frame needs repainting
+    for (const PieceAnimation& animation : m_pieceAnimations) {
+        QRectF previous = getAnimatedPieceRect(animation, m_animationProgress);
+        QRectF current = getAnimatedPieceRect(animation, progress);
+        invalidate(previous.united(current).toAlignedRect());
+    }
+
+    m_animationProgress = progress;
+}
+
+void BoardView::onAnimationFinished()
+{
+    UpdateBatch batch(this);
+
+    for (const PieceAnimation& animation : m_pieceAnimations) {
+        invalidate(getAnimatedPieceRect(animation, m_animationProgress).toAlignedRect());
+        updateSquare(animation.to);
+    }
+
+    for (const PlacedPiece& captured : m_capturedPieces) {
+        updateSquare(captured.pos);
+    }
+
+    m_pieceAnimations.clear();
+    m_capturedPieces.clear();
+    m_animationProgress = 1.0;
+    m_frameTimer.invalidate();
+
+    if(m_pendingViewForPlayer)
+    {
+        setViewForPlayer(*m_pendingViewForPlayer);
+    }
 }
 
 static std::optional<Move> findMoveWithEndPos(const QVector<Move>& moves, QPoint endPos)
@@ -631,20 +1397,37 @@ static std::optional<Move> findMoveWithEndPos(const QVector<Move>& moves, QPoint
 
 void BoardView::paintEvent(QPaintEvent *event)
 {
+    CHESS_PROFILE_SCOPE("BoardView::paintEvent");
+
     if(!m_board)
     {
         return;
     }
 
+    m_paintCount++;
+
+    if(isAnimating())
+    {
+        m_frameTimes.record(m_frameTimer.nsecsElapsed());
+        m_frameTimer.restart();
+    }
+
+    // Qt merges all updateSquare calls since the last paint into this region
+    const QRegion& dirtyRegion = event->region();
+
+    const QPixmap& layer = boardLayer();
+
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform);
 
-    paintSquares(painter);
-    paintHoveredPos(painter);
-    paintHighlights(painter);
-    paintPieces(painter);
-    paintMoveIndicators(painter);
+    // one blit, clipped to the dirty region by Qt
+    painter.drawPixmap(0, 0, layer);
+
+    paintHoveredPos(painter, dirtyRegion);
+    paintHighlights(painter, dirtyRegion);
+    paintPieces(painter, dirtyRegion);
+    paintAnimatedPieces(painter, dirtyRegion);
+    paintMoveIndicators(painter, dirtyRegion);
 }
 
 void BoardView::mousePressEvent(QMouseEvent *event)
@@ -656,165 +1439,190 @@ void BoardView::mousePressEvent(QMouseEvent *event)
 
 void BoardView::mouseMoveEvent(QMouseEvent *event)
 {
-    m_hoveredPos = getPosFromCursor(event->pos());
+    QPoint hoveredPos = getPosFromCursor(event->pos());
+    if(m_hoveredPos == hoveredPos)
+    {
+        return;
+    }
 
-    update();
+    if(m_hoveredPos)
+    {
+        updateSquare(*m_hoveredPos);
+    }
+
+    m_hoveredPos = hoveredPos;
+    updateSquare(hoveredPos);
 }
 
 void BoardView::leaveEvent(QEvent *event)
 {
-    m_hoveredPos.reset();
+    if(m_hoveredPos)
+    {
+        updateSquare(*m_hoveredPos);
+    }
 
-    update();
+    m_hoveredPos.reset();
 }
 
-QPoint BoardView::getViewAdjustedPos(QPoint pos) const
+BoardRenderer BoardView::renderer() const
 {
-    if(m_viewForPlayer == Color::White)
-    {
-        return pos;
-    }
-
-    if(!m_board)
-    {
-        return pos;
-    }
+    int boardWidth = m_board ? m_board->width() : Board::WIDTH;
+    int boardHeight = m_board ? m_board->height() : Board::HEIGHT;
 
-    int x = m_board->width() - pos.x() - 1;
-    int y = m_board->height() - pos.y() - 1;
+    return BoardRenderer(size(), m_viewForPlayer, boardWidth, boardHeight);
+}
 
-    return QPoint(x, y);
+QRectF BoardView::getSquareRect(QPoint pos) const
+{
+    return renderer().getSquareRect(pos);
 }
 
 QPointF BoardView::getSquarePos(QPoint pos) const
 {
-    QSizeF size = getSquareSize();
-    QPoint viewPos = getViewAdjustedPos(pos);
-    float x = viewPos.x() * size.width();
-    float y = viewPos.y() * size.height();
-    return QPointF(x, y);
+    return renderer().getSquarePos(pos);
 }
 
 QSizeF BoardView::getSquareSize() const
 {
-    float squareWidth = (float)width() / m_board->width();
-    float squareHeight = (float)height() / m_board->height();
-    return QSizeF(squareWidth, squareHeight);
+    return renderer().getSquareSize();
 }
 
-QRectF BoardView::getSquareRect(QPoint pos) const
+QPoint BoardView::getPosFromCursor(QPoint cursor) const
 {
-    return QRectF(getSquarePos(pos), getSquareSize());
+    return renderer().getPosFromPoint(cursor);
 }
 
-QPoint BoardView::getPosFromCursor(QPoint cursor) const
+void BoardView::updateSquare(QPoint pos)
 {
-    int boardWidth = m_board ? m_board->width() : Board::WIDTH;
-    int boardHeight = m_board ? m_board->height() : Board::HEIGHT;
+    // Outlines are drawn inset, so nothing painted for a square leaves its rect
+    invalidate(getSquareRect(pos).toAlignedRect());
+}
 
-    int x = cursor.x() / (width() / boardWidth);
-    int y = cursor.y() / (height() / boardHeight);
+void BoardView::invalidate(const QRect &rect)
+{
+    if(m_updateDepth > 0)
+    {
+        m_pendingRegion += rect;
+        return;
+    }
 
-    return getViewAdjustedPos(QPoint(x, y));
+    update(rect);
 }
 
-float BoardView::strokeWidth() const
+bool BoardView::isSquareDirty(QPoint pos, const QRegion &dirtyRegion) const
 {
-    return width() / 180.0f;
+    return dirtyRegion.intersects(getSquareRect(pos).toAlignedRect());
 }
 
-void BoardView::paintSquares(QPainter &painter) const
+const QPixmap &BoardView::boardLayer()
 {
-    for (int y = 0; y < m_board->height(); ++y) {
-        for (int x = 0; x < m_board->width(); ++x) {
-            QRectF square = getSquareRect(QPoint(x, y));
+    qreal devicePixelRatio = devicePixelRatioF();
+    QSize layerSize = size() * devicePixelRatio;
 
-            bool isLight = (x + y) % 2 == 0;
-            QColor squareColor = isLight ? LIGHT_COLOR : DARK_COLOR;
-            painter.fillRect(square, squareColor);
-        }
+    bool isOutdated = m_boardLayer.isNull()
+                      || m_boardLayer.size() != layerSize
+                      || m_boardLayer.devicePixelRatio() != devicePixelRatio;
+
+    if(isOutdated)
+    {
+        m_boardLayer = QPixmap(layerSize);
+        m_boardLayer.setDevicePixelRatio(devicePixelRatio);
+
+        QPainter painter(&m_boardLayer);
+        renderer().paintSquares(painter);
     }
+
+    return m_boardLayer;
+}
+
+QSize BoardView::spriteSize() const
+{
+    return renderer().spriteSize(devicePixelRatioF());
 }
 
-void BoardView::paintHoveredPos(QPainter &painter) const
+void BoardView::paintHoveredPos(QPainter &painter, const QRegion& dirtyRegion) const
 {
-    if(!m_hoveredPos)
+    if(!m_hoveredPos || !isSquareDirty(*m_hoveredPos, dirtyRegion))
     {
         return;
     }
 
-    QRectF square = getSquareRect(*m_hoveredPos);
-
-    QPen pen;
-    pen.setWidth(strokeWidth());
-    pen.setColor(Qt::yellow);
-
-    painter.setPen(pen);
-
-    float inset = pen.widthF() / 2;
-    painter.drawRect(square.adjusted(inset, inset, -inset, -inset));
+    renderer().paintSquareOutline(painter, *m_hoveredPos, Qt::yellow);
 }
 
-void BoardView::paintHighlights(QPainter &painter) const
+void BoardView::paintHighlights(QPainter &painter, const QRegion& dirtyRegion) const
 {
-    QPen pen;
-    pen.setWidth(strokeWidth());
+    BoardRenderer boardRenderer = renderer();
 
     for (Highlight highlight : m_highlights) {
-        QRectF square = getSquareRect(highlight.pos);
-
-        pen.setColor(highlight.color);
-        painter.setPen(pen);
-
-        float inset = pen.widthF() / 2;
-        painter.drawRect(square.adjusted(inset, inset, -inset, -inset));
+        if(isSquareDirty(highlight.pos, dirtyRegion))
+        {
+            boardRenderer.paintSquareOutline(painter, highlight.pos, highlight.color);
+        }
     }
 }
 
-void BoardView::paintPieces(QPainter &painter) const
+void BoardView::paintPieces(QPainter &painter, const QRegion& dirtyRegion) const
 {
+    BoardRenderer boardRenderer = renderer();
+    QPixmap atlas = getPieceAtlas(spriteSize(), devicePixelRatioF());
+
     for (int y = 0; y < m_board->height(); ++y) {
         for (int x = 0; x < m_board->width(); ++x) {
-            QRectF square = getSquareRect(QPoint(x, y));
+            QPoint pos(x, y);
+            if(!isSquareDirty(pos, dirtyRegion))
+            {
+                continue;
+            }
 
-            auto piece = m_board->pieceAt(QPoint(x, y));
-            if(piece)
+            // pieces still on their way are drawn by paintAnimatedPieces
+            bool isAnimationTarget = std::any_of(std::begin(m_pieceAnimations), std::end(m_pieceAnimations), [pos](const PieceAnimation& animation) {
+                return animation.to == pos;
+            });
+
+            auto piece = m_board->pieceAt(pos);
+            if(piece && !isAnimationTarget)
             {
-                QPixmap piecePixmap = getPiecePixmap(*piece);
-                painter.drawPixmap(square, piecePixmap, piecePixmap.rect().toRectF());
+                boardRenderer.paintPieceSprite(painter, atlas, *piece, boardRenderer.getSquarePos(pos));
             }
         }
     }
+
+    for (const PlacedPiece& captured : m_capturedPieces) {
+        if(isSquareDirty(captured.pos, dirtyRegion))
+        {
+            boardRenderer.paintPieceSprite(painter, atlas, captured.piece, boardRenderer.getSquarePos(captured.pos));
+        }
+    }
 }
 
-void BoardView::paintMoveIndicators(QPainter &painter) const
+void BoardView::paintAnimatedPieces(QPainter &painter, const QRegion &dirtyRegion) const
 {
+    if(m_pieceAnimations.isEmpty())
+    {
+        return;
+    }
 
-    QColor indicatorColor(20, 60, 40);
+    BoardRenderer boardRenderer = renderer();
+    QPixmap atlas = getPieceAtlas(spriteSize(), devicePixelRatioF());
 
-    QBrush brush(indicatorColor);
+    for (const PieceAnimation& animation : m_pieceAnimations) {
+        QRectF rect = getAnimatedPieceRect(animation, m_animationProgress);
+        if(dirtyRegion.intersects(rect.toAlignedRect()))
+        {
+            boardRenderer.paintPieceSprite(painter, atlas, animation.piece, rect.topLeft());
+        }
+    }
+}
 
-    QPen pen;
-    pen.setWidth(strokeWidth());
-    pen.setColor(indicatorColor);
+void BoardView::paintMoveIndicators(QPainter &painter, const QRegion& dirtyRegion) const
+{
+    BoardRenderer boardRenderer = renderer();
 
     for (const Move& move : m_moves) {
-        QRectF square = getSquareRect(move.to);
-
-        if(move.isCapture())
-        {
-            painter.setPen(pen);
-            painter.setBrush(Qt::NoBrush);
-
-            float inset = pen.widthF() / 2.0f;
-            painter.drawRect(square.adjusted(inset, inset, -inset, -inset));
-        }
-        else
+        if(isSquareDirty(move.to, dirtyRegion))
         {
-            painter.setPen(Qt::NoPen);
-            painter.setBrush(brush);
-            float inset = square.width() / 3.0f;
-            painter.drawEllipse(square.adjusted(inset, inset, -inset, -inset));
+            boardRenderer.paintMoveIndicator(painter, move);
         }
     }
 }
@@ -844,7 +1652,194 @@ Position::Position()
     : m_currentPlayer{Color::White},
     m_board{Board::standardSetup()}
 {
+    refreshIncrementalState();
+}
+
+static std::optional<Piece> pieceFromFenCharacter(QChar character)
+{
+    Color color = character.isUpper() ? Color::White : Color::Black;
+
+    switch(character.toLower().toLatin1())
+    {
+    case 'p': return Piece{color, PieceType::Pawn};
+    case 'n': return Piece{color, PieceType::Knight};
+    case 'b': return Piece{color, PieceType::Bishop};
+    case 'r': return Piece{color, PieceType::Rook};
+    case 'q': return Piece{color, PieceType::Queen};
+    case 'k': return Piece{color, PieceType::King};
+    default: return std::nullopt;
+    }
+}
+
+static QChar fenCharacterFromPiece(Piece piece)
+{
+    QChar character;
+
+    switch(piece.type)
+    {
+    case PieceType::Pawn: character = 'p'; break;
+    case PieceType::Knight: character = 'n'; break;
+    case PieceType::Bishop: character = 'b'; break;
+    case PieceType::Rook: character = 'r'; break;
+    case PieceType::Queen: character = 'q'; break;
+    case PieceType::King: character = 'k'; break;
+    }
+
+    return piece.color == Color::White ? character.toUpper() : character;
+}
+
+std::optional<Position> Position::fromFen(const QString &fen)
+{
+    QStringList fields = fen.simplified().split(' ');
+    if(fields.size() < 2)
+    {
+        return std::nullopt;
+    }
+
+    Position position;
+    position.m_board.clearPieces();
+
+    // Piece placement, starting at the 8th rank which is the top row of our board
+    QStringList ranks = fields[0].split('/');
+    if(ranks.size() != Board::HEIGHT)
+    {
+        return std::nullopt;
+    }
+
+    for (int y = 0; y < Board::HEIGHT; ++y) {
+        int x = 0;
+        for (QChar character : ranks[y]) {
+            if(character.isDigit())
+            {
+                x += character.digitValue();
+                continue;
+            }
+
+            std::optional<Piece> piece = pieceFromFenCharacter(character);
+            if(!piece || x >= Board::WIDTH)
+            {
+                return std::nullopt;
+            }
+
+            position.m_board.setPiece(QPoint(x, y), *piece);
+            x++;
+        }
+
+        if(x != Board::WIDTH)
+        {
+            return std::nullopt;
+        }
+    }
+
+    if(fields[1] == "w")
+    {
+        position.m_currentPlayer = Color::White;
+    }
+    else if(fields[1] == "b")
+    {
+        position.m_currentPlayer = Color::Black;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    uint8_t castlingRights = 0;
+    if(fields.size() > 2 && fields[2] != "-")
+    {
+        for (QChar character : fields[2]) {
+            switch(character.toLatin1())
+            {
+            case 'K': castlingRights |= WhiteKingSide; break;
+            case 'Q': castlingRights |= WhiteQueenSide; break;
+            case 'k': castlingRights |= BlackKingSide; break;
+            case 'q': castlingRights |= BlackQueenSide; break;
+            default: return std::nullopt;
+            }
+        }
+    }
+    position.setCastlingRights(castlingRights);
+
+    position.m_enPassantSquare.reset();
+    if(fields.size() > 3 && fields[3] != "-")
+    {
+        QString square = fields[3];
+        if(square.size() != 2)
+        {
+            return std::nullopt;
+        }
+
+        int x = square[0].toLatin1() - 'a';
+        int y = '8' - square[1].toLatin1();
+        if(!position.m_board.isValid(QPoint(x, y)))
+        {
+            return std::nullopt;
+        }
+
+        position.m_enPassantSquare = QPoint(x, y);
+    }
+
+    position.refreshIncrementalState();
+
+    return position;
+}
+
+QString Position::toFen() const
+{
+    QString fen;
+
+    for (int y = 0; y < m_board.height(); ++y) {
+        int emptySquares = 0;
+        for (int x = 0; x < m_board.width(); ++x) {
+            std::optional<Piece> piece = m_board.pieceAt(QPoint(x, y));
+            if(!piece)
+            {
+                emptySquares++;
+                continue;
+            }
+
+            if(emptySquares > 0)
+            {
+                fen.append(QString::number(emptySquares));
+                emptySquares = 0;
+            }
+
+            fen.append(fenCharacterFromPiece(*piece));
+        }
+
+        if(emptySquares > 0)
+        {
+            fen.append(QString::number(emptySquares));
+        }
 
+        if(y < m_board.height() - 1)
+        {
+            fen.append('/');
+        }
+    }
+
+    fen.append(m_currentPlayer == Color::White ? " w " : " b ");
+
+    uint8_t rights = castlingRights();
+    if(rights & WhiteKingSide) fen.append('K');
+    if(rights & WhiteQueenSide) fen.append('Q');
+    if(rights & BlackKingSide) fen.append('k');
+    if(rights & BlackQueenSide) fen.append('q');
+    if(!rights) fen.append('-');
+
+    if(m_enPassantSquare)
+    {
+        fen.append(QString(" %1%2").arg(QChar('a' + m_enPassantSquare->x())).arg(QChar('8' - m_enPassantSquare->y())));
+    }
+    else
+    {
+        fen.append(" -");
+    }
+
+    // The position doesn't track move counters
+    fen.append(" 0 1");
+
+    return fen;
 }
 
 PieceType getPromotionPiece(uint8_t moveFlags)
@@ -878,34 +1873,24 @@ Position Position::nextPosition(const Move& move) const
 
 void Position::doMove(const Move& move)
 {
-    if(move.flags & TwoSquareAdvance)
-    {
-        m_twoSquareAdvance = move;
-    }
-    else
-    {
-        m_twoSquareAdvance.reset();
-    }
-
-    if(move.flags & EnPassant)
-    {
-        assert(m_twoSquareAdvance);
-
-        QPoint captureSquare = m_twoSquareAdvance->to;
-
-        m_board.setEmptyAt(captureSquare);
-    }
+    CHESS_PROFILE_SCOPE("Position::doMove");
 
     std::optional<Piece> piece = m_board.pieceAt(move.from);
     assert(piece);
 
+    // undoMove would restore whatever the move recorded, see Position::undoMove
+    assert(move.previousCastlingRights == castlingRights());
+    assert(move.previousEnPassantSquare == m_enPassantSquare);
+
+    int baseRank = piece->color == Color::White ? m_board.height() - 1 : 0;
+    int opponentBaseRank = piece->color == Color::White ? 0 : m_board.height() - 1;
+
     if(piece->type == PieceType::King)
     {
         m_canCastleKingSide[indexOfColor(piece->color)] = false;
         m_canCastleQueenSide[indexOfColor(piece->color)] = false;
     }
 
-    int baseRank = piece->color == Color::White ? m_board.height() - 1 : 0;
     if(piece->type == PieceType::Rook)
     {
         if(move.from == QPoint(0, baseRank))
@@ -913,38 +1898,118 @@ void Position::doMove(const Move& move)
             m_canCastleQueenSide[indexOfColor(piece->color)] = false;
         }
 
-        if(move.from == QPoint(m_board.width(), baseRank))
+        if(move.from == QPoint(m_board.width() - 1, baseRank))
         {
             m_canCastleKingSide[indexOfColor(piece->color)] = false;
         }
     }
 
-    // TODO: Maybe should not call tryMovePiece() directly
-    // and rather to avoid setting a piece twice on promotion
-    // if adding signals on change to the Board later.
-    m_board.tryMovePiece(move.from, move.to);
+    // capturing a rook on its starting square takes away the opponent's castling right
+    if(move.to == QPoint(0, opponentBaseRank))
+    {
+        m_canCastleQueenSide[indexOfColor(oppositeColor(piece->color))] = false;
+    }
+
+    if(move.to == QPoint(m_board.width() - 1, opponentBaseRank))
+    {
+        m_canCastleKingSide[indexOfColor(oppositeColor(piece->color))] = false;
+    }
+
+    if(move.flags & EnPassant)
+    {
+        // the captured pawn stands beside the moving pawn, not on the target square
+        removePiece(QPoint(move.to.x(), move.from.y()));
+    }
+
+    if(m_board.hasPieceAt(move.to))
+    {
+        removePiece(move.to);
+    }
+
+    movePiece(move.from, move.to);
 
     if(move.flags & PromotionAny)
     {
         PieceType pieceType = getPromotionPiece(move.flags);
-        m_board.setPiece(move.to, m_currentPlayer, pieceType);
+        removePiece(move.to);
+        putPiece(move.to, Piece{m_currentPlayer, pieceType});
     }
 
     if(move.flags & CastleKingSide)
     {
-        m_board.tryMovePiece(QPoint(7, baseRank), QPoint(5, baseRank));
+        movePiece(QPoint(7, baseRank), QPoint(5, baseRank));
+    }
+
+    if(move.flags & CastleQueenSide)
+    {
+        movePiece(QPoint(0, baseRank), QPoint(3, baseRank));
+    }
+
+    if(move.flags & TwoSquareAdvance)
+    {
+        m_enPassantSquare = QPoint(move.from.x(), (move.from.y() + move.to.y()) / 2);
+    }
+    else
+    {
+        m_enPassantSquare.reset();
+    }
+
+    m_currentPlayer = oppositeColor(m_currentPlayer);
+}
+
+void Position::undoMove(const Move& move)
+{
+    m_currentPlayer = oppositeColor(m_currentPlayer);
+
+    int baseRank = m_currentPlayer == Color::White ? m_board.height() - 1 : 0;
+
+    if(move.flags & CastleKingSide)
+    {
+        movePiece(QPoint(5, baseRank), QPoint(7, baseRank));
     }
 
     if(move.flags & CastleQueenSide)
     {
-        m_board.tryMovePiece(QPoint(0, baseRank), QPoint(3, baseRank));
+        movePiece(QPoint(3, baseRank), QPoint(0, baseRank));
     }
 
+    // putting back move.piece instead of moving undoes promotions as well
+    removePiece(move.to);
+    putPiece(move.from, move.piece);
+
+    if(move.flags & EnPassant)
+    {
+        putPiece(QPoint(move.to.x(), move.from.y()), Piece{oppositeColor(m_currentPlayer), PieceType::Pawn});
+    }
+    else if(move.capture)
+    {
+        putPiece(move.to, *move.capture);
+    }
+
+    setCastlingRights(move.previousCastlingRights);
+    m_enPassantSquare = move.previousEnPassantSquare;
+}
+
+std::optional<QPoint> Position::doNullMove()
+{
+    std::optional<QPoint> enPassantSquare = m_enPassantSquare;
+
+    m_enPassantSquare.reset();
+    m_currentPlayer = oppositeColor(m_currentPlayer);
+
+    return enPassantSquare;
+}
+
+void Position::undoNullMove(std::optional<QPoint> enPassantSquare)
+{
     m_currentPlayer = oppositeColor(m_currentPlayer);
+    m_enPassantSquare = enPassantSquare;
 }
 
 QVector<Move> Position::getLegalMoves(QPoint pos) const
 {
+    CHESS_PROFILE_SCOPE("Position::getLegalMoves(pos)");
+
     std::optional<Piece> piece = m_board.pieceAt(pos);
     if(!piece)
     {
@@ -966,6 +2031,8 @@ QVector<Move> Position::getLegalMoves(QPoint pos) const
 
 QVector<Move> Position::getLegalMoves() const
 {
+    CHESS_PROFILE_SCOPE("Position::getLegalMoves");
+
     QVector<Move> moves;
     for (size_t y = 0; y < m_board.height(); ++y) {
         for (size_t x = 0; x < m_board.width(); ++x) {
@@ -1014,49 +2081,119 @@ QVector<Move> Position::getCurrentThreats(Color color) const
 
 bool Position::isKingInCheck(Color color) const
 {
+    CHESS_PROFILE_SCOPE("Position::isKingInCheck");
+
     QVector<Move> attackingMoves = getCurrentThreats(oppositeColor(color));
 
-    auto moveTargetsKing = [&](const Move& move) {
-        auto piece = m_board.pieceAt(move.to);
-        return piece && piece->color == color && piece->type == PieceType::King;
-    };
+    auto moveTargetsKing = [&](const Move& move) {
+        auto piece = m_board.pieceAt(move.to);
+        return piece && piece->color == color && piece->type == PieceType::King;
+    };
+
+    return std::any_of(std::begin(attackingMoves), std::end(attackingMoves), moveTargetsKing);
+}
+
+bool Position::isKingInCheck() const
+{
+    return isKingInCheck(m_currentPlayer);
+}
+
+const Board &Position::board() const
+{
+    return m_board;
+}
+
+Color Position::currentPlayer() const
+{
+    return m_currentPlayer;
+}
+
+bool Position::canCastleKingSide(Color color) const
+{
+    return m_canCastleKingSide[indexOfColor(color)];
+}
+
+bool Position::canCastleQueenSide(Color color) const
+{
+    return m_canCastleQueenSide[indexOfColor(color)];
+}
+
+uint8_t Position::castlingRights() const
+{
+    uint8_t castlingRights = 0;
+
+    if(canCastleKingSide(Color::White)) castlingRights |= WhiteKingSide;
+    if(canCastleQueenSide(Color::White)) castlingRights |= WhiteQueenSide;
+    if(canCastleKingSide(Color::Black)) castlingRights |= BlackKingSide;
+    if(canCastleQueenSide(Color::Black)) castlingRights |= BlackQueenSide;
 
-    return std::any_of(std::begin(attackingMoves), std::end(attackingMoves), moveTargetsKing);
+    return castlingRights;
 }
 
-bool Position::isKingInCheck() const
+std::optional<QPoint> Position::enPassantSquare() const
 {
-    return isKingInCheck(m_currentPlayer);
+    return m_enPassantSquare;
 }
 
-const Board &Position::board() const
+Score Position::pieceSquareScore() const
 {
-    return m_board;
+    return m_pieceSquareScore;
 }
 
-Color Position::currentPlayer() const
+int Position::phase() const
 {
-    return m_currentPlayer;
+    return m_phase;
 }
 
-bool Position::canCastleKingSide(Color color) const
+uint64_t Position::hash() const
 {
-    return m_canCastleKingSide[indexOfColor(color)];
+    uint64_t hash = m_pieceKey ^ zobristCastlingKey(castlingRights());
+
+    // Like Polyglot, only hash the en passant file if a pawn is actually able to capture
+    if(m_enPassantSquare)
+    {
+        int pawnRank = m_enPassantSquare->y() + (m_currentPlayer == Color::White ? 1 : -1);
+        Piece capturingPawn{m_currentPlayer, PieceType::Pawn};
+
+        bool canCapture = m_board.pieceAt(QPoint(m_enPassantSquare->x() - 1, pawnRank)) == capturingPawn
+                          || m_board.pieceAt(QPoint(m_enPassantSquare->x() + 1, pawnRank)) == capturingPawn;
+
+        if(canCapture)
+        {
+            hash ^= zobristEnPassantKey(m_enPassantSquare->x());
+        }
+    }
+
+    if(m_currentPlayer == Color::White)
+    {
+        hash ^= zobristWhiteToMoveKey();
+    }
+
+    return hash;
 }
 
-bool Position::canCastleQueenSide(Color color) const
+uint64_t Position::pawnKey() const
 {
-    return m_canCastleQueenSide[indexOfColor(color)];
+    return m_pawnKey;
+}
+
+int Position::pieceCount() const
+{
+    return m_pieceCount;
 }
 
 void Position::addPossibleMoves(QVector<Move> &moves, QPoint pos, bool onlyAttackingMoves) const
 {
+    CHESS_PROFILE_SCOPE("Position::addPossibleMoves");
+
     std::optional<Piece> piece = m_board.pieceAt(pos);
     if(!piece)
     {
         return;
     }
 
+    size_t firstNewMove = moves.count();
+
     switch(piece->type)
     {
     case PieceType::Pawn:
@@ -1079,8 +2216,14 @@ void Position::addPossibleMoves(QVector<Move> &moves, QPoint pos, bool onlyAttac
             bool hasNotMoved = piece->color == Color::White && pos.y() == 6 || piece->color == Color::Black && pos.y() == 1;
             if(hasNotMoved && !isBlocked)
             {
+                size_t countBeforeAdvance = moves.count();
                 addDirectionalMoves(moves, pos, QPoint(0, 2 * dy), 1, false);
-                moves.last().flags |= TwoSquareAdvance;
+
+                // the target square itself may be occupied as well
+                if(moves.count() > countBeforeAdvance)
+                {
+                    moves.last().flags |= TwoSquareAdvance;
+                }
             }
         }
 
@@ -1109,9 +2252,18 @@ void Position::addPossibleMoves(QVector<Move> &moves, QPoint pos, bool onlyAttac
                 };
                 moves.append(diagonalCapture);
             }
+            else if(!otherPiece && onlyAttackingMoves)
+            {
+                // not a move, but the square is attacked, which matters for castling
+                moves.append(Move{
+                    .piece = *piece,
+                    .from = pos,
+                    .to = target,
+                });
+            }
 
             // Check for en passant
-            if(m_twoSquareAdvance && target == getEnPassantSquare())
+            if(m_enPassantSquare && target == getEnPassantSquare())
             {
                 auto enPassantCapture = Move{
                     .piece = *piece,
@@ -1129,7 +2281,7 @@ void Position::addPossibleMoves(QVector<Move> &moves, QPoint pos, bool onlyAttac
         // !WARN! iterate using indices to avoid iterator invalidation
 
         size_t count = moves.count();
-        for (size_t i = 0; i < count; i++) {
+        for (size_t i = firstNewMove; i < count; i++) {
             int rank = moves[i].to.y();
             bool isPromotionRank = (piece->color == Color::White && rank == 0)
                                    || (piece->color == Color::Black && rank == m_board.height() - 1);
@@ -1290,10 +2442,16 @@ void Position::addPossibleMoves(QVector<Move> &moves, QPoint pos, bool onlyAttac
 
             bool isPathClear = std::all_of(std::begin(path), std::end(path), squareIsEmpty);
 
+            // the rook passes the b-file square as well, but only the king's path must not be attacked
+            std::array<QPoint, 2> kingPath = {
+                QPoint(2, baseRank),
+                QPoint(3, baseRank),
+            };
+
             QVector<Move> attackingMoves = getCurrentThreats(oppositeColor(piece->color));
 
-            auto attacksPath = [&path](const Move& move) {
-                return std::count(std::begin(path), std::end(path), move.to) > 0;
+            auto attacksPath = [&kingPath](const Move& move) {
+                return std::count(std::begin(kingPath), std::end(kingPath), move.to) > 0;
             };
 
             bool isPathSafe = std::none_of(std::begin(attackingMoves), std::end(attackingMoves), attacksPath);
@@ -1313,10 +2471,18 @@ void Position::addPossibleMoves(QVector<Move> &moves, QPoint pos, bool onlyAttac
     }
     break;
     }
+
+    uint8_t currentCastlingRights = castlingRights();
+    for (size_t i = firstNewMove; i < moves.count(); ++i) {
+        moves[i].previousCastlingRights = currentCastlingRights;
+        moves[i].previousEnPassantSquare = m_enPassantSquare;
+    }
 }
 
 void Position::removeKingInCheckMoves(QVector<Move> &moves, Color kingColor) const
 {
+    CHESS_PROFILE_SCOPE("Position::removeKingInCheckMoves");
+
         // removes all candidates sthat would leave the own color's king in check
     moves.removeIf([&](const Move& move){
         std::optional<Position> nextPos = nextPosition(move);
@@ -1374,10 +2540,86 @@ void Position::addDirectionalMoves(QVector<Move> &moves,
 
 QPoint Position::getEnPassantSquare() const
 {
-    assert(m_twoSquareAdvance);
+    assert(m_enPassantSquare);
+
+    return *m_enPassantSquare;
+}
+
+void Position::setCastlingRights(uint8_t castlingRights)
+{
+    m_canCastleKingSide[indexOfColor(Color::White)] = castlingRights & WhiteKingSide;
+    m_canCastleQueenSide[indexOfColor(Color::White)] = castlingRights & WhiteQueenSide;
+    m_canCastleKingSide[indexOfColor(Color::Black)] = castlingRights & BlackKingSide;
+    m_canCastleQueenSide[indexOfColor(Color::Black)] = castlingRights & BlackQueenSide;
+}
+
+void Position::putPiece(QPoint pos, Piece piece)
+{
+    m_board.setPiece(pos, piece);
+
+    m_pieceSquareScore += Chess::pieceSquareScore(piece, pos);
+    m_phase += PHASE_WEIGHTS[static_cast<int>(piece.type)];
+    m_pieceKey ^= zobristPieceKey(piece, pos);
+    m_pieceCount++;
+
+    if(piece.type == PieceType::Pawn)
+    {
+        m_pawnKey ^= zobristPieceKey(piece, pos);
+    }
+}
+
+void Position::removePiece(QPoint pos)
+{
+    std::optional<Piece> piece = m_board.pieceAt(pos);
+    assert(piece);
+
+    m_board.setEmptyAt(pos);
+
+    m_pieceSquareScore -= Chess::pieceSquareScore(*piece, pos);
+    m_phase -= PHASE_WEIGHTS[static_cast<int>(piece->type)];
+    m_pieceKey ^= zobristPieceKey(*piece, pos);
+    m_pieceCount--;
+
+    if(piece->type == PieceType::Pawn)
+    {
+        m_pawnKey ^= zobristPieceKey(*piece, pos);
+    }
+}
+
+void Position::movePiece(QPoint from, QPoint to)
+{
+    std::optional<Piece> piece = m_board.pieceAt(from);
+    assert(piece);
+
+    removePiece(from);
+    putPiece(to, *piece);
+}
+
+void Position::refreshIncrementalState()
+{
+    m_pieceSquareScore = Score{};
+    m_phase = 0;
+    m_pawnKey = 0;
+    m_pieceKey = 0;
+    m_pieceCount = 0;
 
-    QPoint center = m_twoSquareAdvance->from + m_twoSquareAdvance->to;
-    return QPoint(center.x() / 2, center.y() / 2);
+    for (int y = 0; y < m_board.height(); ++y) {
+        for (int x = 0; x < m_board.width(); ++x) {
+            std::optional<Piece> piece = m_board.pieceAt(QPoint(x, y));
+            if(piece)
+            {
+                m_pieceSquareScore += Chess::pieceSquareScore(*piece, QPoint(x, y));
+                m_phase += PHASE_WEIGHTS[static_cast<int>(piece->type)];
+                m_pieceKey ^= zobristPieceKey(*piece, QPoint(x, y));
+                m_pieceCount++;
+
+                if(piece->type == PieceType::Pawn)
+                {
+                    m_pawnKey ^= zobristPieceKey(*piece, QPoint(x, y));
+                }
+            }
+        }
+    }
 }
 
 PromotionDialog::PromotionDialog(QWidget *parent)
@@ -1452,6 +2694,45 @@ bool Piece::operator==(const Piece &other) const
     return color == other.color && type == other.type;
 }
 
+Score& Score::operator+=(Score other)
+{
+    midgame += other.midgame;
+    endgame += other.endgame;
+    return *this;
+}
+
+Score& Score::operator-=(Score other)
+{
+    midgame -= other.midgame;
+    endgame -= other.endgame;
+    return *this;
+}
+
+Score Score::operator+(Score other) const
+{
+    return Score{midgame + other.midgame, endgame + other.endgame};
+}
+
+Score Score::operator-(Score other) const
+{
+    return Score{midgame - other.midgame, endgame - other.endgame};
+}
+
+Score Score::operator-() const
+{
+    return Score{-midgame, -endgame};
+}
+
+Score Score::operator*(int factor) const
+{
+    return Score{midgame * factor, endgame * factor};
+}
+
+bool Score::operator==(Score other) const
+{
+    return midgame == other.midgame && endgame == other.endgame;
+}
+
 std::underlying_type<Color>::type Chess::indexOfColor(Color color)
 {
     return static_cast<std::underlying_type<Color>::type>(color);
@@ -1549,6 +2830,8 @@ MoveHistoryView::MoveHistoryView(QWidget *parent)
 
 void MoveHistoryView::setHistory(const MoveHistory *history)
 {
+    CHESS_PROFILE_SCOPE("MoveHistoryView::setHistory");
+
     m_history = history;
 
     m_historyListWidget->clear();
@@ -1565,6 +2848,237 @@ void MoveHistoryView::setHistory(const MoveHistory *history)
     }
 }
 
+// Tenths of a second once they matter, whole seconds before
+static QString formatClockTime(qint64 ms)
+{
+    if(ms < 10000)
+    {
+        return QString("0:%1.%2").arg(ms / 1000, 2, 10, QChar('0')).arg(ms / 100 % 10);
+    }
+
+    qint64 seconds = ms / 1000;
+    if(seconds < 3600)
+    {
+        return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+    }
+
+    return QString("%1:%2:%3").arg(seconds / 3600).arg(seconds / 60 % 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'));
+}
+
+ClockView::ClockView(QWidget *parent)
+    : QWidget(parent),
+    m_tickTimer(new QTimer(this))
+{
+    static constexpr int TICK_INTERVAL_MS = 100;
+
+    auto layout = new QGridLayout();
+
+    QFont timeFont = font();
+    timeFont.setPointSize(18);
+
+    int row = 0;
+    for (Color color : {Color::White, Color::Black}) {
+        auto timeLabel = new QLabel();
+        timeLabel->setFont(timeFont);
+        timeLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+        layout->addWidget(new QLabel(color == Color::White ? "White" : "Black"), row, 0);
+        layout->addWidget(timeLabel, row, 1);
+
+        m_timeLabels[indexOfColor(color)] = timeLabel;
+        row++;
+    }
+
+    setLayout(layout);
+
+    m_tickTimer->setInterval(TICK_INTERVAL_MS);
+    connect(m_tickTimer, &QTimer::timeout, this, &ClockView::updateTimes);
+}
+
+void ClockView::setClock(const ChessClock *clock)
+{
+    m_clock = clock;
+    updateClock();
+}
+
+void ClockView::updateClock()
+{
+    bool isTimed = m_clock && m_clock->timeControl().isTimed();
+    std::optional<Color> runningPlayer = isTimed ? m_clock->runningPlayer() : std::nullopt;
+
+    for (Color color : {Color::White, Color::Black}) {
+        QLabel* label = m_timeLabels[indexOfColor(color)];
+
+        QFont timeFont = label->font();
+        timeFont.setBold(runningPlayer == color);
+        label->setFont(timeFont);
+    }
+
+    if(runningPlayer)
+    {
+        m_tickTimer->start();
+    }
+    else
+    {
+        m_tickTimer->stop();
+    }
+
+    updateTimes();
+}
+
+void ClockView::updateTimes()
+{
+    bool isTimed = m_clock && m_clock->timeControl().isTimed();
+
+    // QLabel only repaints when the text changed, most ticks don't change what is shown
+    for (Color color : {Color::White, Color::Black}) {
+        m_timeLabels[indexOfColor(color)]->setText(isTimed ? formatClockTime(m_clock->remainingMs(color)) : "-");
+    }
+}
+
+// In pawns from white's point of view, or the moves to a mate like "#3" and "#-2"
+static QString formatAnalysisScore(int score)
+{
+    int absoluteScore = std::abs(score);
+    if(absoluteScore >= MATE_SCORE - MAX_PLY)
+    {
+        int mateInMoves = (MATE_SCORE - absoluteScore + 1) / 2;
+        if(mateInMoves == 0)
+        {
+            return "Checkmate";
+        }
+
+        return QString(score > 0 ? "#%1" : "#-%1").arg(mateInMoves);
+    }
+
+    if(absoluteScore >= TABLEBASE_WIN_SCORE - MAX_PLY)
+    {
+        return score > 0 ? "1-0 (tablebase)" : "0-1 (tablebase)";
+    }
+
+    return QString::asprintf("%+.2f", score / 100.0);
+}
+
+AnalysisPanel::AnalysisPanel(QWidget *parent)
+    : QWidget(parent),
+    m_pollTimer(new QTimer(this))
+{
+    static constexpr int POLL_INTERVAL_MS = 100;
+
+    // The bar is full for white from this many centipawns on
+    static constexpr int EVALUATION_BAR_RANGE = 1000;
+
+    auto layout = new QVBoxLayout();
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    m_evaluationBar = new QProgressBar();
+    m_evaluationBar->setRange(-EVALUATION_BAR_RANGE, EVALUATION_BAR_RANGE);
+    m_evaluationBar->setTextVisible(false);
+
+    QFont scoreFont = font();
+    scoreFont.setPointSize(16);
+    scoreFont.setBold(true);
+
+    m_scoreLabel = new QLabel();
+    m_scoreLabel->setFont(scoreFont);
+
+    m_searchLabel = new QLabel();
+
+    // Why a search is slow: how well the table and the move ordering work and how fast the tree grows
+    m_statisticsLabel = new QLabel();
+
+    m_principalVariationLabel = new QLabel();
+    m_principalVariationLabel->setWordWrap(true);
+    m_principalVariationLabel->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+
+    layout->addWidget(m_evaluationBar);
+    layout->addWidget(m_scoreLabel);
+    layout->addWidget(m_searchLabel);
+    layout->addWidget(m_statisticsLabel);
+    layout->addWidget(m_principalVariationLabel, 1);
+
+    setLayout(layout);
+
+    m_pollTimer->setInterval(POLL_INTERVAL_MS);
+    connect(m_pollTimer, &QTimer::timeout, this, &AnalysisPanel::pollAnalyzer);
+
+    updateAnalysis();
+}
+
+void AnalysisPanel::setAnalyzer(Analyzer *analyzer)
+{
+    m_analyzer = analyzer;
+    updateAnalysis();
+}
+
+void AnalysisPanel::updateAnalysis()
+{
+    bool isRunning = m_analyzer && m_analyzer->isRunning();
+
+    m_evaluationBar->setValue(0);
+    m_evaluationBar->setEnabled(isRunning);
+    m_scoreLabel->setText(isRunning ? "..." : "-");
+    m_searchLabel->setText(isRunning ? "Searching" : "Enable live analysis in the Analysis menu");
+    m_statisticsLabel->clear();
+    m_principalVariationLabel->clear();
+
+    if(isRunning)
+    {
+        m_pollTimer->start();
+    }
+    else
+    {
+        m_pollTimer->stop();
+    }
+}
+
+void AnalysisPanel::pollAnalyzer()
+{
+    std::optional<AnalysisInfo> info = m_analyzer ? m_analyzer->takeLatestInfo() : std::nullopt;
+    if(!info)
+    {
+        return;
+    }
+
+    int barRange = m_evaluationBar->maximum();
+    m_evaluationBar->setValue(std::clamp(info->score, -barRange, barRange));
+    m_scoreLabel->setText(formatAnalysisScore(info->score));
+
+    QString searchText = QString("Depth %1, %2 kN, %3 kN/s")
+                             .arg(info->depth)
+                             .arg(info->nodes / 1000)
+                             .arg(info->nodesPerSecond() / 1000);
+    if(info->isFinished)
+    {
+        searchText += ", done";
+    }
+
+    m_searchLabel->setText(searchText);
+
+    const SearchStatistics& statistics = info->statistics;
+    QVector<double> branchingFactors = statistics.effectiveBranchingFactors();
+    m_statisticsLabel->setText(QString("Table hits %1%, first move cutoffs %2%, quiescence %3%, EBF %4")
+                                   .arg(statistics.tableHitRate() * 100, 0, 'f', 0)
+                                   .arg(statistics.firstMoveCutoffRate() * 100, 0, 'f', 0)
+                                   .arg(statistics.quiescenceRate() * 100, 0, 'f', 0)
+                                   .arg(branchingFactors.isEmpty() ? QString("-") : QString::number(branchingFactors.last(), 'f', 1)));
+
+    Position position = info->position;
+
+    QStringList moves;
+    if(position.currentPlayer() == Color::Black && !info->principalVariation.isEmpty())
+    {
+        moves.append("...");
+    }
+
+    for (const Move& move : info->principalVariation) {
+        position.doMove(move);
+        moves.append(getAlgebraicNotation(move, position));
+    }
+
+    m_principalVariationLabel->setText(moves.join(' '));
+}
+
 QString getFileCharacter(int fileIndex)
 {
     return QString(QChar('a' + fileIndex));
@@ -1663,6 +3177,49 @@ QString Chess::getAlgebraicNotation(const Move& move, const Position& resultingP
     return algebraicNotation;
 }
 
+static QString getUciSquare(QPoint square)
+{
+    return QString("%1%2").arg(QChar('a' + square.x())).arg(QChar('8' - square.y()));
+}
+
+QString Chess::getUciNotation(const Move &move)
+{
+    QString notation = getUciSquare(move.from) + getUciSquare(move.to);
+
+    if(move.flags & PromotionAny)
+    {
+        notation += getPieceCharacter(getPromotionPiece(move.flags)).toLower();
+    }
+
+    return notation;
+}
+
+std::optional<Move> Chess::findUciMove(const Position &position, const QString &notation)
+{
+    if(notation.size() != 4 && notation.size() != 5)
+    {
+        return std::nullopt;
+    }
+
+    QPoint from(notation[0].toLatin1() - 'a', '8' - notation[1].toLatin1());
+    QPoint to(notation[2].toLatin1() - 'a', '8' - notation[3].toLatin1());
+    if(!position.board().isValid(from) || !position.board().isValid(to))
+    {
+        return std::nullopt;
+    }
+
+    QString promotion = notation.mid(4);
+
+    for (const Move& move : position.getLegalMoves(from)) {
+        if(move.to == to && getUciNotation(move).mid(4) == promotion)
+        {
+            return move;
+        }
+    }
+
+    return std::nullopt;
+}
+
 QComboBox* NewGameDialog::createPlayerComboBox() {
 
     auto playerComboBox = new QComboBox();
@@ -1689,6 +3246,26 @@ NewGameDialog::NewGameDialog(QWidget *parent)
     QComboBox* black = createPlayerComboBox();
     formLayout->addRow("Black:", black);
 
+    auto timeControl = new QLineEdit();
+    timeControl->setPlaceholderText("Minutes+increment like 5+3, 3d2 for a delay, 40/90+30 for sessions (untimed if empty)");
+    formLayout->addRow("Time Control:", timeControl);
+
+    auto openingBook = new QLineEdit();
+    openingBook->setPlaceholderText("Polyglot .bin file (optional)");
+    formLayout->addRow("Opening Book:", openingBook);
+
+    auto tablebases = new QLineEdit();
+    tablebases->setPlaceholderText("Endgame table directory (optional)");
+    formLayout->addRow("Tablebases:", tablebases);
+
+    auto server = new QLineEdit(QString("%1:%2").arg(m_matchSettings.serverHost).arg(m_matchSettings.serverPort));
+    server->setPlaceholderText("host:port of the server for network players");
+    formLayout->addRow("Server:", server);
+
+    auto networkGame = new QLineEdit();
+    networkGame->setPlaceholderText("Game to join, or to watch if both players are Network (creates a new one if empty)");
+    formLayout->addRow("Network Game:", networkGame);
+
     connect(white, &QComboBox::currentTextChanged, this, [this](const QString& text) {
         m_matchSettings.white = *getPlayerTypeByName(text);
     });
@@ -1697,6 +3274,29 @@ NewGameDialog::NewGameDialog(QWidget *parent)
         m_matchSettings.black = *getPlayerTypeByName(text);
     });
 
+    connect(openingBook, &QLineEdit::textChanged, this, [this](const QString& text) {
+        m_matchSettings.openingBookPath = text.trimmed();
+    });
+
+    connect(tablebases, &QLineEdit::textChanged, this, [this](const QString& text) {
+        m_matchSettings.tablebasePath = text.trimmed();
+    });
+
+    connect(server, &QLineEdit::textChanged, this, [this](const QString& text) {
+        QString host = text.section(':', 0, 0).trimmed();
+        bool isPort = false;
+        quint16 port = text.section(':', 1).toUShort(&isPort);
+
+        m_matchSettings.serverHost = host;
+        m_matchSettings.serverPort = isPort ? port : GameServer::DEFAULT_PORT;
+    });
+
+    connect(networkGame, &QLineEdit::textChanged, this, [this](const QString& text) {
+        bool isNumber = false;
+        uint32_t gameId = text.trimmed().toUInt(&isNumber);
+        m_matchSettings.networkGameId = isNumber ? std::optional<uint32_t>(gameId) : std::nullopt;
+    });
+
 
     std::optional<QString> defaultWhite = getPlayerTypeName(m_matchSettings.white);
     if(defaultWhite)
@@ -1711,6 +3311,18 @@ NewGameDialog::NewGameDialog(QWidget *parent)
     }
 
     auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+
+    connect(timeControl, &QLineEdit::textChanged, this, [this, timeControl, buttonBox](const QString& text) {
+        std::optional<TimeControl> parsed = TimeControl::fromString(text);
+        if(parsed)
+        {
+            m_matchSettings.timeControl = *parsed;
+        }
+
+        timeControl->setStyleSheet(parsed ? "" : "color: red");
+        buttonBox->button(QDialogButtonBox::Ok)->setEnabled(parsed.has_value());
+    });
+
     connect(buttonBox, &QDialogButtonBox::accepted, this, &NewGameDialog::accept);
     connect(buttonBox, &QDialogButtonBox::rejected, this, &NewGameDialog::rejected);
 
@@ -1761,6 +3373,8 @@ const std::vector<std::pair<QString, PlayerType>> &NewGameDialog::playerTypes()
     static std::vector<std::pair<QString, PlayerType>> s_playerTypes({
         {"Human", PlayerType::Human},
         {"Easy Bot", PlayerType::EasyBot},
+        {"Hard Bot", PlayerType::HardBot},
+        {"Network", PlayerType::Network},
     });
 
     return s_playerTypes;
@@ -6,6 +6,18 @@
 #include <QListWidget>
 #include <QDialog>
 #include <QComboBox>
+#include <QProgressBar>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantAnimation>
+
+#include "frametimehistogram.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <random>
 
 // # TODO
 //
@@ -16,7 +28,7 @@
 // [ ] Split into different files
 // [ ] Look for opportunities to refactor and clean up code and collect them in this TODO
 // [ ] Implement a history with undo and redo
-// [ ] Implement save game
+// [x] Implement save game
 // -> [ ] Clean up move checking routines
 // -> [ ] Add a check when castling to not allow castling when squares are under attack
 // -> [ ] Fix isKingInCheck on GameState
@@ -38,6 +50,13 @@
 namespace Chess
 {
 
+class Analyzer;
+class BoardRenderer;
+class ChessClock;
+class GameServer;
+class NetworkClient;
+class OpeningBook;
+
 enum class Color : uint8_t
 {
     White,
@@ -85,6 +104,14 @@ enum MoveFlags : uint8_t
     CastleAny = CastleKingSide | CastleQueenSide
 };
 
+enum CastlingRights : uint8_t
+{
+    WhiteKingSide = 1 << 0,
+    WhiteQueenSide = 1 << 1,
+    BlackKingSide = 1 << 2,
+    BlackQueenSide = 1 << 3,
+};
+
 // Right now this struct is used all over the application, also for undo / redo.
 // It needs to hold all information to display all information and
 // undo or redo a move without additional data about the previous or current state of the chess board
@@ -100,6 +127,11 @@ struct Move
 
     uint8_t flags;
 
+    // State of the position before the move was played, recorded by the move generator.
+    // Position::undoMove needs these to restore what the move itself can't tell.
+    uint8_t previousCastlingRights = 0;
+    std::optional<QPoint> previousEnPassantSquare;
+
     bool operator==(const Move& other) const;
 
     bool isCapture() const;
@@ -144,18 +176,46 @@ private:
 
 std::optional<QPoint> findPiece(const Board& board, Piece piece);
 
+// A pair of midgame and endgame values, blended by the game phase during evaluation
+struct Score
+{
+    int midgame = 0;
+    int endgame = 0;
+
+    Score& operator+=(Score other);
+    Score& operator-=(Score other);
+    Score operator+(Score other) const;
+    Score operator-(Score other) const;
+    Score operator-() const;
+    Score operator*(int factor) const;
+    bool operator==(Score other) const;
+};
+
 class Position
 {
 public:
     Position();
 
+    // Parses the piece placement, side to move, castling and en passant fields of a FEN string.
+    // Move counters are accepted but ignored. Returns nothing if the string is malformed.
+    static std::optional<Position> fromFen(const QString& fen);
+    QString toFen() const;
+
     // NOTE: Move needs to be legal. Validate with isLegalMove or call getLegalMoves to obtain a list of legal moves.
     Position nextPosition(const Move &move) const;
 
     // NOTE: Move needs to be legal. Validate with isLegalMove or call getLegalMoves to obtain a list of legal moves.
+    // undoMove restores castling rights and the en passant square from the previous* fields of the move,
+    // which only the move generator fills in. A hand-built Move can't be undone, doMove asserts it was generated
+    // for this position.
     void doMove(const Move& move);
     void undoMove(const Move& move);
 
+    // Passes the turn without moving, for the null move pruning of the search. Returns the en passant square
+    // the null move took away, to be given back to undoNullMove.
+    std::optional<QPoint> doNullMove();
+    void undoNullMove(std::optional<QPoint> enPassantSquare);
+
     // Returns a list of legal moves only for the piece at the given location.
     // If there is no piece at the given location an empty list is returned.
     // This is a special case of getLegalMoves, which returns all legal moves
@@ -181,6 +241,26 @@ public:
 
     bool canCastleKingSide(Color color) const;
     bool canCastleQueenSide(Color color) const;
+
+    // Combination of CastlingRights flags
+    uint8_t castlingRights() const;
+
+    std::optional<QPoint> enPassantSquare() const;
+
+    // Material and piece-square score from white's point of view, kept up to date by doMove and undoMove
+    Score pieceSquareScore() const;
+
+    // Sum of the phase weights of all pieces on the board, see Chess::PHASE_WEIGHTS
+    int phase() const;
+
+    // Zobrist hash of the whole position, computed like Polyglot opening books do
+    uint64_t hash() const;
+
+    // Zobrist key of the pawns only, identifies the pawn structure for the PawnHashTable
+    uint64_t pawnKey() const;
+
+    // Number of pieces on the board, including kings and pawns
+    int pieceCount() const;
 private:
     // Gets the moves regardless of whether or not its the current player's turn.
     // This doesn't respect pins or moves that leave the king in check.
@@ -200,9 +280,20 @@ private:
                              ) const;
 
     QPoint getEnPassantSquare() const;
+
+    void setCastlingRights(uint8_t castlingRights);
+
+    // All board changes of doMove and undoMove go through these,
+    // so that the incrementally updated state stays in sync with the board
+    void putPiece(QPoint pos, Piece piece);
+    void removePiece(QPoint pos);
+    void movePiece(QPoint from, QPoint to);
+
+    // Recomputes the incrementally updated state from scratch
+    void refreshIncrementalState();
 private:
-    // keeps tracks of a potential last turns two square pawn advance to enable en passant
-    std::optional<Move> m_twoSquareAdvance;
+    // the square behind a pawn that advanced two squares last turn, enables en passant
+    std::optional<QPoint> m_enPassantSquare;
 
     static_assert(static_cast<std::underlying_type<Color>::type>(Color::White) == 0);
     static_assert(static_cast<std::underlying_type<Color>::type>(Color::Black) == 1);
@@ -212,6 +303,14 @@ private:
 
     Color m_currentPlayer;
     Board m_board;
+
+    Score m_pieceSquareScore;
+    int m_phase = 0;
+    uint64_t m_pawnKey = 0;
+    int m_pieceCount = 0;
+
+    // Zobrist key of the pieces only, hash() adds castling rights, en passant and side to move
+    uint64_t m_pieceKey = 0;
 };
 
 class MoveHistory {
@@ -251,6 +350,56 @@ private:
     const MoveHistory* m_history;
 };
 
+// The time left on both clocks of a ChessClock. Only its own labels are updated as the clock runs,
+// on a timer of its own, nothing else is repainted for a tick.
+class ClockView : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ClockView(QWidget *parent = nullptr);
+
+    // Nothing is shown without a clock or for an untimed game
+    void setClock(const ChessClock* clock);
+
+    // Call when the clock was started, stopped or punched
+    void updateClock();
+private:
+    void updateTimes();
+private:
+    const ChessClock* m_clock = nullptr;
+
+    std::array<QLabel*, COLOR_COUNT> m_timeLabels = {};
+    QTimer* m_tickTimer;
+};
+
+// Evaluation bar, score, depth and principal variation of an Analyzer. The analyzer is asked for its latest
+// result at a fixed rate, however often the search completes an iteration, so fast searches of shallow depths
+// can't flood the event loop with updates.
+class AnalysisPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit AnalysisPanel(QWidget *parent = nullptr);
+
+    // Nothing is shown while the analyzer isn't running
+    void setAnalyzer(Analyzer* analyzer);
+
+    // Call when the analyzer was started or stopped, clears the result of the previous position
+    void updateAnalysis();
+private:
+    void pollAnalyzer();
+private:
+    Analyzer* m_analyzer = nullptr;
+
+    QProgressBar* m_evaluationBar;
+    QLabel* m_scoreLabel;
+    QLabel* m_searchLabel;
+    QLabel* m_statisticsLabel;
+    QLabel* m_principalVariationLabel;
+
+    QTimer* m_pollTimer;
+};
+
 class BoardView : public QWidget
 {
     Q_OBJECT
@@ -259,9 +408,6 @@ public:
 
     static constexpr float SQUARE_SIZE = 90.0f;
 
-    static constexpr QColor LIGHT_COLOR = QColor(150, 120, 75);
-    static constexpr QColor DARK_COLOR = QColor(100, 80, 50);
-
     struct Highlight
     {
         QPoint pos;
@@ -276,36 +422,128 @@ public:
     void setBoard(const Board *board);
 
     void addHighlight(QPoint pos, QColor color);
+    void setHighlights(const QVector<Highlight>& highlights);
     void clearHighlights();
 
     void addMoveIndicator(const Move& move);
+    void setMoveIndicators(const QVector<Move>& moves);
     void clearMoveIndicators();
+
+    // Collects every invalidation until the outermost endUpdate, which schedules a single update
+    // for all of them. Calls may be nested, UpdateBatch scopes them.
+    void beginUpdate();
+    void endUpdate();
+
+    class UpdateBatch
+    {
+    public:
+        explicit UpdateBatch(BoardView* view);
+        ~UpdateBatch();
+
+        UpdateBatch(const UpdateBatch&) = delete;
+        UpdateBatch& operator=(const UpdateBatch&) = delete;
+    private:
+        BoardView* m_view;
+    };
+
+    // Paint events since the last reset, for checking that an interaction repaints the board only once
+    int paintCount() const;
+    void resetPaintCount();
+
+    static constexpr int DEFAULT_ANIMATION_DURATION = 180;
+
+    // Slides the pieces of a move that was just played on the board from their old squares,
+    // including the rook of a castling move. Captured pieces stay visible until the move lands.
+    // A running animation is finished first, so fast bot games skip their animations.
+    void animateMove(const Move& move);
+    void finishAnimation();
+    bool isAnimating() const;
+
+    // In milliseconds, 0 shows moves immediately
+    void setAnimationDuration(int duration);
+    int animationDuration() const;
+
+    // Time between the frames of all animations since the last reset
+    const FrameTimeHistogram& frameTimeHistogram() const;
+    void resetFrameTimeHistogram();
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void leaveEvent(QEvent *event) override;
 private:
-    // Positioning
-    QPoint getViewAdjustedPos(QPoint pos) const;
+    // Positioning, the geometry of the widget's current size and orientation
+    BoardRenderer renderer() const;
+
     QRectF getSquareRect(QPoint pos) const;
     QPointF getSquarePos(QPoint pos) const;
     QSizeF getSquareSize() const;
     QPoint getPosFromCursor(QPoint cursor) const;
 
+    // Invalidates only the rect of a single square, so hover and highlight changes
+    // don't repaint the whole board
+    void updateSquare(QPoint pos);
+
+    // Schedules a repaint of the rect, or adds it to the pending region while an update batch is open
+    void invalidate(const QRect& rect);
+
+    // Animation
+    struct PieceAnimation
+    {
+        Piece piece;
+        QPoint from;
+        QPoint to;
+    };
+
+    struct PlacedPiece
+    {
+        Piece piece;
+        QPoint pos;
+    };
+
+    QRectF getAnimatedPieceRect(const PieceAnimation& animation, qreal progress) const;
+    void onAnimationFrame(qreal progress);
+    void onAnimationFinished();
+
     // Painting
-    float strokeWidth() const;
+    // Whether the square needs to be painted for a paint event with the given dirty region
+    bool isSquareDirty(QPoint pos, const QRegion& dirtyRegion) const;
+
+    void paintHoveredPos(QPainter &painter, const QRegion& dirtyRegion) const;
+    void paintHighlights(QPainter& painter, const QRegion& dirtyRegion) const;
+    void paintPieces(QPainter& painter, const QRegion& dirtyRegion) const;
+    void paintMoveIndicators(QPainter &painter, const QRegion& dirtyRegion) const;
+    void paintAnimatedPieces(QPainter &painter, const QRegion& dirtyRegion) const;
 
-    void paintSquares(QPainter& painter) const;
-    void paintHoveredPos(QPainter &painter) const;
-    void paintHighlights(QPainter& painter) const;
-    void paintPieces(QPainter& painter) const;
-    void paintMoveIndicators(QPainter &painter) const;
+    // The squares of the board at the current size, pixel ratio and orientation, rebuilt when any of them changes
+    const QPixmap& boardLayer();
 
-    static QPixmap getPiecePixmap(Piece piece);
+    // Size of a piece sprite in device pixels
+    QSize spriteSize() const;
+
+    // The atlas of BoardRenderer::createPieceAtlas as a pixmap.
+    // Atlases are kept in QPixmapCache, so boards of the same size share one.
+    static QPixmap getPieceAtlas(QSize spriteSize, qreal devicePixelRatio);
 private:
     const Board *m_board;
 
+    QPixmap m_boardLayer;
+
+    int m_updateDepth = 0;
+    QRegion m_pendingRegion;
+
+    int m_paintCount = 0;
+
+    QVariantAnimation* m_animation;
+    QVector<PieceAnimation> m_pieceAnimations;
+    QVector<PlacedPiece> m_capturedPieces;
+    qreal m_animationProgress = 1.0;
+    std::optional<Color> m_pendingViewForPlayer;
+    int m_animationDuration = DEFAULT_ANIMATION_DURATION;
+
+    FrameTimeHistogram m_frameTimes;
+    QElapsedTimer m_frameTimer;
+
     // Determines from which side of the board the game is viewed
     Color m_viewForPlayer = Color::White;
 
@@ -328,6 +566,36 @@ enum class PlayerType
 {
     Human,
     EasyBot,
+    HardBot,
+
+    // The opponent on the other end of a NetworkClient
+    Network,
+};
+
+// How much time the players get. The parts combine, like 40 moves in 90 minutes with a 30 second increment.
+struct TimeControl
+{
+    // On each clock at the start and again at the start of every session, none means the game is untimed
+    qint64 baseMs = 0;
+
+    // Fischer, added to the clock after every move
+    qint64 incrementMs = 0;
+
+    // Bronstein, the clock counts down as usual and the time used for a move is given back after it,
+    // up to the delay
+    qint64 delayMs = 0;
+
+    // Moves of a player per session, none means the base time is for the whole game
+    int movesPerSession = 0;
+
+    bool isTimed() const;
+
+    // "[moves/]minutes[+increment|d delay]" with the increment and delay in seconds,
+    // like "5+3", "3d2" or "40/90+30". Empty is untimed.
+    static std::optional<TimeControl> fromString(const QString& text);
+    QString toString() const;
+
+    bool operator==(const TimeControl& other) const;
 };
 
 struct MatchSettings
@@ -335,6 +603,28 @@ struct MatchSettings
     PlayerType white = PlayerType::Human;
     PlayerType black = PlayerType::Human;
 
+    // Polyglot .bin book the bots play from while the position is in it, none if empty
+    QString openingBookPath;
+
+    // Seeds the weighted random choice between book moves, a random seed is used if not set
+    std::optional<uint32_t> openingBookSeed;
+
+    // Directory of endgame tables from TablebaseGenerator, the bots play perfectly once the position
+    // is in them. None are loaded if empty.
+    QString tablebasePath;
+
+    // Ends games between two bots as soon as the tables know the result
+    bool adjudicateWithTablebases = true;
+
+    // GameServer to play on if one of the players is PlayerType::Network
+    QString serverHost = "localhost";
+    quint16 serverPort = 7070;
+
+    // Joins this game of the server instead of creating a new one, the creator's color choice wins
+    std::optional<uint32_t> networkGameId;
+
+    TimeControl timeControl;
+
     PlayerType getPlayerByColor(Color color) const;
 };
 
@@ -366,6 +656,7 @@ enum class EndReason
     FiftyMoveRule,
     OutOfTime,
     Resignation,
+    TablebaseAdjudication,
 };
 
 struct GameResult
@@ -380,12 +671,30 @@ Q_OBJECT
 
 public:
 explicit MainWindow(QWidget *parent = nullptr);
+    ~MainWindow() override;
 
 private slots:
     void onSquareClicked(QPoint pos);
     void onNewAction();
+    void onSaveAction();
+    void onLoadAction();
+    void onHostServerAction();
+
+    void onNetworkGameJoined(uint32_t gameId, Color color);
+    void onNetworkGameWatched(uint32_t gameId);
+    void onNetworkGameStarted();
+    void onNetworkMoveReceived(const Move& move);
+    void onNetworkGameEnded(const QString& message);
+
+    // The running clock may have run out, fired when it is due to
+    void onFlagTimeout();
+
+    void onLiveAnalysisToggled(bool isEnabled);
 private:
     void startNewGame(const MatchSettings& settings);
+
+    // Applies the settings and continues the game from the last move of the history
+    void startGame(const MatchSettings& settings, const MoveHistory& history);
     void selectPieceAt(QPoint pos);
 
     void playMove(Move move);
@@ -401,12 +710,36 @@ private:
 
     bool isGameOver() const;
 
+    // The result known from the endgame tables, only for games between two bots
+    std::optional<GameResult> tablebaseAdjudication() const;
+
     PlayerType getCurrentPlayerType() const;
 
     bool isHumansTurn() const;
 
+    bool isNetworkGame() const;
+
+    // Connects to the server of the settings and creates or joins the game there
+    void startNetworkGame();
+
     void doAiMove();
 
+    // Searches for the bot to move on a worker thread, within the time its clock allows
+    void startBotSearch();
+    void cancelBotSearch();
+
+    void startClock();
+
+    // Schedules onFlagTimeout for when the running clock runs out
+    void scheduleFlagCheck();
+    void stopClock();
+    void loseOnTime(Color player);
+
+    // Restarts the live analysis, if it is enabled, on the position shown now
+    void updateLiveAnalysis();
+
+    std::optional<Move> tryBookMove();
+
 private:
     std::optional<QPoint> m_selectedPos;
 
@@ -418,10 +751,43 @@ private:
 
     BoardView* m_boardView;
     MoveHistoryView *m_historyView;
+
+    std::unique_ptr<OpeningBook> m_openingBook;
+
+    std::unique_ptr<NetworkClient> m_networkClient;
+    std::unique_ptr<GameServer> m_gameServer;
+
+    // No moves may be played before the network opponent has joined
+    bool m_isWaitingForOpponent = false;
+
+    std::unique_ptr<ChessClock> m_clock;
+    ClockView* m_clockView;
+    QTimer* m_flagTimer;
+
+    // Nothing is played anymore once a flag fell
+    bool m_isOutOfTime = false;
+
+    // One search at a time. Results of searches from before the last cancel are dropped by generation.
+    QThreadPool m_searchPool;
+    std::shared_ptr<std::atomic<bool>> m_stopSearch;
+    uint64_t m_searchGeneration = 0;
+
+    // Created the first time live analysis is enabled
+    std::unique_ptr<Analyzer> m_analyzer;
+    AnalysisPanel* m_analysisPanel;
+    bool m_isLiveAnalysisEnabled = false;
+
+    std::mt19937 m_bookRandom;
 };
 
 QString getAlgebraicNotation(const Move& move, const Position& resultingPosition);
 
+// Long algebraic notation like "e2e4" or "e7e8q", as used by UCI engines
+QString getUciNotation(const Move& move);
+
+// The legal move of the position written in long algebraic notation, if there is one
+std::optional<Move> findUciMove(const Position& position, const QString& notation);
+
 }
 
 #endif // CHESS_H
@@ -0,0 +1,207 @@
+#include "chessclock.h"
+
+#include <QRegularExpression>
+
+using namespace Chess;
+using namespace std::chrono;
+
+// Moves a sudden death game is expected to last from any point on
+static constexpr int EXPECTED_MOVES_LEFT = 30;
+
+// Time lost between the search ending and the clock being punched
+static constexpr qint64 MOVE_OVERHEAD_MS = 30;
+
+// The hard limit is this many times the soft one, as far as the clock allows
+static constexpr int HARD_LIMIT_FACTOR = 4;
+
+bool TimeControl::isTimed() const
+{
+    return baseMs > 0;
+}
+
+std::optional<TimeControl> TimeControl::fromString(const QString &text)
+{
+    QString trimmed = text.trimmed();
+    if(trimmed.isEmpty())
+    {
+        return TimeControl();
+    }
+
+    static const QRegularExpression pattern(R"(^(?:(\d+)/)?(\d+(?:\.\d+)?)(?:([+d])(\d+(?:\.\d+)?))?$)");
+
+    QRegularExpressionMatch match = pattern.match(trimmed);
+    if(!match.hasMatch())
+    {
+        return std::nullopt;
+    }
+
+    TimeControl timeControl;
+    timeControl.movesPerSession = match.captured(1).toInt();
+    timeControl.baseMs = qRound64(match.captured(2).toDouble() * 60 * 1000);
+
+    qint64 extraMs = qRound64(match.captured(4).toDouble() * 1000);
+    if(match.captured(3) == "+")
+    {
+        timeControl.incrementMs = extraMs;
+    }
+    else if(match.captured(3) == "d")
+    {
+        timeControl.delayMs = extraMs;
+    }
+
+    if(!timeControl.isTimed())
+    {
+        return std::nullopt;
+    }
+
+    return timeControl;
+}
+
+QString TimeControl::toString() const
+{
+    if(!isTimed())
+    {
+        return QString();
+    }
+
+    QString text = QString::number(baseMs / 60000.0);
+    if(movesPerSession > 0)
+    {
+        text = QString("%1/%2").arg(movesPerSession).arg(text);
+    }
+
+    if(incrementMs > 0)
+    {
+        text += QString("+%1").arg(incrementMs / 1000.0);
+    }
+    else if(delayMs > 0)
+    {
+        text += QString("d%1").arg(delayMs / 1000.0);
+    }
+
+    return text;
+}
+
+bool TimeControl::operator==(const TimeControl &other) const
+{
+    return baseMs == other.baseMs
+           && incrementMs == other.incrementMs
+           && delayMs == other.delayMs
+           && movesPerSession == other.movesPerSession;
+}
+
+ChessClock::ChessClock(const TimeControl &timeControl)
+    : m_timeControl(timeControl)
+{
+    m_remaining.fill(milliseconds(timeControl.baseMs));
+}
+
+const TimeControl &ChessClock::timeControl() const
+{
+    return m_timeControl;
+}
+
+void ChessClock::start(Color player, TimePoint now)
+{
+    m_runningPlayer = player;
+    m_runningSince = now;
+}
+
+bool ChessClock::punch(TimePoint now)
+{
+    if(!m_runningPlayer)
+    {
+        return true;
+    }
+
+    Color player = *m_runningPlayer;
+    size_t index = indexOfColor(player);
+
+    nanoseconds used = now - m_runningSince;
+    nanoseconds delay = milliseconds(m_timeControl.delayMs);
+
+    m_remaining[index] -= used;
+
+    // the delay is only given back once the move is made, it can't save a player whose flag fell
+    bool hasTimeLeft = !m_timeControl.isTimed() || m_remaining[index] > nanoseconds::zero();
+    if(hasTimeLeft)
+    {
+        m_remaining[index] += std::min(used, delay) + milliseconds(m_timeControl.incrementMs);
+
+        m_movesPlayed[index]++;
+        if(m_timeControl.movesPerSession > 0 && m_movesPlayed[index] % m_timeControl.movesPerSession == 0)
+        {
+            m_remaining[index] += milliseconds(m_timeControl.baseMs);
+        }
+    }
+
+    start(oppositeColor(player), now);
+    return hasTimeLeft;
+}
+
+void ChessClock::stop(TimePoint now)
+{
+    if(!m_runningPlayer)
+    {
+        return;
+    }
+
+    m_remaining[indexOfColor(*m_runningPlayer)] = timeLeft(*m_runningPlayer, now);
+    m_runningPlayer.reset();
+}
+
+std::optional<Color> ChessClock::runningPlayer() const
+{
+    return m_runningPlayer;
+}
+
+nanoseconds ChessClock::timeLeft(Color color, TimePoint now) const
+{
+    nanoseconds left = m_remaining[indexOfColor(color)];
+    if(m_runningPlayer == color)
+    {
+        // counts down right away, the delay comes back with the punch
+        left -= now - m_runningSince;
+    }
+
+    return left;
+}
+
+nanoseconds ChessClock::remaining(Color color, TimePoint now) const
+{
+    return std::max(timeLeft(color, now), nanoseconds::zero());
+}
+
+qint64 ChessClock::remainingMs(Color color, TimePoint now) const
+{
+    return duration_cast<milliseconds>(remaining(color, now)).count();
+}
+
+bool ChessClock::isOutOfTime(Color color, TimePoint now) const
+{
+    return m_timeControl.isTimed() && timeLeft(color, now) <= nanoseconds::zero();
+}
+
+int ChessClock::movesPlayed(Color color) const
+{
+    return m_movesPlayed[indexOfColor(color)];
+}
+
+MoveTimeBudget Chess::allocateMoveTime(const TimeControl &timeControl, qint64 remainingMs, int movesPlayed)
+{
+    int movesToGo = EXPECTED_MOVES_LEFT;
+    if(timeControl.movesPerSession > 0)
+    {
+        movesToGo = timeControl.movesPerSession - movesPlayed % timeControl.movesPerSession;
+    }
+
+    qint64 usableMs = std::max<qint64>(remainingMs - MOVE_OVERHEAD_MS, 1);
+
+    MoveTimeBudget budget;
+    budget.hardMs = std::min(usableMs, (usableMs / movesToGo + timeControl.incrementMs + timeControl.delayMs) * HARD_LIMIT_FACTOR);
+    budget.softMs = std::min(budget.hardMs, usableMs / movesToGo + timeControl.incrementMs * 3 / 4 + timeControl.delayMs);
+    budget.hardMs = std::max<qint64>(budget.hardMs, 1);
+    budget.softMs = std::max<qint64>(budget.softMs, 1);
+
+    return budget;
+}
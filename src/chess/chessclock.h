@@ -0,0 +1,73 @@
+#ifndef CHESSCLOCK_H
+#define CHESSCLOCK_H
+
+#include "chess.h"
+
+#include <array>
+#include <chrono>
+
+namespace Chess
+{
+
+// The clocks of both players, measured with a monotonic clock in nanoseconds.
+// Nothing runs in the background, the time left is computed from when the running clock was started,
+// so it is exact whenever it is asked for no matter how often anyone looks.
+class ChessClock
+{
+public:
+    using SteadyClock = std::chrono::steady_clock;
+    using TimePoint = SteadyClock::time_point;
+
+    ChessClock() = default;
+    explicit ChessClock(const TimeControl& timeControl);
+
+    const TimeControl& timeControl() const;
+
+    // Starts the clock of the player to move
+    void start(Color player, TimePoint now = SteadyClock::now());
+
+    // The running player made their move. Their clock stops and gets the increment, delay and session time
+    // they earned, the opponent's clock starts. Returns false if the player's time had already run out.
+    bool punch(TimePoint now = SteadyClock::now());
+
+    void stop(TimePoint now = SteadyClock::now());
+
+    std::optional<Color> runningPlayer() const;
+
+    // Never negative, zero once the time ran out
+    std::chrono::nanoseconds remaining(Color color, TimePoint now = SteadyClock::now()) const;
+    qint64 remainingMs(Color color, TimePoint now = SteadyClock::now()) const;
+
+    bool isOutOfTime(Color color, TimePoint now = SteadyClock::now()) const;
+
+    int movesPlayed(Color color) const;
+private:
+    // May be negative for the running player
+    std::chrono::nanoseconds timeLeft(Color color, TimePoint now) const;
+private:
+    TimeControl m_timeControl;
+
+    std::array<std::chrono::nanoseconds, COLOR_COUNT> m_remaining = {};
+    std::array<int, COLOR_COUNT> m_movesPlayed = {};
+
+    std::optional<Color> m_runningPlayer;
+    TimePoint m_runningSince;
+};
+
+// Search time for one move of a bot
+struct MoveTimeBudget
+{
+    // No new iteration is started after this
+    qint64 softMs = 0;
+
+    // The search is aborted here
+    qint64 hardMs = 0;
+};
+
+// Spreads the time left over the moves until the next session, or the moves a game usually still lasts
+// for sudden death. The increment and delay come back after the move, so most of them is spent right away.
+MoveTimeBudget allocateMoveTime(const TimeControl& timeControl, qint64 remainingMs, int movesPlayed);
+
+}
+
+#endif // CHESSCLOCK_H
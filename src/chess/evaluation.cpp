@@ -0,0 +1,426 @@
+#include "evaluation.h"
+
+#include <cstdlib>
+
+using namespace Chess;
+
+// Tables are written from white's point of view and laid out like the board is viewed,
+// i.e. the first row is the 8th rank. Index with y * 8 + x for white and mirror y for black.
+using PieceSquareTable = std::array<int, 64>;
+
+static constexpr std::array<Score, 6> MATERIAL = {
+    Score{82, 94},      // Pawn
+    Score{337, 281},    // Knight
+    Score{365, 297},    // Bishop
+    Score{477, 512},    // Rook
+    Score{1025, 936},   // Queen
+    Score{0, 0},        // King
+};
+
+static constexpr PieceSquareTable PAWN_MIDGAME = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     10,  10,  20,  30,  30,  20,  10,  10,
+      5,   5,  10,  25,  25,  10,   5,   5,
+      0,   0,   0,  20,  20,   0,   0,   0,
+      5,  -5, -10,   0,   0, -10,  -5,   5,
+      5,  10,  10, -20, -20,  10,  10,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+static constexpr PieceSquareTable PAWN_ENDGAME = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     80,  80,  80,  80,  80,  80,  80,  80,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     30,  30,  30,  30,  30,  30,  30,  30,
+     20,  20,  20,  20,  20,  20,  20,  20,
+     10,  10,  10,  10,  10,  10,  10,  10,
+      5,   5,   5,   5,   5,   5,   5,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+static constexpr PieceSquareTable KNIGHT = {
+    -50, -40, -30, -30, -30, -30, -40, -50,
+    -40, -20,   0,   0,   0,   0, -20, -40,
+    -30,   0,  10,  15,  15,  10,   0, -30,
+    -30,   5,  15,  20,  20,  15,   5, -30,
+    -30,   0,  15,  20,  20,  15,   0, -30,
+    -30,   5,  10,  15,  15,  10,   5, -30,
+    -40, -20,   0,   5,   5,   0, -20, -40,
+    -50, -40, -30, -30, -30, -30, -40, -50,
+};
+
+static constexpr PieceSquareTable BISHOP = {
+    -20, -10, -10, -10, -10, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,  10,  10,   5,   0, -10,
+    -10,   5,   5,  10,  10,   5,   5, -10,
+    -10,   0,  10,  10,  10,  10,   0, -10,
+    -10,  10,  10,  10,  10,  10,  10, -10,
+    -10,   5,   0,   0,   0,   0,   5, -10,
+    -20, -10, -10, -10, -10, -10, -10, -20,
+};
+
+static constexpr PieceSquareTable ROOK = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+      5,  10,  10,  10,  10,  10,  10,   5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+      0,   0,   0,   5,   5,   0,   0,   0,
+};
+
+static constexpr PieceSquareTable QUEEN = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+      0,   0,   5,   5,   5,   5,   0,  -5,
+    -10,   5,   5,   5,   5,   5,   0, -10,
+    -10,   0,   5,   0,   0,   0,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+};
+
+static constexpr PieceSquareTable KING_MIDGAME = {
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -20, -30, -30, -40, -40, -30, -30, -20,
+    -10, -20, -20, -20, -20, -20, -20, -10,
+     20,  20,   0,   0,   0,   0,  20,  20,
+     20,  30,  10,   0,   0,  10,  30,  20,
+};
+
+static constexpr PieceSquareTable KING_ENDGAME = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50,
+};
+
+// Pawn structure
+static constexpr Score DOUBLED_PAWN_PENALTY = {10, 20};
+static constexpr Score ISOLATED_PAWN_PENALTY = {10, 15};
+
+// Indexed by the relative rank of the passed pawn, 0 being the player's own base rank
+static constexpr std::array<Score, 8> PASSED_PAWN_BONUS = {
+    Score{0, 0},
+    Score{5, 10},
+    Score{5, 15},
+    Score{10, 25},
+    Score{20, 45},
+    Score{35, 75},
+    Score{60, 120},
+    Score{0, 0},
+};
+
+// Extra bonus for passed pawns whose next square is not blocked, by relative rank
+static constexpr std::array<Score, 8> FREE_PASSED_PAWN_BONUS = {
+    Score{0, 0},
+    Score{0, 2},
+    Score{0, 5},
+    Score{2, 10},
+    Score{5, 20},
+    Score{10, 35},
+    Score{20, 60},
+    Score{0, 0},
+};
+
+static constexpr int PASSED_PAWN_KING_PROXIMITY_WEIGHT = 2;
+
+// King safety, only relevant while there is enough material on the board to mount an attack
+static constexpr int MISSING_SHIELD_PAWN_PENALTY = 15;
+static constexpr int ADVANCED_SHIELD_PAWN_PENALTY = 7;
+static constexpr int OPEN_FILE_NEAR_KING_PENALTY = 15;
+static constexpr std::array<int, 6> KING_ATTACKER_WEIGHTS = {0, 2, 2, 3, 5, 0};
+static constexpr int KING_ZONE_DISTANCE = 2;
+
+static constexpr int TEMPO_BONUS = 10;
+
+static constexpr int LAST_FILE = Board::WIDTH - 1;
+
+static int pieceIndex(PieceType type)
+{
+    return static_cast<int>(type);
+}
+
+// Relative rank counted from the player's own base rank
+static int relativeRank(Color color, int y)
+{
+    return color == Color::White ? (Board::HEIGHT - 1) - y : y;
+}
+
+static int tableIndex(Color color, QPoint pos)
+{
+    int y = color == Color::White ? pos.y() : (Board::HEIGHT - 1) - pos.y();
+    return y * Board::WIDTH + pos.x();
+}
+
+Score Chess::pieceSquareScore(Piece piece, QPoint pos)
+{
+    int index = tableIndex(piece.color, pos);
+
+    Score score = MATERIAL[pieceIndex(piece.type)];
+
+    switch(piece.type)
+    {
+    case PieceType::Pawn:
+        score += Score{PAWN_MIDGAME[index], PAWN_ENDGAME[index]};
+        break;
+    case PieceType::Knight:
+        score += Score{KNIGHT[index], KNIGHT[index]};
+        break;
+    case PieceType::Bishop:
+        score += Score{BISHOP[index], BISHOP[index]};
+        break;
+    case PieceType::Rook:
+        score += Score{ROOK[index], ROOK[index]};
+        break;
+    case PieceType::Queen:
+        score += Score{QUEEN[index], QUEEN[index]};
+        break;
+    case PieceType::King:
+        score += Score{KING_MIDGAME[index], KING_ENDGAME[index]};
+        break;
+    }
+
+    return piece.color == Color::White ? score : -score;
+}
+
+int Chess::taperScore(Score score, int phase)
+{
+    phase = std::clamp(phase, 0, MAX_PHASE);
+
+    return (score.midgame * phase + score.endgame * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
+PawnStructure Chess::analyzePawnStructure(const Board& board)
+{
+    // pawn ranks per color and file, to look up neighbouring and opposing pawns quickly
+    std::array<std::array<QVector<int>, Board::WIDTH>, COLOR_COUNT> pawnRanks;
+
+    for (int y = 0; y < Board::HEIGHT; ++y) {
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            std::optional<Piece> piece = board.pieceAt(QPoint(x, y));
+            if(piece && piece->type == PieceType::Pawn)
+            {
+                pawnRanks[indexOfColor(piece->color)][x].append(y);
+            }
+        }
+    }
+
+    PawnStructure pawnStructure;
+    Score scores[COLOR_COUNT];
+
+    for (Color color : {Color::White, Color::Black}) {
+        const auto& ownPawns = pawnRanks[indexOfColor(color)];
+        const auto& opponentPawns = pawnRanks[indexOfColor(oppositeColor(color))];
+
+        Score& score = scores[indexOfColor(color)];
+
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            if(ownPawns[x].empty())
+            {
+                continue;
+            }
+
+            score -= DOUBLED_PAWN_PENALTY * (ownPawns[x].count() - 1);
+
+            bool hasLeftNeighbour = x > 0 && !ownPawns[x - 1].empty();
+            bool hasRightNeighbour = x < LAST_FILE && !ownPawns[x + 1].empty();
+            if(!hasLeftNeighbour && !hasRightNeighbour)
+            {
+                score -= ISOLATED_PAWN_PENALTY * ownPawns[x].count();
+            }
+
+            for (int y : ownPawns[x]) {
+                int rank = relativeRank(color, y);
+
+                bool isPassed = true;
+                for (int file = std::max(x - 1, 0); file <= std::min(x + 1, LAST_FILE); ++file) {
+                    for (int opponentY : opponentPawns[file]) {
+                        if(relativeRank(color, opponentY) > rank)
+                        {
+                            isPassed = false;
+                        }
+                    }
+                }
+
+                if(isPassed)
+                {
+                    score += PASSED_PAWN_BONUS[rank];
+                    pawnStructure.passedPawns[indexOfColor(color)] |= uint64_t(1) << (y * Board::WIDTH + x);
+                }
+            }
+        }
+    }
+
+    pawnStructure.score = scores[indexOfColor(Color::White)] - scores[indexOfColor(Color::Black)];
+
+    return pawnStructure;
+}
+
+static int squareDistance(QPoint a, QPoint b)
+{
+    return std::max(std::abs(a.x() - b.x()), std::abs(a.y() - b.y()));
+}
+
+Score Chess::evaluatePassedPawns(const Board& board, const PawnStructure& pawnStructure)
+{
+    std::optional<QPoint> whiteKing = findPiece(board, Piece{Color::White, PieceType::King});
+    std::optional<QPoint> blackKing = findPiece(board, Piece{Color::Black, PieceType::King});
+
+    Score scores[COLOR_COUNT];
+
+    for (Color color : {Color::White, Color::Black}) {
+        uint64_t passedPawns = pawnStructure.passedPawns[indexOfColor(color)];
+        std::optional<QPoint> ownKing = color == Color::White ? whiteKing : blackKing;
+        std::optional<QPoint> opponentKing = color == Color::White ? blackKing : whiteKing;
+
+        Score& score = scores[indexOfColor(color)];
+
+        for (int square = 0; square < 64; ++square) {
+            if(!(passedPawns & (uint64_t(1) << square)))
+            {
+                continue;
+            }
+
+            QPoint pos(square % Board::WIDTH, square / Board::WIDTH);
+            QPoint stopSquare = pos + QPoint(0, color == Color::White ? -1 : 1);
+            int rank = relativeRank(color, pos.y());
+
+            if(board.isEmptyAt(stopSquare))
+            {
+                score += FREE_PASSED_PAWN_BONUS[rank];
+            }
+
+            // In the endgame the kings race for the square in front of the pawn
+            if(ownKing && opponentKing)
+            {
+                int proximity = squareDistance(*opponentKing, stopSquare) - squareDistance(*ownKing, stopSquare);
+                score += Score{0, proximity * PASSED_PAWN_KING_PROXIMITY_WEIGHT * rank};
+            }
+        }
+    }
+
+    return scores[indexOfColor(Color::White)] - scores[indexOfColor(Color::Black)];
+}
+
+static int kingSafetyPenalty(const Board& board, Color color)
+{
+    std::optional<QPoint> kingPos = findPiece(board, Piece{color, PieceType::King});
+    if(!kingPos)
+    {
+        return 0;
+    }
+
+    int penalty = 0;
+
+    // Pawn shield and open files around a castled king
+    if(relativeRank(color, kingPos->y()) <= 1)
+    {
+        int forward = color == Color::White ? -1 : 1;
+        Piece ownPawn{color, PieceType::Pawn};
+
+        for (int x = kingPos->x() - 1; x <= kingPos->x() + 1; ++x) {
+            if(x < 0 || x >= Board::WIDTH)
+            {
+                continue;
+            }
+
+            if(board.pieceAt(QPoint(x, kingPos->y() + forward)) == ownPawn)
+            {
+                continue;
+            }
+
+            if(board.pieceAt(QPoint(x, kingPos->y() + 2 * forward)) == ownPawn)
+            {
+                penalty += ADVANCED_SHIELD_PAWN_PENALTY;
+                continue;
+            }
+
+            penalty += MISSING_SHIELD_PAWN_PENALTY;
+
+            bool hasOwnPawnOnFile = false;
+            for (int y = 0; y < Board::HEIGHT; ++y) {
+                if(board.pieceAt(QPoint(x, y)) == ownPawn)
+                {
+                    hasOwnPawnOnFile = true;
+                    break;
+                }
+            }
+
+            if(!hasOwnPawnOnFile)
+            {
+                penalty += OPEN_FILE_NEAR_KING_PENALTY;
+            }
+        }
+    }
+
+    // Opponent pieces gathering around the king. A single attacker is rarely dangerous,
+    // so the penalty grows quadratically with the accumulated attacker weight.
+    int attackerCount = 0;
+    int attackWeight = 0;
+
+    for (int y = 0; y < Board::HEIGHT; ++y) {
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            std::optional<Piece> piece = board.pieceAt(QPoint(x, y));
+            if(!piece || piece->color == color)
+            {
+                continue;
+            }
+
+            int distance = std::max(std::abs(x - kingPos->x()), std::abs(y - kingPos->y()));
+            int weight = KING_ATTACKER_WEIGHTS[pieceIndex(piece->type)];
+            if(weight > 0 && distance <= KING_ZONE_DISTANCE)
+            {
+                attackerCount++;
+                attackWeight += weight;
+            }
+        }
+    }
+
+    if(attackerCount >= 2)
+    {
+        penalty += attackWeight * attackWeight * 2;
+    }
+
+    return penalty;
+}
+
+Score Chess::evaluateKingSafety(const Board& board)
+{
+    // King safety only matters in the midgame, the endgame value stays zero
+    int white = kingSafetyPenalty(board, Color::White);
+    int black = kingSafetyPenalty(board, Color::Black);
+
+    return Score{black - white, 0};
+}
+
+int Chess::evaluate(const Position& position)
+{
+    const Board& board = position.board();
+
+    const PawnStructure& pawnStructure = PawnHashTable::forCurrentThread().probe(position.pawnKey(), board);
+
+    Score score = position.pieceSquareScore();
+    score += pawnStructure.score;
+    score += evaluatePassedPawns(board, pawnStructure);
+    score += evaluateKingSafety(board);
+
+    int value = taperScore(score, position.phase());
+
+    if(position.currentPlayer() == Color::Black)
+    {
+        value = -value;
+    }
+
+    return value + TEMPO_BONUS;
+}
@@ -0,0 +1,36 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "chess.h"
+#include "pawnhash.h"
+
+namespace Chess
+{
+
+// Phase weight of each piece type, summed over the board by Position::phase().
+// A full set of pieces adds up to MAX_PHASE, bare kings and pawns to zero.
+static constexpr std::array<int, 6> PHASE_WEIGHTS = {0, 1, 1, 2, 4, 0};
+static constexpr int MAX_PHASE = 24;
+
+// Material value plus piece-square bonus of a piece on the given square, from white's point of view
+Score pieceSquareScore(Piece piece, QPoint pos);
+
+// Blends the midgame and endgame values of a score by the given phase
+int taperScore(Score score, int phase);
+
+// Pawn structure terms (doubled, isolated and passed pawns) from white's point of view.
+// Only depends on the pawns, so results are cached in a PawnHashTable.
+PawnStructure analyzePawnStructure(const Board& board);
+
+// Terms for the passed pawns found by analyzePawnStructure that depend on other pieces as well
+Score evaluatePassedPawns(const Board& board, const PawnStructure& pawnStructure);
+
+// King shelter and attacker terms from white's point of view
+Score evaluateKingSafety(const Board& board);
+
+// Static evaluation in centipawns from the point of view of the player to move
+int evaluate(const Position& position);
+
+}
+
+#endif // EVALUATION_H
@@ -0,0 +1,81 @@
+#include "frametimehistogram.h"
+
+#include <algorithm>
+
+using namespace Chess;
+
+static constexpr int64_t NANOSECONDS_PER_MILLISECOND = 1000000;
+
+void FrameTimeHistogram::record(int64_t nanoseconds)
+{
+    nanoseconds = std::max<int64_t>(nanoseconds, 0);
+
+    int bucket = std::min<int64_t>(nanoseconds / NANOSECONDS_PER_MILLISECOND, BUCKET_COUNT - 1);
+    m_buckets[bucket]++;
+
+    m_frameCount++;
+    m_totalNanoseconds += nanoseconds;
+    m_maxNanoseconds = std::max(m_maxNanoseconds, nanoseconds);
+}
+
+void FrameTimeHistogram::clear()
+{
+    *this = FrameTimeHistogram();
+}
+
+uint64_t FrameTimeHistogram::frameCount() const
+{
+    return m_frameCount;
+}
+
+uint64_t FrameTimeHistogram::bucket(int milliseconds) const
+{
+    return m_buckets[std::clamp(milliseconds, 0, BUCKET_COUNT - 1)];
+}
+
+double FrameTimeHistogram::averageMilliseconds() const
+{
+    if(m_frameCount == 0)
+    {
+        return 0.0;
+    }
+
+    return static_cast<double>(m_totalNanoseconds) / m_frameCount / NANOSECONDS_PER_MILLISECOND;
+}
+
+double FrameTimeHistogram::maxMilliseconds() const
+{
+    return static_cast<double>(m_maxNanoseconds) / NANOSECONDS_PER_MILLISECOND;
+}
+
+int FrameTimeHistogram::percentileMilliseconds(double fraction) const
+{
+    if(m_frameCount == 0)
+    {
+        return 0;
+    }
+
+    uint64_t threshold = static_cast<uint64_t>(fraction * m_frameCount);
+    uint64_t frames = 0;
+
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        frames += m_buckets[i];
+        if(frames > threshold)
+        {
+            return i + 1;
+        }
+    }
+
+    return BUCKET_COUNT;
+}
+
+QString FrameTimeHistogram::summary() const
+{
+    return QString("%1 frames, avg %2 ms, p50 %3 ms, p95 %4 ms, p99 %5 ms, max %6 ms")
+        .arg(m_frameCount)
+        .arg(averageMilliseconds(), 0, 'f', 1)
+        .arg(percentileMilliseconds(0.50))
+        .arg(percentileMilliseconds(0.95))
+        .arg(percentileMilliseconds(0.99))
+        .arg(maxMilliseconds(), 0, 'f', 1);
+}
@@ -0,0 +1,42 @@
+#ifndef FRAMETIMEHISTOGRAM_H
+#define FRAMETIMEHISTOGRAM_H
+
+#include <QString>
+
+#include <array>
+#include <cstdint>
+
+namespace Chess
+{
+
+// Distribution of the time between frames in one millisecond buckets.
+// Frames taking longer than the last bucket are counted in it.
+class FrameTimeHistogram
+{
+public:
+    static constexpr int BUCKET_COUNT = 64;
+
+    void record(int64_t nanoseconds);
+    void clear();
+
+    uint64_t frameCount() const;
+    uint64_t bucket(int milliseconds) const;
+
+    double averageMilliseconds() const;
+    double maxMilliseconds() const;
+
+    // Upper bound of the bucket containing the given fraction of frames, e.g. 0.95 for the 95th percentile
+    int percentileMilliseconds(double fraction) const;
+
+    // One line like "120 frames, avg 16.7 ms, p50 17 ms, p95 18 ms, p99 25 ms, max 24.3 ms"
+    QString summary() const;
+private:
+    std::array<uint64_t, BUCKET_COUNT> m_buckets = {};
+    uint64_t m_frameCount = 0;
+    int64_t m_totalNanoseconds = 0;
+    int64_t m_maxNanoseconds = 0;
+};
+
+}
+
+#endif // FRAMETIMEHISTOGRAM_H
@@ -0,0 +1,384 @@
+#include "gamefile.h"
+
+#include "binarydata.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <limits>
+
+using namespace Chess;
+
+static constexpr uint8_t PLAYER_TYPE_COUNT = static_cast<uint8_t>(PlayerType::HardBot) + 1;
+
+// A network opponent can't be resumed from a file, they are saved as a human player instead
+static uint8_t storedPlayerType(PlayerType playerType)
+{
+    return static_cast<uint8_t>(playerType == PlayerType::Network ? PlayerType::Human : playerType);
+}
+
+static std::optional<TimeControl> readTimeControl(BinaryReader& reader)
+{
+    std::optional<uint64_t> baseMs = reader.readVarint();
+    std::optional<uint64_t> incrementMs = reader.readVarint();
+    std::optional<uint64_t> delayMs = reader.readVarint();
+    std::optional<uint64_t> movesPerSession = reader.readVarint();
+    if(!baseMs || !incrementMs || !delayMs || !movesPerSession)
+    {
+        return std::nullopt;
+    }
+
+    constexpr uint64_t maxMs = std::numeric_limits<qint64>::max();
+    constexpr uint64_t maxMoves = std::numeric_limits<int>::max();
+    if(*baseMs > maxMs || *incrementMs > maxMs || *delayMs > maxMs || *movesPerSession > maxMoves)
+    {
+        return std::nullopt;
+    }
+
+    TimeControl timeControl;
+    timeControl.baseMs = *baseMs;
+    timeControl.incrementMs = *incrementMs;
+    timeControl.delayMs = *delayMs;
+    timeControl.movesPerSession = *movesPerSession;
+
+    // only timed games store one
+    if(!timeControl.isTimed())
+    {
+        return std::nullopt;
+    }
+
+    return timeControl;
+}
+
+QByteArray Chess::encodeGameRecord(const SavedGame &game)
+{
+    const MatchSettings& settings = game.settings;
+    const Position& startPosition = game.history.basePosition();
+
+    QString startFen = startPosition.toFen();
+    bool hasStartPosition = startFen != Position().toFen();
+
+    uint8_t flags = 0;
+    flags |= hasStartPosition ? HasStartPosition : 0;
+    flags |= settings.openingBookSeed ? HasOpeningBookSeed : 0;
+    flags |= settings.adjudicateWithTablebases ? AdjudicatesWithTablebases : 0;
+    flags |= settings.timeControl.isTimed() ? HasTimeControl : 0;
+
+    QByteArray data;
+    data.append(static_cast<char>(flags));
+    data.append(static_cast<char>(storedPlayerType(settings.white)));
+    data.append(static_cast<char>(storedPlayerType(settings.black)));
+
+    if(settings.openingBookSeed)
+    {
+        appendUInt32(data, *settings.openingBookSeed);
+    }
+
+    if(settings.timeControl.isTimed())
+    {
+        const TimeControl& timeControl = settings.timeControl;
+        appendVarint(data, timeControl.baseMs);
+        appendVarint(data, timeControl.incrementMs);
+        appendVarint(data, timeControl.delayMs);
+        appendVarint(data, timeControl.movesPerSession);
+    }
+
+    appendString(data, settings.openingBookPath);
+    appendString(data, settings.tablebasePath);
+
+    if(hasStartPosition)
+    {
+        appendString(data, startFen);
+    }
+
+    const QVector<Move>& moves = game.history.moves();
+    appendVarint(data, moves.size());
+
+    for (const Move& move : moves) {
+        appendUInt16(data, packMove(move));
+    }
+
+    return data;
+}
+
+std::optional<SavedGame> Chess::decodeGameRecord(const uchar *data, size_t size)
+{
+    BinaryReader reader(data, size);
+
+    std::optional<uint8_t> flags = reader.readUInt8();
+    std::optional<uint8_t> white = reader.readUInt8();
+    std::optional<uint8_t> black = reader.readUInt8();
+    if(!flags || !white || !black || *white >= PLAYER_TYPE_COUNT || *black >= PLAYER_TYPE_COUNT)
+    {
+        return std::nullopt;
+    }
+
+    SavedGame game;
+    game.settings.white = static_cast<PlayerType>(*white);
+    game.settings.black = static_cast<PlayerType>(*black);
+    game.settings.adjudicateWithTablebases = *flags & AdjudicatesWithTablebases;
+
+    if(*flags & HasOpeningBookSeed)
+    {
+        game.settings.openingBookSeed = reader.readUInt32();
+        if(!game.settings.openingBookSeed)
+        {
+            return std::nullopt;
+        }
+    }
+
+    if(*flags & HasTimeControl)
+    {
+        std::optional<TimeControl> timeControl = readTimeControl(reader);
+        if(!timeControl)
+        {
+            return std::nullopt;
+        }
+
+        game.settings.timeControl = *timeControl;
+    }
+
+    std::optional<QString> openingBookPath = reader.readString();
+    std::optional<QString> tablebasePath = reader.readString();
+    if(!openingBookPath || !tablebasePath)
+    {
+        return std::nullopt;
+    }
+
+    game.settings.openingBookPath = *openingBookPath;
+    game.settings.tablebasePath = *tablebasePath;
+
+    Position position;
+    if(*flags & HasStartPosition)
+    {
+        std::optional<QString> startFen = reader.readString();
+        std::optional<Position> startPosition = startFen ? Position::fromFen(*startFen) : std::nullopt;
+        if(!startPosition)
+        {
+            return std::nullopt;
+        }
+
+        position = *startPosition;
+    }
+
+    game.history = MoveHistory(position);
+
+    std::optional<uint64_t> moveCount = reader.readVarint();
+    if(!moveCount)
+    {
+        return std::nullopt;
+    }
+
+    for (uint64_t i = 0; i < *moveCount; ++i) {
+        std::optional<uint16_t> packedMove = reader.readUInt16();
+        std::optional<Move> move = packedMove ? unpackMove(position, *packedMove) : std::nullopt;
+        if(!move)
+        {
+            return std::nullopt;
+        }
+
+        position.doMove(*move);
+        game.history.addMove(*move);
+    }
+
+    if(!reader.isAtEnd())
+    {
+        return std::nullopt;
+    }
+
+    return game;
+}
+
+// Newer versions only add fields behind flags the older ones never set, so a current decoder reads them all
+static bool isKnownVersion(uint16_t version, uint16_t currentVersion)
+{
+    return version >= 1 && version <= currentVersion;
+}
+
+static QByteArray fileHeader(uint32_t magic, uint16_t version)
+{
+    QByteArray header;
+    appendUInt32(header, magic);
+    appendUInt16(header, version);
+    appendUInt16(header, 0);
+    return header;
+}
+
+bool Chess::saveGame(const QString &path, const SavedGame &game)
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QByteArray data = fileHeader(GameFileHeader::MAGIC, GameFileHeader::VERSION);
+    data.append(encodeGameRecord(game));
+
+    return file.write(data) == data.size() && file.commit();
+}
+
+std::optional<SavedGame> Chess::loadGame(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return std::nullopt;
+    }
+
+    QByteArray data = file.readAll();
+    if(static_cast<size_t>(data.size()) < GameFileHeader::SIZE)
+    {
+        return std::nullopt;
+    }
+
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    if(qFromLittleEndian<quint32>(bytes) != GameFileHeader::MAGIC || !isKnownVersion(qFromLittleEndian<quint16>(bytes + 4), GameFileHeader::VERSION))
+    {
+        return std::nullopt;
+    }
+
+    return decodeGameRecord(bytes + GameFileHeader::SIZE, data.size() - GameFileHeader::SIZE);
+}
+
+GameArchive::~GameArchive()
+{
+    close();
+}
+
+bool GameArchive::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    if(size < static_cast<qint64>(GameArchiveHeader::SIZE))
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, size);
+    if(!m_data)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_size = size;
+
+    uint32_t magic = qFromLittleEndian<quint32>(m_data);
+    uint16_t version = qFromLittleEndian<quint16>(m_data + 4);
+    uint64_t gameCount = qFromLittleEndian<quint32>(m_data + 8);
+    uint64_t indexOffset = qFromLittleEndian<quint64>(m_data + 16);
+
+    // the index has to fit exactly at the end of the file
+    bool isValid = magic == GameArchiveHeader::MAGIC
+                   && isKnownVersion(version, GameArchiveHeader::VERSION)
+                   && indexOffset >= GameArchiveHeader::SIZE
+                   && indexOffset <= m_size
+                   && (m_size - indexOffset) == gameCount * GameArchiveHeader::INDEX_ENTRY_SIZE;
+
+    if(!isValid)
+    {
+        close();
+        return false;
+    }
+
+    m_indexOffset = indexOffset;
+    m_gameCount = gameCount;
+
+    return true;
+}
+
+void GameArchive::close()
+{
+    if(m_data)
+    {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+
+    m_size = 0;
+    m_indexOffset = 0;
+    m_gameCount = 0;
+    m_file.close();
+}
+
+bool GameArchive::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+size_t GameArchive::gameCount() const
+{
+    return m_gameCount;
+}
+
+uint64_t GameArchive::recordOffset(size_t index) const
+{
+    if(index == m_gameCount)
+    {
+        return m_indexOffset;
+    }
+
+    return qFromLittleEndian<quint64>(m_data + m_indexOffset + index * GameArchiveHeader::INDEX_ENTRY_SIZE);
+}
+
+std::optional<SavedGame> GameArchive::game(size_t index) const
+{
+    if(index >= m_gameCount)
+    {
+        return std::nullopt;
+    }
+
+    uint64_t begin = recordOffset(index);
+    uint64_t end = recordOffset(index + 1);
+    if(begin < GameArchiveHeader::SIZE || begin > end || end > m_indexOffset)
+    {
+        return std::nullopt;
+    }
+
+    return decodeGameRecord(m_data + begin, end - begin);
+}
+
+bool GameArchive::write(const QString &path, const QVector<SavedGame> &games)
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QByteArray index;
+    index.reserve(games.size() * GameArchiveHeader::INDEX_ENTRY_SIZE);
+
+    // the header is written again once the index offset is known
+    uint64_t offset = GameArchiveHeader::SIZE;
+    bool isWritten = file.write(QByteArray(GameArchiveHeader::SIZE, '\0')) == GameArchiveHeader::SIZE;
+
+    for (const SavedGame& game : games) {
+        QByteArray record = encodeGameRecord(game);
+
+        appendUInt64(index, offset);
+        offset += record.size();
+
+        isWritten = isWritten && file.write(record) == record.size();
+    }
+
+    isWritten = isWritten && file.write(index) == index.size();
+
+    QByteArray header = fileHeader(GameArchiveHeader::MAGIC, GameArchiveHeader::VERSION);
+    appendUInt32(header, games.size());
+    appendUInt32(header, 0);
+    appendUInt64(header, offset);
+
+    isWritten = isWritten && file.seek(0) && file.write(header) == header.size();
+
+    return isWritten && file.commit();
+}
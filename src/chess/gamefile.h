@@ -0,0 +1,113 @@
+#ifndef GAMEFILE_H
+#define GAMEFILE_H
+
+#include "chess.h"
+
+#include <QFile>
+
+namespace Chess
+{
+
+// A game with the settings it was played with, as stored in game files and archives
+struct SavedGame
+{
+    MatchSettings settings;
+    MoveHistory history{Position()};
+};
+
+// Game records are stored little endian:
+//
+//   u8      flags, see GameRecordFlags
+//   u8      white player type
+//   u8      black player type
+//   u32     opening book seed, only with HasOpeningBookSeed
+//   varint  base time, increment and delay in milliseconds and moves per session, only with HasTimeControl
+//   string  opening book path
+//   string  tablebase path
+//   string  FEN of the start position, only with HasStartPosition
+//   varint  move count
+//   u16     per move, from square | to square << 6 | promotion << 12
+//
+// Strings are a varint byte count followed by UTF-8. Squares count from a8 to h1 like Board does.
+// Moves only keep what tells them apart from the other legal moves, loading replays them.
+enum GameRecordFlags : uint8_t
+{
+    HasStartPosition = 1 << 0,
+    HasOpeningBookSeed = 1 << 1,
+    AdjudicatesWithTablebases = 1 << 2,
+    HasTimeControl = 1 << 3,
+};
+
+QByteArray encodeGameRecord(const SavedGame& game);
+
+// Returns nothing if the record is truncated, malformed or contains an illegal move
+std::optional<SavedGame> decodeGameRecord(const uchar* data, size_t size);
+
+// Game files are an 8 byte header, "CHSG" as little endian u32 magic, u16 version and u16 reserved,
+// followed by a single game record.
+// Version 1 records have no time control, their games load as untimed ones.
+struct GameFileHeader
+{
+    static constexpr uint32_t MAGIC = 0x47534843;
+    static constexpr uint16_t VERSION = 2;
+    static constexpr size_t SIZE = 8;
+};
+
+bool saveGame(const QString& path, const SavedGame& game);
+std::optional<SavedGame> loadGame(const QString& path);
+
+// Archives hold many games behind a 24 byte header:
+//
+//   u32  magic "CHSA"
+//   u16  version
+//   u16  reserved
+//   u32  game count
+//   u32  reserved
+//   u64  offset of the index
+//
+// The game records follow the header back to back. The index at the end of the file holds the u64 offset
+// of every record, a record ends where the next one starts or at the index.
+// Versions match those of game files.
+struct GameArchiveHeader
+{
+    static constexpr uint32_t MAGIC = 0x41534843;
+    static constexpr uint16_t VERSION = 2;
+    static constexpr size_t SIZE = 24;
+    static constexpr size_t INDEX_ENTRY_SIZE = 8;
+};
+
+// Reads archives written by GameArchive::write.
+// The file is memory mapped and only the header is checked on open,
+// a game's record is parsed when it is requested.
+class GameArchive
+{
+public:
+    GameArchive() = default;
+    ~GameArchive();
+
+    GameArchive(const GameArchive&) = delete;
+    GameArchive& operator=(const GameArchive&) = delete;
+
+    bool open(const QString& path);
+    void close();
+
+    bool isOpen() const;
+    size_t gameCount() const;
+
+    // Returns nothing for an index out of range or a damaged record
+    std::optional<SavedGame> game(size_t index) const;
+
+    static bool write(const QString& path, const QVector<SavedGame>& games);
+private:
+    uint64_t recordOffset(size_t index) const;
+private:
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    uint64_t m_size = 0;
+    uint64_t m_indexOffset = 0;
+    size_t m_gameCount = 0;
+};
+
+}
+
+#endif // GAMEFILE_H
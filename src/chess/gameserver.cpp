@@ -0,0 +1,517 @@
+#include "gameserver.h"
+
+#include "binarydata.h"
+#include "networkprotocol.h"
+
+#include <QElapsedTimer>
+#include <QTcpSocket>
+
+#include <array>
+
+using namespace Chess;
+
+// Clients that don't read what is sent to them are dropped once this much is waiting for them
+static constexpr qint64 MAX_BUFFERED_BYTES = 64 * 1024;
+
+struct Chess::ServerGame
+{
+    uint32_t id = 0;
+
+    QMutex mutex;
+
+    Position position;
+    int ply = 0;
+
+    // Milliseconds each player spent on their moves, the clock of the player to move runs since the last move
+    std::array<qint64, COLOR_COUNT> timeUsed = {};
+    QElapsedTimer moveTimer;
+
+    std::array<ServerConnection*, COLOR_COUNT> players = {};
+    QVector<ServerConnection*> spectators;
+
+    bool hasStarted = false;
+    bool isOver = false;
+};
+
+// The game's mutex must be held
+static QByteArray snapshotMessage(const ServerGame& game)
+{
+    QByteArray payload;
+    appendVarint(payload, game.ply);
+    appendVarint(payload, game.timeUsed[indexOfColor(Color::White)]);
+    appendVarint(payload, game.timeUsed[indexOfColor(Color::Black)]);
+    appendString(payload, game.position.toFen());
+    return encodeMessage(MessageType::Snapshot, payload);
+}
+
+static QByteArray errorMessage(const QString& message)
+{
+    QByteArray payload;
+    appendString(payload, message);
+    return encodeMessage(MessageType::Error, payload);
+}
+
+namespace Chess
+{
+
+// One client of the GameServer. Lives on one of the server's threads, everything but post must be called there.
+class ServerConnection : public QObject
+{
+public:
+    explicit ServerConnection(GameServer* server)
+        : m_server(server)
+    {
+    }
+
+    ~ServerConnection() override {
+        leaveGame();
+
+        if(m_socket)
+        {
+            m_server->m_connectionCount--;
+        }
+    }
+
+    void start(qintptr socketDescriptor) {
+        m_socket = new QTcpSocket(this);
+        if(!m_socket->setSocketDescriptor(socketDescriptor))
+        {
+            delete m_socket;
+            m_socket = nullptr;
+            deleteLater();
+            return;
+        }
+
+        m_server->m_connectionCount++;
+
+        connect(m_socket, &QTcpSocket::readyRead, this, &ServerConnection::onReadyRead);
+        connect(m_socket, &QTcpSocket::disconnected, this, &ServerConnection::onDisconnected);
+    }
+
+    // Safe to call from any thread, the message is sent from the connection's own thread
+    void post(const QByteArray& message) {
+        QMetaObject::invokeMethod(this, [this, message]() {
+            send(message);
+        }, Qt::QueuedConnection);
+    }
+private:
+    void send(const QByteArray& message) {
+        if(!m_socket)
+        {
+            return;
+        }
+
+        m_socket->write(message);
+
+        // queued, aborting emits disconnected and this may be called with a game locked
+        if(m_socket->bytesToWrite() > MAX_BUFFERED_BYTES)
+        {
+            QMetaObject::invokeMethod(m_socket, &QTcpSocket::abort, Qt::QueuedConnection);
+        }
+    }
+
+    void sendError(const QString& message) {
+        send(errorMessage(message));
+    }
+
+    void onReadyRead() {
+        while(std::optional<NetworkMessage> message = readMessage(*m_socket))
+        {
+            if(message->type == MessageType::Invalid)
+            {
+                m_socket->abort();
+                return;
+            }
+
+            handleMessage(*message);
+        }
+    }
+
+    void onDisconnected() {
+        leaveGame();
+        deleteLater();
+    }
+
+    void handleMessage(const NetworkMessage& message) {
+        BinaryReader reader(reinterpret_cast<const uchar*>(message.payload.constData()), message.payload.size());
+
+        switch(message.type)
+        {
+        case MessageType::CreateGame:
+        {
+            std::optional<uint8_t> color = reader.readUInt8();
+            if(!color || *color >= COLOR_COUNT || !reader.isAtEnd())
+            {
+                break;
+            }
+
+            createGame(static_cast<Color>(*color));
+            return;
+        }
+        case MessageType::JoinGame:
+        case MessageType::WatchGame:
+        {
+            std::optional<uint32_t> gameId = reader.readUInt32();
+            if(!gameId || !reader.isAtEnd())
+            {
+                break;
+            }
+
+            if(message.type == MessageType::JoinGame)
+            {
+                joinGame(*gameId);
+            }
+            else
+            {
+                watchGame(*gameId);
+            }
+            return;
+        }
+        case MessageType::PlayMove:
+        {
+            std::optional<uint16_t> packedMove = reader.readUInt16();
+            if(!packedMove || !reader.isAtEnd())
+            {
+                break;
+            }
+
+            playMove(*packedMove);
+            return;
+        }
+        case MessageType::LeaveGame:
+            leaveGame();
+            return;
+        case MessageType::RequestSnapshot:
+            sendSnapshot();
+            return;
+        default:
+            sendError("Unknown message");
+            return;
+        }
+
+        sendError("Malformed message");
+    }
+
+    bool isPlayingRunningGame() const {
+        if(!m_game || m_role == GameRole::Spectator)
+        {
+            return false;
+        }
+
+        QMutexLocker locker(&m_game->mutex);
+        return !m_game->isOver;
+    }
+
+    void sendJoined(uint32_t gameId) {
+        QByteArray payload;
+        appendUInt32(payload, gameId);
+        payload.append(static_cast<char>(m_role));
+        send(encodeMessage(MessageType::GameJoined, payload));
+    }
+
+    void createGame(Color color) {
+        if(isPlayingRunningGame())
+        {
+            sendError("Already in a game");
+            return;
+        }
+
+        leaveGame();
+
+        m_role = static_cast<GameRole>(indexOfColor(color));
+        m_game = m_server->createGame(this, color);
+
+        sendJoined(m_game->id);
+    }
+
+    void joinGame(uint32_t gameId) {
+        if(isPlayingRunningGame())
+        {
+            sendError("Already in a game");
+            return;
+        }
+
+        leaveGame();
+
+        std::shared_ptr<ServerGame> game = m_server->joinGame(gameId, this);
+        if(!game)
+        {
+            sendError("No such game is waiting for a player");
+            return;
+        }
+
+        m_game = game;
+
+        QMutexLocker locker(&game->mutex);
+        m_role = game->players[indexOfColor(Color::White)] == this ? GameRole::White : GameRole::Black;
+
+        sendJoined(game->id);
+
+        // spectators that came early get the start position with the players
+        game->moveTimer.start();
+        broadcast(*game, snapshotMessage(*game));
+    }
+
+    void watchGame(uint32_t gameId) {
+        if(isPlayingRunningGame())
+        {
+            sendError("Already in a game");
+            return;
+        }
+
+        leaveGame();
+
+        std::shared_ptr<ServerGame> game = m_server->findGame(gameId);
+        if(!game)
+        {
+            sendError("No such game");
+            return;
+        }
+
+        m_game = game;
+        m_role = GameRole::Spectator;
+
+        QMutexLocker locker(&game->mutex);
+        game->spectators.append(this);
+
+        sendJoined(game->id);
+
+        if(game->hasStarted)
+        {
+            send(snapshotMessage(*game));
+        }
+    }
+
+    void sendSnapshot() {
+        if(!m_game)
+        {
+            sendError("Not in a game");
+            return;
+        }
+
+        QMutexLocker locker(&m_game->mutex);
+        if(m_game->hasStarted)
+        {
+            send(snapshotMessage(*m_game));
+        }
+    }
+
+    void playMove(uint16_t packedMove) {
+        if(!m_game || m_role == GameRole::Spectator)
+        {
+            sendError("Not playing a game");
+            return;
+        }
+
+        QMutexLocker locker(&m_game->mutex);
+
+        Position& position = m_game->position;
+        if(!m_game->hasStarted || m_game->isOver)
+        {
+            sendError("The game is not running");
+            return;
+        }
+
+        Color color = static_cast<Color>(m_role);
+        if(position.currentPlayer() != color)
+        {
+            sendError("Not your turn");
+            return;
+        }
+
+        std::optional<Move> move = unpackMove(position, packedMove);
+        if(!move)
+        {
+            sendError("Illegal move");
+            return;
+        }
+
+        position.doMove(*move);
+        m_game->ply++;
+
+        qint64 timeUsed = m_game->moveTimer.restart();
+        m_game->timeUsed[indexOfColor(color)] += timeUsed;
+
+        QByteArray payload;
+        appendUInt16(payload, packMove(*move));
+        appendVarint(payload, timeUsed);
+        broadcast(*m_game, encodeMessage(MessageType::MovePlayed, payload), this);
+
+        // the mover played the move already, it only learns how long the server says it took
+        QByteArray accepted;
+        accepted.append(static_cast<char>(color));
+        appendVarint(accepted, timeUsed);
+        send(encodeMessage(MessageType::MoveAccepted, accepted));
+
+        if(m_game->ply % CHECKSUM_INTERVAL == 0)
+        {
+            QByteArray checksum;
+            appendVarint(checksum, m_game->ply);
+            appendUInt64(checksum, position.hash());
+            broadcast(*m_game, encodeMessage(MessageType::Checksum, checksum));
+        }
+
+        m_game->isOver = position.getLegalMoves().empty();
+
+        bool isOver = m_game->isOver;
+        uint32_t gameId = m_game->id;
+        locker.unlock();
+
+        if(isOver)
+        {
+            m_server->removeGame(gameId);
+        }
+    }
+
+    void leaveGame() {
+        if(!m_game)
+        {
+            return;
+        }
+
+        std::shared_ptr<ServerGame> game = std::move(m_game);
+
+        QMutexLocker locker(&game->mutex);
+
+        // nothing is posted to this connection once it has left, so it can be deleted safely
+        if(m_role == GameRole::Spectator)
+        {
+            game->spectators.removeOne(this);
+            return;
+        }
+
+        game->players[static_cast<size_t>(m_role)] = nullptr;
+
+        if(!game->isOver)
+        {
+            broadcast(*game, encodeMessage(MessageType::PlayerLeft));
+        }
+
+        game->isOver = true;
+        locker.unlock();
+
+        m_server->removeGame(game->id);
+    }
+
+    // The game's mutex must be held
+    static void broadcast(const ServerGame& game, const QByteArray& message, const ServerConnection* except = nullptr) {
+        for (ServerConnection* player : game.players) {
+            if(player && player != except)
+            {
+                player->post(message);
+            }
+        }
+
+        for (ServerConnection* spectator : game.spectators) {
+            spectator->post(message);
+        }
+    }
+private:
+    GameServer* m_server;
+    QTcpSocket* m_socket = nullptr;
+
+    std::shared_ptr<ServerGame> m_game;
+    GameRole m_role = GameRole::Spectator;
+};
+
+}
+
+GameServer::GameServer(int threadCount, QObject *parent)
+    : QTcpServer(parent)
+{
+    for (int i = 0; i < std::max(threadCount, 1); ++i) {
+        auto thread = new QThread();
+        thread->start();
+        m_threads.append(thread);
+    }
+}
+
+GameServer::~GameServer()
+{
+    close();
+
+    // connections still open are deleted as their thread finishes
+    for (QThread* thread : m_threads) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+}
+
+int GameServer::connectionCount() const
+{
+    return m_connectionCount;
+}
+
+int GameServer::gameCount() const
+{
+    QMutexLocker locker(&m_gamesMutex);
+    return m_games.size();
+}
+
+void GameServer::incomingConnection(qintptr socketDescriptor)
+{
+    QThread* thread = m_threads[m_nextThread];
+    m_nextThread = (m_nextThread + 1) % m_threads.size();
+
+    auto connection = new ServerConnection(this);
+    connection->moveToThread(thread);
+    connect(thread, &QThread::finished, connection, &QObject::deleteLater);
+
+    // the socket has to be created on the thread that uses it
+    QMetaObject::invokeMethod(connection, [connection, socketDescriptor]() {
+        connection->start(socketDescriptor);
+    }, Qt::QueuedConnection);
+}
+
+std::shared_ptr<ServerGame> GameServer::createGame(ServerConnection *creator, Color color)
+{
+    auto game = std::make_shared<ServerGame>();
+    game->players[indexOfColor(color)] = creator;
+
+    QMutexLocker locker(&m_gamesMutex);
+    game->id = m_nextGameId++;
+    m_games.insert(game->id, game);
+
+    return game;
+}
+
+std::shared_ptr<ServerGame> GameServer::joinGame(uint32_t gameId, ServerConnection *player)
+{
+    QMutexLocker locker(&m_gamesMutex);
+
+    std::shared_ptr<ServerGame> game = m_games.value(gameId);
+    if(!game)
+    {
+        return nullptr;
+    }
+
+    QMutexLocker gameLocker(&game->mutex);
+    if(game->hasStarted || game->isOver)
+    {
+        return nullptr;
+    }
+
+    for (ServerConnection*& slot : game->players) {
+        if(!slot)
+        {
+            slot = player;
+            game->hasStarted = true;
+            return game;
+        }
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<ServerGame> GameServer::findGame(uint32_t gameId) const
+{
+    QMutexLocker locker(&m_gamesMutex);
+    return m_games.value(gameId);
+}
+
+void GameServer::removeGame(uint32_t gameId)
+{
+    QMutexLocker locker(&m_gamesMutex);
+    m_games.remove(gameId);
+}
@@ -0,0 +1,72 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include "chess.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QTcpServer>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+
+namespace Chess
+{
+
+class ServerConnection;
+struct ServerGame;
+
+// Hosts any number of games between NetworkClients, speaking the binary protocol of networkprotocol.h.
+//
+// A client creates a game and plays the color it picked, the second player joins it by its id.
+// Any number of spectators may watch a game, also one that is already running: they get a snapshot
+// of the position and from then on the same stream of moves as the players.
+//
+// Every move is checked against the server's own position, so clients can't play illegal moves or out of turn.
+// Connections are spread over a fixed set of threads that each run an event loop, an idle connection costs
+// nothing but its socket. The clients of a game may be on different threads, games are locked one by one
+// and every message is encoded once and queued to the threads of all its receivers.
+class GameServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    static constexpr quint16 DEFAULT_PORT = 7070;
+
+    explicit GameServer(int threadCount = QThread::idealThreadCount(), QObject *parent = nullptr);
+
+    // Closes every connection
+    ~GameServer() override;
+
+    int connectionCount() const;
+
+    // Games that are waiting for their second player or running
+    int gameCount() const;
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+private:
+    friend class ServerConnection;
+
+    std::shared_ptr<ServerGame> createGame(ServerConnection* creator, Color color);
+
+    // Returns nothing if there is no such game or both of its players are already there
+    std::shared_ptr<ServerGame> joinGame(uint32_t gameId, ServerConnection* player);
+
+    std::shared_ptr<ServerGame> findGame(uint32_t gameId) const;
+
+    void removeGame(uint32_t gameId);
+private:
+    QVector<QThread*> m_threads;
+    int m_nextThread = 0;
+
+    std::atomic<int> m_connectionCount{0};
+
+    // Locked before the mutex of any game, never after
+    mutable QMutex m_gamesMutex;
+    QHash<uint32_t, std::shared_ptr<ServerGame>> m_games;
+    uint32_t m_nextGameId = 1;
+};
+
+}
+
+#endif // GAMESERVER_H
@@ -0,0 +1,236 @@
+#include "gifwriter.h"
+
+#include <optional>
+#include <unordered_map>
+
+using namespace Chess;
+
+static constexpr int LZW_MIN_CODE_SIZE = 8;
+static constexpr uint32_t LZW_MAX_CODE = 4095;
+static constexpr int COLOR_TABLE_SIZE = 1 << LZW_MIN_CODE_SIZE;
+
+static void appendUInt16(QByteArray& data, uint16_t value)
+{
+    data.append(static_cast<char>(value & 0xff));
+    data.append(static_cast<char>(value >> 8));
+}
+
+namespace
+{
+
+// Packs codes least significant bit first into the 255 byte sub-blocks of GIF image data
+class BitWriter
+{
+public:
+    explicit BitWriter(QByteArray& output)
+        : m_output(output)
+    {
+    }
+
+    void write(uint32_t code, int bitCount) {
+        m_bits |= code << m_bitCount;
+        m_bitCount += bitCount;
+
+        while(m_bitCount >= 8)
+        {
+            appendByte(static_cast<char>(m_bits & 0xff));
+            m_bits >>= 8;
+            m_bitCount -= 8;
+        }
+    }
+
+    void finish() {
+        if(m_bitCount > 0)
+        {
+            appendByte(static_cast<char>(m_bits & 0xff));
+        }
+
+        flushBlock();
+
+        // block terminator
+        m_output.append('\0');
+    }
+private:
+    void appendByte(char byte) {
+        m_block.append(byte);
+
+        if(m_block.size() == 255)
+        {
+            flushBlock();
+        }
+    }
+
+    void flushBlock() {
+        if(m_block.isEmpty())
+        {
+            return;
+        }
+
+        m_output.append(static_cast<char>(m_block.size()));
+        m_output.append(m_block);
+        m_block.clear();
+    }
+
+    QByteArray& m_output;
+    QByteArray m_block;
+    uint32_t m_bits = 0;
+    int m_bitCount = 0;
+};
+
+}
+
+static void appendLzwData(QByteArray& output, const QImage& indexedImage)
+{
+    const uint32_t clearCode = 1 << LZW_MIN_CODE_SIZE;
+    const uint32_t endCode = clearCode + 1;
+
+    output.append(static_cast<char>(LZW_MIN_CODE_SIZE));
+
+    BitWriter writer(output);
+
+    // (prefix code << 8 | next index) -> code of the extended string
+    std::unordered_map<uint32_t, uint32_t> codes;
+    codes.reserve(LZW_MAX_CODE);
+
+    int codeSize = LZW_MIN_CODE_SIZE + 1;
+    uint32_t lastCode = endCode;
+    std::optional<uint32_t> current;
+
+    writer.write(clearCode, codeSize);
+
+    for (int y = 0; y < indexedImage.height(); ++y) {
+        const uchar* line = indexedImage.constScanLine(y);
+
+        for (int x = 0; x < indexedImage.width(); ++x) {
+            uchar index = line[x];
+            if(!current)
+            {
+                current = index;
+                continue;
+            }
+
+            uint32_t key = *current << 8 | index;
+            auto code = codes.find(key);
+            if(code != std::end(codes))
+            {
+                current = code->second;
+                continue;
+            }
+
+            writer.write(*current, codeSize);
+
+            codes[key] = ++lastCode;
+            if(lastCode >= (1u << codeSize))
+            {
+                codeSize++;
+            }
+
+            // the code table is full, start over instead of growing past 12 bits
+            if(lastCode == LZW_MAX_CODE)
+            {
+                writer.write(clearCode, codeSize);
+                codes.clear();
+                codeSize = LZW_MIN_CODE_SIZE + 1;
+                lastCode = endCode;
+            }
+
+            current = index;
+        }
+    }
+
+    if(current)
+    {
+        writer.write(*current, codeSize);
+
+        // the decoder adds a table entry for this code as well, which may widen the end code
+        if(lastCode + 1 >= (1u << codeSize))
+        {
+            codeSize++;
+        }
+    }
+
+    writer.write(endCode, codeSize);
+    writer.finish();
+}
+
+bool GifWriter::open(const QString &path, QSize size, int loopCount)
+{
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    m_size = size;
+
+    QByteArray header("GIF89a");
+
+    // logical screen descriptor without a global color table, every frame brings its own
+    appendUInt16(header, m_size.width());
+    appendUInt16(header, m_size.height());
+    header.append('\0');
+    header.append('\0');
+    header.append('\0');
+
+    // NETSCAPE2.0 application extension for the loop count
+    header.append("\x21\xff\x0b", 3);
+    header.append("NETSCAPE2.0");
+    header.append("\x03\x01", 2);
+    appendUInt16(header, loopCount);
+    header.append('\0');
+
+    return m_file.write(header) == header.size();
+}
+
+bool GifWriter::addFrame(const QImage &frame, int delay)
+{
+    if(!m_file.isOpen() || frame.size() != m_size)
+    {
+        return false;
+    }
+
+    QImage indexedImage = frame.convertToFormat(QImage::Format_RGB32).convertToFormat(QImage::Format_Indexed8, Qt::DiffuseDither);
+
+    QByteArray data;
+
+    // graphic control extension, frames are left in place for the next one to draw over
+    data.append("\x21\xf9\x04", 3);
+    data.append(static_cast<char>(1 << 2));
+    appendUInt16(data, (delay + 5) / 10);
+    data.append('\0');
+    data.append('\0');
+
+    // image descriptor with a local color table of 2^(7 + 1) colors
+    data.append('\x2c');
+    appendUInt16(data, 0);
+    appendUInt16(data, 0);
+    appendUInt16(data, m_size.width());
+    appendUInt16(data, m_size.height());
+    data.append(static_cast<char>(0x80 | (LZW_MIN_CODE_SIZE - 1)));
+
+    QVector<QRgb> colorTable = indexedImage.colorTable();
+    for (int i = 0; i < COLOR_TABLE_SIZE; ++i) {
+        QRgb color = i < colorTable.size() ? colorTable[i] : qRgb(0, 0, 0);
+        data.append(static_cast<char>(qRed(color)));
+        data.append(static_cast<char>(qGreen(color)));
+        data.append(static_cast<char>(qBlue(color)));
+    }
+
+    appendLzwData(data, indexedImage);
+
+    return m_file.write(data) == data.size();
+}
+
+bool GifWriter::close()
+{
+    if(!m_file.isOpen())
+    {
+        return false;
+    }
+
+    // trailer
+    bool isWritten = m_file.write("\x3b", 1) == 1;
+    m_file.close();
+
+    return isWritten;
+}
@@ -0,0 +1,30 @@
+#ifndef GIFWRITER_H
+#define GIFWRITER_H
+
+#include <QFile>
+#include <QImage>
+
+namespace Chess
+{
+
+// Writes animated GIF89a files, Qt's image plugins can read GIFs but not write them.
+// Every frame gets its own 256 color palette from QImage's conversion to Format_Indexed8.
+class GifWriter
+{
+public:
+    // Loops forever if the loop count is 0
+    bool open(const QString& path, QSize size, int loopCount = 0);
+
+    // Delay in milliseconds until the next frame, GIFs store it in hundredths of a second.
+    // The frame must have the size given to open.
+    bool addFrame(const QImage& frame, int delay);
+
+    bool close();
+private:
+    QFile m_file;
+    QSize m_size;
+};
+
+}
+
+#endif // GIFWRITER_H
@@ -0,0 +1,205 @@
+#include "loadgenerator.h"
+
+#include "networkclient.h"
+
+#include <QEventLoop>
+#include <QHash>
+#include <QTimer>
+
+#include <algorithm>
+
+using namespace Chess;
+
+struct LoadGenerator::LoadGame
+{
+    std::unique_ptr<NetworkClient> white;
+    std::unique_ptr<NetworkClient> black;
+    std::vector<std::unique_ptr<NetworkClient>> spectators;
+
+    int connectedCount = 0;
+    std::optional<uint32_t> gameId;
+
+    // When the move that leads to a ply was sent, in nanoseconds of m_clock
+    QHash<int, qint64> sentAt;
+
+    int clientCount() const {
+        return 2 + spectators.size();
+    }
+};
+
+static double percentileMs(std::vector<qint64>& samples, double percentile)
+{
+    if(samples.empty())
+    {
+        return 0;
+    }
+
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(samples.size() * percentile));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] / 1e6;
+}
+
+double LoadReport::messagesPerSecond() const
+{
+    return durationMs > 0 ? messageCount * 1000.0 / durationMs : 0;
+}
+
+LoadGenerator::LoadGenerator(const LoadOptions &options, QObject *parent)
+    : QObject(parent),
+    m_options(options),
+    m_random(options.seed)
+{
+}
+
+LoadGenerator::~LoadGenerator() = default;
+
+LoadReport LoadGenerator::run()
+{
+    m_report = LoadReport();
+    m_latenciesNs.clear();
+    m_games.clear();
+
+    int gameCount = std::max(m_options.playerCount / 2, 1);
+    for (int i = 0; i < gameCount; ++i) {
+        auto game = std::make_unique<LoadGame>();
+        game->white = std::make_unique<NetworkClient>();
+        game->black = std::make_unique<NetworkClient>();
+        m_games.push_back(std::move(game));
+    }
+
+    for (int i = 0; i < m_options.spectatorCount; ++i) {
+        m_games[i % gameCount]->spectators.push_back(std::make_unique<NetworkClient>());
+    }
+
+    for (const std::unique_ptr<LoadGame>& game : m_games) {
+        connectGame(*game);
+    }
+
+    m_clock.start();
+
+    QEventLoop loop;
+    QTimer::singleShot(m_options.durationMs, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    m_report.durationMs = m_clock.elapsed();
+
+    for (const std::unique_ptr<LoadGame>& game : m_games) {
+        m_report.messageCount += game->white->receivedMessageCount() + game->black->receivedMessageCount();
+        for (const std::unique_ptr<NetworkClient>& spectator : game->spectators) {
+            m_report.messageCount += spectator->receivedMessageCount();
+        }
+    }
+
+    m_report.p50LatencyMs = percentileMs(m_latenciesNs, 0.5);
+    m_report.p99LatencyMs = percentileMs(m_latenciesNs, 0.99);
+
+    // every client disconnects before the loop that could deliver their signals is gone
+    m_games.clear();
+
+    return m_report;
+}
+
+void LoadGenerator::connectGame(LoadGame &game)
+{
+    NetworkClient* white = game.white.get();
+    NetworkClient* black = game.black.get();
+
+    std::vector<NetworkClient*> clients = {white, black};
+    for (const std::unique_ptr<NetworkClient>& spectator : game.spectators) {
+        clients.push_back(spectator.get());
+    }
+
+    for (NetworkClient* client : clients) {
+        // white creates the first game once everyone is there
+        connect(client, &NetworkClient::connected, this, [&game]() {
+            if(++game.connectedCount == game.clientCount())
+            {
+                game.white->createGame(Color::White);
+            }
+        });
+
+        connect(client, &NetworkClient::errorReceived, this, [this]() {
+            m_report.errorCount++;
+        });
+
+        client->connectToServer(m_options.host, m_options.port);
+    }
+
+    connect(white, &NetworkClient::gameJoined, this, [this, &game](uint32_t gameId) {
+        game.gameId = gameId;
+        game.sentAt.clear();
+        m_report.gameCount++;
+
+        game.black->joinGame(gameId);
+        for (const std::unique_ptr<NetworkClient>& spectator : game.spectators) {
+            spectator->watchGame(gameId);
+        }
+    });
+
+    connect(white, &NetworkClient::gameStarted, this, [this, &game]() {
+        playRandomMove(game, *game.white);
+    });
+
+    for (NetworkClient* client : clients) {
+        connect(client, &NetworkClient::moveReceived, this, [this, &game, client]() {
+            onMoveReceived(game, *client);
+        });
+    }
+}
+
+void LoadGenerator::playRandomMove(LoadGame &game, NetworkClient &player)
+{
+    QVector<Move> moves = player.position().getLegalMoves();
+    std::uniform_int_distribution<qsizetype> distribution(0, moves.size() - 1);
+
+    game.sentAt.insert(player.ply() + 1, m_clock.nsecsElapsed());
+    player.sendMove(moves[distribution(m_random)]);
+    m_report.moveCount++;
+
+    if(isFinished(player) && &player == game.white.get())
+    {
+        restartGame(game);
+    }
+}
+
+void LoadGenerator::onMoveReceived(LoadGame &game, NetworkClient &client)
+{
+    // spectators may still get the moves of the last game for a moment
+    auto sentAt = game.sentAt.constFind(client.ply());
+    if(client.gameId() == game.gameId && sentAt != game.sentAt.constEnd())
+    {
+        m_latenciesNs.push_back(m_clock.nsecsElapsed() - *sentAt);
+    }
+
+    bool isPlayer = &client == game.white.get() || &client == game.black.get();
+    if(!isPlayer)
+    {
+        return;
+    }
+
+    // white starts the next game whoever made the last move, so black's join never races the old game
+    if(isFinished(client))
+    {
+        if(&client == game.white.get())
+        {
+            restartGame(game);
+        }
+        return;
+    }
+
+    playRandomMove(game, client);
+}
+
+void LoadGenerator::restartGame(LoadGame &game)
+{
+    game.gameId.reset();
+
+    // the server handles both in order, the old game is over before black is asked to join the new one
+    game.white->leaveGame();
+    game.white->createGame(Color::White);
+}
+
+bool LoadGenerator::isFinished(const NetworkClient &client) const
+{
+    return client.ply() >= m_options.maxPly || client.position().getLegalMoves().empty();
+}
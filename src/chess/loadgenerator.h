@@ -0,0 +1,85 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include "chess.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <memory>
+#include <random>
+
+namespace Chess
+{
+
+struct LoadOptions
+{
+    QString host = "127.0.0.1";
+    quint16 port = 0;
+
+    // Two players per game, the spectators are spread over the games
+    int playerCount = 100;
+    int spectatorCount = 100;
+
+    qint64 durationMs = 10000;
+
+    // Games that get this long are left and a new one is started
+    int maxPly = 200;
+
+    uint32_t seed = 1;
+};
+
+struct LoadReport
+{
+    qint64 durationMs = 0;
+
+    uint64_t gameCount = 0;
+    uint64_t moveCount = 0;
+
+    // Everything the clients received, moves, checksums and snapshots
+    uint64_t messageCount = 0;
+
+    // From a player sending a move until its opponent or a spectator received it
+    double p50LatencyMs = 0;
+    double p99LatencyMs = 0;
+
+    uint64_t errorCount = 0;
+
+    double messagesPerSecond() const;
+};
+
+// Simulates players and spectators against a GameServer. The players of a game answer every move
+// with a random legal move right away, so the load is only limited by how fast the server relays them.
+// All clients live on the thread that calls run.
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LoadGenerator(const LoadOptions& options, QObject *parent = nullptr);
+    ~LoadGenerator() override;
+
+    // Connects every client and plays games until the duration passed
+    LoadReport run();
+private:
+    struct LoadGame;
+
+    void connectGame(LoadGame& game);
+    void playRandomMove(LoadGame& game, NetworkClient& player);
+    void onMoveReceived(LoadGame& game, NetworkClient& client);
+    void restartGame(LoadGame& game);
+    bool isFinished(const NetworkClient& client) const;
+private:
+    LoadOptions m_options;
+
+    std::vector<std::unique_ptr<LoadGame>> m_games;
+
+    std::mt19937 m_random;
+    QElapsedTimer m_clock;
+
+    std::vector<qint64> m_latenciesNs;
+    LoadReport m_report;
+};
+
+}
+
+#endif // LOADGENERATOR_H
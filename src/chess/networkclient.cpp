@@ -0,0 +1,240 @@
+#include "networkclient.h"
+
+#include "binarydata.h"
+#include "networkprotocol.h"
+
+using namespace Chess;
+
+NetworkClient::NetworkClient(QObject *parent)
+    : QObject(parent),
+    m_socket(new QTcpSocket(this))
+{
+    // moves are a few bytes, don't wait to fill a packet
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+    connect(m_socket, &QTcpSocket::connected, this, &NetworkClient::connected);
+    connect(m_socket, &QTcpSocket::disconnected, this, &NetworkClient::disconnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &NetworkClient::onReadyRead);
+
+    connect(m_socket, &QTcpSocket::errorOccurred, this, [this]() {
+        emit errorReceived(m_socket->errorString());
+    });
+}
+
+void NetworkClient::connectToServer(const QString &host, quint16 port)
+{
+    m_socket->connectToHost(host, port);
+}
+
+void NetworkClient::disconnectFromServer()
+{
+    m_socket->disconnectFromHost();
+}
+
+bool NetworkClient::isConnected() const
+{
+    return m_socket->state() == QAbstractSocket::ConnectedState;
+}
+
+void NetworkClient::createGame(Color color)
+{
+    QByteArray payload;
+    payload.append(static_cast<char>(indexOfColor(color)));
+    m_socket->write(encodeMessage(MessageType::CreateGame, payload));
+}
+
+void NetworkClient::joinGame(uint32_t gameId)
+{
+    QByteArray payload;
+    appendUInt32(payload, gameId);
+    m_socket->write(encodeMessage(MessageType::JoinGame, payload));
+}
+
+void NetworkClient::watchGame(uint32_t gameId)
+{
+    QByteArray payload;
+    appendUInt32(payload, gameId);
+    m_socket->write(encodeMessage(MessageType::WatchGame, payload));
+}
+
+void NetworkClient::leaveGame()
+{
+    m_socket->write(encodeMessage(MessageType::LeaveGame));
+}
+
+void NetworkClient::sendMove(const Move &move)
+{
+    QByteArray payload;
+    appendUInt16(payload, packMove(move));
+    m_socket->write(encodeMessage(MessageType::PlayMove, payload));
+
+    m_position.doMove(move);
+    m_ply++;
+}
+
+std::optional<uint32_t> NetworkClient::gameId() const
+{
+    return m_gameId;
+}
+
+const Position &NetworkClient::position() const
+{
+    return m_position;
+}
+
+int NetworkClient::ply() const
+{
+    return m_ply;
+}
+
+qint64 NetworkClient::timeUsed(Color color) const
+{
+    return m_timeUsed[indexOfColor(color)];
+}
+
+uint64_t NetworkClient::receivedMessageCount() const
+{
+    return m_receivedMessageCount;
+}
+
+void NetworkClient::onReadyRead()
+{
+    while(std::optional<NetworkMessage> message = readMessage(*m_socket))
+    {
+        if(message->type == MessageType::Invalid)
+        {
+            m_socket->abort();
+            emit errorReceived("The server sent a malformed message");
+            return;
+        }
+
+        m_receivedMessageCount++;
+        handleMessage(*message);
+    }
+}
+
+void NetworkClient::requestSnapshot()
+{
+    m_isWaitingForSnapshot = true;
+    m_socket->write(encodeMessage(MessageType::RequestSnapshot));
+}
+
+void NetworkClient::handleMessage(const NetworkMessage &message)
+{
+    BinaryReader reader(reinterpret_cast<const uchar*>(message.payload.constData()), message.payload.size());
+
+    switch(message.type)
+    {
+    case MessageType::GameJoined:
+    {
+        std::optional<uint32_t> gameId = reader.readUInt32();
+        std::optional<uint8_t> role = reader.readUInt8();
+        if(!gameId || !role || *role > static_cast<uint8_t>(GameRole::Spectator))
+        {
+            break;
+        }
+
+        m_gameId = gameId;
+        m_position = Position();
+        m_ply = 0;
+        m_timeUsed = {};
+        m_hasGameStarted = false;
+        m_isWaitingForSnapshot = false;
+
+        if(static_cast<GameRole>(*role) == GameRole::Spectator)
+        {
+            emit watchingGame(*gameId);
+        }
+        else
+        {
+            emit gameJoined(*gameId, static_cast<Color>(*role));
+        }
+        break;
+    }
+    case MessageType::Snapshot:
+    {
+        std::optional<uint64_t> ply = reader.readVarint();
+        std::optional<uint64_t> whiteTimeUsed = reader.readVarint();
+        std::optional<uint64_t> blackTimeUsed = reader.readVarint();
+        std::optional<QString> fen = reader.readString();
+        std::optional<Position> position = fen ? Position::fromFen(*fen) : std::nullopt;
+        if(!ply || !whiteTimeUsed || !blackTimeUsed || !position)
+        {
+            break;
+        }
+
+        m_position = *position;
+        m_ply = *ply;
+        m_timeUsed = {static_cast<qint64>(*whiteTimeUsed), static_cast<qint64>(*blackTimeUsed)};
+        m_isWaitingForSnapshot = false;
+
+        if(m_hasGameStarted)
+        {
+            emit resynchronized();
+        }
+        else
+        {
+            m_hasGameStarted = true;
+            emit gameStarted();
+        }
+        break;
+    }
+    case MessageType::MovePlayed:
+    {
+        std::optional<uint16_t> packedMove = reader.readUInt16();
+        std::optional<uint64_t> timeUsed = reader.readVarint();
+        if(!packedMove || !timeUsed || m_isWaitingForSnapshot)
+        {
+            break;
+        }
+
+        std::optional<Move> move = unpackMove(m_position, *packedMove);
+        if(!move)
+        {
+            requestSnapshot();
+            break;
+        }
+
+        m_timeUsed[indexOfColor(m_position.currentPlayer())] += *timeUsed;
+        m_position.doMove(*move);
+        m_ply++;
+
+        emit moveReceived(*move);
+        break;
+    }
+    case MessageType::MoveAccepted:
+    {
+        // the server answers the client's own move with this right away, a later snapshot replaces the sum anyway
+        std::optional<uint8_t> color = reader.readUInt8();
+        std::optional<uint64_t> timeUsed = reader.readVarint();
+        if(!color || !timeUsed || *color >= COLOR_COUNT)
+        {
+            break;
+        }
+
+        m_timeUsed[indexOfColor(static_cast<Color>(*color))] += *timeUsed;
+        break;
+    }
+    case MessageType::Checksum:
+    {
+        std::optional<uint64_t> ply = reader.readVarint();
+        std::optional<uint64_t> hash = reader.readUInt64();
+        if(ply && hash && !m_isWaitingForSnapshot && *ply == static_cast<uint64_t>(m_ply) && *hash != m_position.hash())
+        {
+            requestSnapshot();
+        }
+        break;
+    }
+    case MessageType::PlayerLeft:
+        emit playerLeft();
+        break;
+    case MessageType::Error:
+    {
+        std::optional<QString> text = reader.readString();
+        emit errorReceived(text ? *text : QString("Unknown error"));
+        break;
+    }
+    default:
+        break;
+    }
+}
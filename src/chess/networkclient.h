@@ -0,0 +1,91 @@
+#ifndef NETWORKCLIENT_H
+#define NETWORKCLIENT_H
+
+#include "chess.h"
+
+#include <QObject>
+#include <QTcpSocket>
+
+#include <array>
+
+namespace Chess
+{
+
+struct NetworkMessage;
+
+// The player and spectator side of the GameServer protocol. The client follows the game it is in,
+// every move received is played on its position and checked against the server's checksums.
+class NetworkClient : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NetworkClient(QObject *parent = nullptr);
+
+    void connectToServer(const QString& host, quint16 port);
+    void disconnectFromServer();
+    bool isConnected() const;
+
+    // Should only be called once connected was emitted
+    void createGame(Color color);
+    void joinGame(uint32_t gameId);
+    void watchGame(uint32_t gameId);
+    void leaveGame();
+
+    // Also plays the move on position()
+    void sendMove(const Move& move);
+
+    // The game the client last joined or watched
+    std::optional<uint32_t> gameId() const;
+
+    // The position of the game, valid once gameStarted was emitted
+    const Position& position() const;
+
+    // Moves played since the start position of the game
+    int ply() const;
+
+    // Milliseconds the player spent on their moves so far, as the server measured it.
+    // Own moves count once the server accepted them.
+    qint64 timeUsed(Color color) const;
+
+    uint64_t receivedMessageCount() const;
+signals:
+    void connected();
+    void disconnected();
+
+    void gameJoined(uint32_t gameId, Color color);
+    void watchingGame(uint32_t gameId);
+
+    // The first snapshot of the game arrived, spectators of a running game start in the middle of it
+    void gameStarted();
+
+    // A move of someone else, already played on position()
+    void moveReceived(const Move& move);
+
+    // The position didn't match the server's and was replaced by a new snapshot
+    void resynchronized();
+
+    void playerLeft();
+    void errorReceived(const QString& message);
+private:
+    void onReadyRead();
+    void handleMessage(const NetworkMessage& message);
+    void requestSnapshot();
+private:
+    QTcpSocket* m_socket;
+
+    std::optional<uint32_t> m_gameId;
+    Position m_position;
+    int m_ply = 0;
+    std::array<qint64, COLOR_COUNT> m_timeUsed = {};
+
+    bool m_hasGameStarted = false;
+
+    // Moves that arrive before the requested snapshot are already part of it
+    bool m_isWaitingForSnapshot = false;
+
+    uint64_t m_receivedMessageCount = 0;
+};
+
+}
+
+#endif // NETWORKCLIENT_H
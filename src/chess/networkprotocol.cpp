@@ -0,0 +1,42 @@
+#include "networkprotocol.h"
+
+#include "binarydata.h"
+
+#include <QtEndian>
+
+using namespace Chess;
+
+QByteArray Chess::encodeMessage(MessageType type, const QByteArray &payload)
+{
+    QByteArray frame;
+    frame.reserve(3 + payload.size());
+
+    appendUInt16(frame, 1 + payload.size());
+    frame.append(static_cast<char>(type));
+    frame.append(payload);
+
+    return frame;
+}
+
+std::optional<NetworkMessage> Chess::readMessage(QIODevice &device)
+{
+    char sizeBytes[2];
+    if(device.peek(sizeBytes, sizeof(sizeBytes)) < static_cast<qint64>(sizeof(sizeBytes)))
+    {
+        return std::nullopt;
+    }
+
+    uint16_t size = qFromLittleEndian<quint16>(sizeBytes);
+    if(size == 0 || size > MAX_MESSAGE_SIZE)
+    {
+        return NetworkMessage{MessageType::Invalid, QByteArray()};
+    }
+
+    if(device.bytesAvailable() < sizeof(sizeBytes) + size)
+    {
+        return std::nullopt;
+    }
+
+    QByteArray frame = device.read(sizeof(sizeBytes) + size);
+    return NetworkMessage{static_cast<MessageType>(frame[2]), frame.mid(3)};
+}
@@ -0,0 +1,72 @@
+#ifndef NETWORKPROTOCOL_H
+#define NETWORKPROTOCOL_H
+
+#include "chess.h"
+
+#include <QByteArray>
+#include <QIODevice>
+
+namespace Chess
+{
+
+// Messages between GameServer and NetworkClient. Every message is a frame of
+//
+//   u16  size of the type and payload
+//   u8   type, see MessageType
+//   ...  payload
+//
+// encoded like game records, see binarydata.h. Moves are sent packed in 16 bits, positions only as
+// a snapshot when a client joins or asks for one, after that everyone in the game gets the stream of moves.
+enum class MessageType : uint8_t
+{
+    // Client to server
+    CreateGame = 1,         // u8 color the creator plays
+    JoinGame = 2,           // u32 game, joins a waiting game with the color that is left
+    WatchGame = 3,          // u32 game, joins a running game as a spectator
+    PlayMove = 4,           // u16 packed move
+    LeaveGame = 5,
+    RequestSnapshot = 6,    // sent when a checksum doesn't match the client's position
+
+    // Server to client
+    GameJoined = 64,        // u32 game, u8 role, see GameRole
+    Snapshot = 65,          // varint ply, varint ms used by white, varint ms used by black, string FEN
+    MovePlayed = 66,        // u16 packed move, varint ms the mover used for it, sent to everyone but the mover
+    Checksum = 67,          // varint ply, u64 Position::hash of the game's position at that ply
+    PlayerLeft = 68,        // a player left, the game is over
+    Error = 69,             // string message
+    MoveAccepted = 70,      // u8 color, varint ms the server measured for the client's own move
+
+    // Never sent, returned by readMessage for a frame that can't be read
+    Invalid = 0,
+};
+
+enum class GameRole : uint8_t
+{
+    White = 0,
+    Black = 1,
+    Spectator = 2,
+};
+
+struct NetworkMessage
+{
+    MessageType type = MessageType::Invalid;
+    QByteArray payload;
+};
+
+// No valid message comes close, a larger frame means the stream is broken
+static constexpr uint16_t MAX_MESSAGE_SIZE = 1024;
+
+// The server follows every this many plies with a Checksum, clients that got out of sync find out
+// and ask for a snapshot instead of playing on from a wrong position
+static constexpr int CHECKSUM_INTERVAL = 16;
+
+QByteArray encodeMessage(MessageType type, const QByteArray& payload = QByteArray());
+
+// Takes the next message off the device once all of it has arrived.
+// A frame that is empty or larger than MAX_MESSAGE_SIZE is returned as MessageType::Invalid
+// and left on the device, the connection should be dropped.
+std::optional<NetworkMessage> readMessage(QIODevice& device);
+
+}
+
+#endif // NETWORKPROTOCOL_H
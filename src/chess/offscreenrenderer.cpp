@@ -0,0 +1,171 @@
+#include "offscreenrenderer.h"
+#include "boardrenderer.h"
+#include "gifwriter.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QPainter>
+
+using namespace Chess;
+
+// QPixmapCache only works on the GUI thread, so every worker keeps the atlas of the last sprite size it used.
+// Batches usually render at a single size, so each thread scales the piece images once.
+static const QImage& threadPieceAtlas(QSize spriteSize)
+{
+    thread_local QSize atlasSpriteSize;
+    thread_local QImage atlas;
+
+    if(atlas.isNull() || atlasSpriteSize != spriteSize)
+    {
+        atlas = BoardRenderer::createPieceAtlas(spriteSize);
+        atlasSpriteSize = spriteSize;
+    }
+
+    return atlas;
+}
+
+QImage Chess::renderPositionImage(const Position &position, const RenderOptions &options, std::optional<Move> lastMove)
+{
+    const Board& board = position.board();
+
+    QImage image(options.size, QImage::Format_ARGB32_Premultiplied);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    BoardRenderer renderer(options.size, options.viewForPlayer, board.width(), board.height());
+    renderer.paintSquares(painter);
+
+    if(options.highlightLastMove && lastMove)
+    {
+        renderer.paintSquareOutline(painter, lastMove->from, options.lastMoveColor);
+        renderer.paintSquareOutline(painter, lastMove->to, options.lastMoveColor);
+    }
+
+    if(position.isKingInCheck())
+    {
+        auto kingPos = findPiece(board, Piece{position.currentPlayer(), PieceType::King});
+        if(kingPos)
+        {
+            renderer.paintSquareOutline(painter, *kingPos, Qt::red);
+        }
+    }
+
+    renderer.paintPieces(painter, board, threadPieceAtlas(renderer.spriteSize(1.0)));
+    painter.end();
+
+    return image;
+}
+
+QVector<QImage> Chess::renderGameImages(const MoveHistory &history, const RenderOptions &options)
+{
+    QVector<QImage> images;
+    images.reserve(history.moves().size() + 1);
+
+    Position position = history.basePosition();
+    images.append(renderPositionImage(position, options));
+
+    for (const Move& move : history.moves()) {
+        position.doMove(move);
+        images.append(renderPositionImage(position, options, move));
+    }
+
+    return images;
+}
+
+static bool writeAnimatedGif(const QVector<QImage>& images, const QString& path, const RenderOptions& options)
+{
+    GifWriter writer;
+    if(!writer.open(path, options.size))
+    {
+        return false;
+    }
+
+    for (const QImage& image : images) {
+        if(!writer.addFrame(image, options.frameDelay))
+        {
+            writer.close();
+            return false;
+        }
+    }
+
+    return writer.close();
+}
+
+static bool writeNumberedImages(const QVector<QImage>& images, const QString& path)
+{
+    QFileInfo fileInfo(path);
+    QDir directory = fileInfo.dir();
+
+    for (int i = 0; i < images.size(); ++i) {
+        QString fileName = QString("%1_%2.%3")
+                               .arg(fileInfo.completeBaseName())
+                               .arg(i, 3, 10, QChar('0'))
+                               .arg(fileInfo.suffix());
+
+        if(!images[i].save(directory.filePath(fileName)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+OffscreenRenderer::OffscreenRenderer(int maxThreadCount)
+{
+    m_threadPool.setMaxThreadCount(maxThreadCount);
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    waitForDone();
+}
+
+void OffscreenRenderer::renderPosition(const Position &position, const QString &path, const RenderOptions &options)
+{
+    startJob([position, path, options]() {
+        return renderPositionImage(position, options).save(path);
+    });
+}
+
+void OffscreenRenderer::renderGame(const MoveHistory &history, const QString &path, const RenderOptions &options)
+{
+    startJob([history, path, options]() {
+        QVector<QImage> images = renderGameImages(history, options);
+
+        if(QFileInfo(path).suffix().compare("gif", Qt::CaseInsensitive) == 0)
+        {
+            return writeAnimatedGif(images, path, options);
+        }
+
+        return writeNumberedImages(images, path);
+    });
+}
+
+void OffscreenRenderer::waitForDone()
+{
+    m_threadPool.waitForDone();
+}
+
+int OffscreenRenderer::finishedCount() const
+{
+    return m_finishedCount;
+}
+
+int OffscreenRenderer::failedCount() const
+{
+    return m_failedCount;
+}
+
+void OffscreenRenderer::startJob(std::function<bool()> job)
+{
+    m_threadPool.start([this, job = std::move(job)]() {
+        if(!job())
+        {
+            m_failedCount++;
+        }
+
+        m_finishedCount++;
+    });
+}
@@ -0,0 +1,72 @@
+#ifndef OFFSCREENRENDERER_H
+#define OFFSCREENRENDERER_H
+
+#include "chess.h"
+
+#include <QImage>
+#include <QThread>
+#include <QThreadPool>
+
+#include <atomic>
+#include <functional>
+
+namespace Chess
+{
+
+struct RenderOptions
+{
+    // In pixels
+    QSize size = QSize(360, 360);
+
+    Color viewForPlayer = Color::White;
+
+    // Outlines the squares of the move that led to the position
+    bool highlightLastMove = true;
+    QColor lastMoveColor = QColor(220, 200, 60);
+
+    // Time each position of an animated game is shown, in milliseconds
+    int frameDelay = 800;
+};
+
+// Paints the position like BoardView does into an image, without any widget.
+// Safe to call from any thread.
+QImage renderPositionImage(const Position& position, const RenderOptions& options, std::optional<Move> lastMove = std::nullopt);
+
+// One image for each position of the game, starting with its base position
+QVector<QImage> renderGameImages(const MoveHistory& history, const RenderOptions& options);
+
+// Renders positions and games to image files on a thread pool.
+// Everything is painted into QImages, so it runs without a display, e.g. with QT_QPA_PLATFORM=offscreen.
+// The positions and games are copied, they may be changed right after queueing them.
+class OffscreenRenderer
+{
+public:
+    explicit OffscreenRenderer(int maxThreadCount = QThread::idealThreadCount());
+
+    // Waits for every queued job
+    ~OffscreenRenderer();
+
+    // Writes an image in the format of the file suffix, e.g. PNG for "position.png"
+    void renderPosition(const Position& position, const QString& path, const RenderOptions& options = RenderOptions());
+
+    // A ".gif" path gets an animated GIF of the whole game. For any other suffix one image
+    // is written per position, numbered like "game_000.png", "game_001.png" and so on.
+    void renderGame(const MoveHistory& history, const QString& path, const RenderOptions& options = RenderOptions());
+
+    void waitForDone();
+
+    // Jobs finished since construction, including the failed ones
+    int finishedCount() const;
+    int failedCount() const;
+private:
+    void startJob(std::function<bool()> job);
+private:
+    QThreadPool m_threadPool;
+
+    std::atomic<int> m_finishedCount{0};
+    std::atomic<int> m_failedCount{0};
+};
+
+}
+
+#endif // OFFSCREENRENDERER_H
@@ -0,0 +1,248 @@
+#include "openingbook.h"
+
+#include <QtEndian>
+
+using namespace Chess;
+
+OpeningBook::~OpeningBook()
+{
+    close();
+}
+
+bool OpeningBook::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    if(size <= 0 || size % ENTRY_SIZE != 0)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, size);
+    if(!m_data)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_entryCount = size / ENTRY_SIZE;
+
+    return true;
+}
+
+void OpeningBook::close()
+{
+    if(m_data)
+    {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+
+    m_entryCount = 0;
+    m_file.close();
+}
+
+bool OpeningBook::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+size_t OpeningBook::entryCount() const
+{
+    return m_entryCount;
+}
+
+BookEntry OpeningBook::entryAt(size_t index) const
+{
+    const uchar* data = m_data + index * ENTRY_SIZE;
+
+    return BookEntry{
+        .key = qFromBigEndian<quint64>(data),
+        .move = qFromBigEndian<quint16>(data + 8),
+        .weight = qFromBigEndian<quint16>(data + 10),
+        .learn = qFromBigEndian<quint32>(data + 12),
+    };
+}
+
+QVector<BookEntry> OpeningBook::findEntries(uint64_t key) const
+{
+    QVector<BookEntry> entries;
+
+    // lower bound of the key, entries of the same position are stored next to each other
+    size_t low = 0;
+    size_t high = m_entryCount;
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        uint64_t middleKey = qFromBigEndian<quint64>(m_data + middle * ENTRY_SIZE);
+
+        if(middleKey < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    for (size_t i = low; i < m_entryCount; ++i) {
+        BookEntry entry = entryAt(i);
+        if(entry.key != key)
+        {
+            break;
+        }
+
+        entries.append(entry);
+    }
+
+    return entries;
+}
+
+std::optional<Move> OpeningBook::pickMove(const Position &position, std::mt19937 &random) const
+{
+    if(!isOpen())
+    {
+        return std::nullopt;
+    }
+
+    QVector<std::pair<Move, uint32_t>> candidates;
+    uint32_t totalWeight = 0;
+
+    for (const BookEntry& entry : findEntries(position.hash())) {
+        std::optional<Move> move = decodeMove(position, entry.move);
+        if(move && entry.weight > 0)
+        {
+            candidates.append({*move, entry.weight});
+            totalWeight += entry.weight;
+        }
+    }
+
+    if(candidates.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::uniform_int_distribution<uint32_t> distribution(0, totalWeight - 1);
+    uint32_t pick = distribution(random);
+
+    for (const auto& [move, weight] : candidates) {
+        if(pick < weight)
+        {
+            return move;
+        }
+
+        pick -= weight;
+    }
+
+    return candidates.last().first;
+}
+
+// Polyglot numbers squares from a1 to h8, our board starts at the 8th rank
+static QPoint squareFromBook(int square)
+{
+    return QPoint(square % 8, (Board::HEIGHT - 1) - square / 8);
+}
+
+static int squareToBook(QPoint pos)
+{
+    return ((Board::HEIGHT - 1) - pos.y()) * 8 + pos.x();
+}
+
+static uint8_t promotionFromBook(int promotion)
+{
+    switch(promotion)
+    {
+    case 1: return PromotionKnight;
+    case 2: return PromotionBishop;
+    case 3: return PromotionRook;
+    case 4: return PromotionQueen;
+    default: return 0;
+    }
+}
+
+std::optional<Move> OpeningBook::decodeMove(const Position &position, uint16_t bookMove)
+{
+    QPoint from = squareFromBook((bookMove >> 6) & 0x3F);
+    QPoint to = squareFromBook(bookMove & 0x3F);
+    uint8_t promotion = promotionFromBook((bookMove >> 12) & 0x7);
+
+    // Castling is stored as the king capturing its own rook
+    std::optional<Piece> piece = position.board().pieceAt(from);
+    if(piece && piece->type == PieceType::King && from.x() == 4 && from.y() == to.y())
+    {
+        if(to.x() == 7)
+        {
+            to.setX(6);
+        }
+        else if(to.x() == 0)
+        {
+            to.setX(2);
+        }
+    }
+
+    for (const Move& move : position.getLegalMoves(from)) {
+        if(move.to == to && (move.flags & PromotionAny) == promotion)
+        {
+            return move;
+        }
+    }
+
+    return std::nullopt;
+}
+
+uint16_t OpeningBook::encodeMove(const Move &move)
+{
+    QPoint to = move.to;
+
+    if(move.flags & CastleKingSide)
+    {
+        to.setX(7);
+    }
+    else if(move.flags & CastleQueenSide)
+    {
+        to.setX(0);
+    }
+
+    int promotion = 0;
+    if(move.flags & PromotionKnight) promotion = 1;
+    if(move.flags & PromotionBishop) promotion = 2;
+    if(move.flags & PromotionRook) promotion = 3;
+    if(move.flags & PromotionQueen) promotion = 4;
+
+    return (promotion << 12) | (squareToBook(move.from) << 6) | squareToBook(to);
+}
+
+bool OpeningBook::write(const QString &path, QVector<BookEntry> entries)
+{
+    std::stable_sort(std::begin(entries), std::end(entries), [](const BookEntry& a, const BookEntry& b) {
+        return a.key < b.key;
+    });
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    QByteArray data(entries.count() * ENTRY_SIZE, Qt::Uninitialized);
+    uchar* out = reinterpret_cast<uchar*>(data.data());
+
+    for (const BookEntry& entry : entries) {
+        qToBigEndian<quint64>(entry.key, out);
+        qToBigEndian<quint16>(entry.move, out + 8);
+        qToBigEndian<quint16>(entry.weight, out + 10);
+        qToBigEndian<quint32>(entry.learn, out + 12);
+        out += ENTRY_SIZE;
+    }
+
+    return file.write(data) == data.size();
+}
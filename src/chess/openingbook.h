@@ -0,0 +1,65 @@
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include "chess.h"
+
+#include <QFile>
+
+#include <cstdint>
+#include <random>
+
+namespace Chess
+{
+
+// A single entry of a Polyglot book, stored as 16 big endian bytes sorted by key
+struct BookEntry
+{
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+    uint32_t learn;
+};
+
+// Reads opening books in the Polyglot .bin format.
+// The file is memory mapped and binary searched in place, opening a book doesn't read or copy it.
+// Entries are keyed by Position::hash().
+class OpeningBook
+{
+public:
+    static constexpr size_t ENTRY_SIZE = 16;
+
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    bool open(const QString& path);
+    void close();
+
+    bool isOpen() const;
+    size_t entryCount() const;
+
+    QVector<BookEntry> findEntries(uint64_t key) const;
+
+    // Picks one of the book moves of the position at random, weighted by the entries' weights.
+    // Returns nothing if the position is not in the book or none of its moves are legal.
+    std::optional<Move> pickMove(const Position& position, std::mt19937& random) const;
+
+    // Converts between the packed Polyglot move format and legal moves of the position
+    static std::optional<Move> decodeMove(const Position& position, uint16_t bookMove);
+    static uint16_t encodeMove(const Move& move);
+
+    // Writes the entries sorted by key, e.g. to build a book from our own games
+    static bool write(const QString& path, QVector<BookEntry> entries);
+private:
+    BookEntry entryAt(size_t index) const;
+private:
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    size_t m_entryCount = 0;
+};
+
+}
+
+#endif // OPENINGBOOK_H
@@ -0,0 +1,74 @@
+#include "pawnhash.h"
+#include "evaluation.h"
+
+#include <cassert>
+
+using namespace Chess;
+
+double PawnHashStats::hitRate() const
+{
+    return probes > 0 ? static_cast<double>(hits) / probes : 0.0;
+}
+
+PawnHashTable::PawnHashTable(size_t entryCount)
+{
+    resize(entryCount);
+}
+
+PawnHashTable &PawnHashTable::forCurrentThread()
+{
+    thread_local PawnHashTable s_table;
+    return s_table;
+}
+
+const PawnStructure &PawnHashTable::probe(uint64_t pawnKey, const Board &board)
+{
+    m_stats.probes++;
+
+    Entry& entry = m_entries[pawnKey & m_indexMask];
+    if(entry.isValid && entry.key == pawnKey)
+    {
+        m_stats.hits++;
+        return entry.pawnStructure;
+    }
+
+    entry.key = pawnKey;
+    entry.isValid = true;
+    entry.pawnStructure = analyzePawnStructure(board);
+
+    return entry.pawnStructure;
+}
+
+void PawnHashTable::resize(size_t entryCount)
+{
+    assert(entryCount > 0);
+
+    size_t powerOfTwo = 1;
+    while(powerOfTwo * 2 <= entryCount)
+    {
+        powerOfTwo *= 2;
+    }
+
+    m_entries.assign(powerOfTwo, Entry{});
+    m_indexMask = powerOfTwo - 1;
+}
+
+void PawnHashTable::clear()
+{
+    std::fill(m_entries.begin(), m_entries.end(), Entry{});
+}
+
+size_t PawnHashTable::entryCount() const
+{
+    return m_entries.size();
+}
+
+const PawnHashStats &PawnHashTable::stats() const
+{
+    return m_stats;
+}
+
+void PawnHashTable::resetStats()
+{
+    m_stats = PawnHashStats{};
+}
@@ -0,0 +1,68 @@
+#ifndef PAWNHASH_H
+#define PAWNHASH_H
+
+#include "chess.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Chess
+{
+
+// Result of the pawn structure evaluation, which only depends on the pawns on the board
+struct PawnStructure
+{
+    // From white's point of view
+    Score score;
+
+    // One bit per square (y * 8 + x) for each color's passed pawns
+    std::array<uint64_t, COLOR_COUNT> passedPawns = {0, 0};
+};
+
+struct PawnHashStats
+{
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    double hitRate() const;
+};
+
+// Caches pawn structure evaluations by Position::pawnKey().
+// Tables are not synchronized, every thread evaluating positions uses its own.
+class PawnHashTable
+{
+public:
+    static constexpr size_t DEFAULT_ENTRY_COUNT = 1 << 14;
+
+    explicit PawnHashTable(size_t entryCount = DEFAULT_ENTRY_COUNT);
+
+    // The table of the calling thread, used by Chess::evaluate
+    static PawnHashTable& forCurrentThread();
+
+    const PawnStructure& probe(uint64_t pawnKey, const Board& board);
+
+    // Rounds the entry count down to a power of two and clears the table
+    void resize(size_t entryCount);
+    void clear();
+
+    size_t entryCount() const;
+
+    const PawnHashStats& stats() const;
+    void resetStats();
+private:
+    struct Entry
+    {
+        uint64_t key = 0;
+        bool isValid = false;
+        PawnStructure pawnStructure;
+    };
+
+    std::vector<Entry> m_entries;
+    uint64_t m_indexMask = 0;
+
+    PawnHashStats m_stats;
+};
+
+}
+
+#endif // PAWNHASH_H
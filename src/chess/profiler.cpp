@@ -0,0 +1,169 @@
+#include "profiler.h"
+
+#include <QStringList>
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+using namespace Chess;
+
+namespace
+{
+
+struct ProfileRegistry
+{
+    std::mutex mutex;
+
+    QVector<QString> probeNames;
+
+    QVector<ProfileBuffer*> liveBuffers;
+
+    // Of the threads that ended
+    std::array<ProfileCounter, ProfileBuffer::MAX_PROBES> retiredCounters{};
+};
+
+ProfileRegistry& registry()
+{
+    static ProfileRegistry registry;
+    return registry;
+}
+
+void addCounters(std::array<ProfileCounter, ProfileBuffer::MAX_PROBES>& totals, const std::array<ProfileCounter, ProfileBuffer::MAX_PROBES>& counters)
+{
+    for (size_t i = 0; i < totals.size(); ++i) {
+        totals[i].calls += counters[i].calls;
+        totals[i].cycles += counters[i].cycles;
+        totals[i].childCycles += counters[i].childCycles;
+    }
+}
+
+#ifdef CHESS_PROFILE
+// The buffer of the main thread is destroyed before any static object, so its counters are in by then
+struct ProfileReporter
+{
+    ProfileReporter()
+    {
+        // Constructed first, the registry is destroyed after the report was printed
+        registry();
+    }
+
+    ~ProfileReporter()
+    {
+        std::fputs(qPrintable(Profiler::report()), stderr);
+    }
+};
+
+ProfileReporter reporter;
+#endif
+
+}
+
+ProfileBuffer::ProfileBuffer()
+{
+    ProfileRegistry& profileRegistry = registry();
+
+    std::lock_guard<std::mutex> lock(profileRegistry.mutex);
+    profileRegistry.liveBuffers.append(this);
+}
+
+ProfileBuffer::~ProfileBuffer()
+{
+    ProfileRegistry& profileRegistry = registry();
+
+    std::lock_guard<std::mutex> lock(profileRegistry.mutex);
+    addCounters(profileRegistry.retiredCounters, counters);
+    profileRegistry.liveBuffers.removeOne(this);
+}
+
+int Profiler::registerProbe(const char *name)
+{
+    ProfileRegistry& profileRegistry = registry();
+
+    std::lock_guard<std::mutex> lock(profileRegistry.mutex);
+    if(profileRegistry.probeNames.count() >= ProfileBuffer::MAX_PROBES)
+    {
+        qFatal("More than %d profiled scopes, raise ProfileBuffer::MAX_PROBES", ProfileBuffer::MAX_PROBES);
+    }
+
+    profileRegistry.probeNames.append(QString::fromUtf8(name));
+    return profileRegistry.probeNames.count() - 1;
+}
+
+QVector<ProfileEntry> Profiler::entries()
+{
+    ProfileRegistry& profileRegistry = registry();
+
+    std::lock_guard<std::mutex> lock(profileRegistry.mutex);
+
+    std::array<ProfileCounter, ProfileBuffer::MAX_PROBES> totals = profileRegistry.retiredCounters;
+    for (const ProfileBuffer* buffer : profileRegistry.liveBuffers) {
+        addCounters(totals, buffer->counters);
+    }
+
+    QVector<ProfileEntry> entries;
+    for (int i = 0; i < profileRegistry.probeNames.count(); ++i) {
+        ProfileEntry entry;
+        entry.name = profileRegistry.probeNames[i];
+        entry.calls = totals[i].calls;
+        entry.cycles = totals[i].cycles;
+        entry.selfCycles = totals[i].cycles - std::min(totals[i].cycles, totals[i].childCycles);
+        entries.append(entry);
+    }
+
+    std::stable_sort(std::begin(entries), std::end(entries), [](const ProfileEntry& a, const ProfileEntry& b) {
+        return a.selfCycles > b.selfCycles;
+    });
+
+    return entries;
+}
+
+QString Profiler::report()
+{
+    QVector<ProfileEntry> profileEntries = entries();
+
+    uint64_t totalSelfCycles = 0;
+    for (const ProfileEntry& entry : profileEntries) {
+        totalSelfCycles += entry.selfCycles;
+    }
+
+    QStringList lines;
+    lines.append(QString("%1 %2 %3 %4 %5 %6")
+                     .arg("scope", -40)
+                     .arg("calls", 12)
+                     .arg("Mcycles", 12)
+                     .arg("self Mcycles", 13)
+                     .arg("self %", 7)
+                     .arg("cycles/call", 12));
+
+    for (const ProfileEntry& entry : profileEntries) {
+        if(entry.calls == 0)
+        {
+            continue;
+        }
+
+        double selfShare = totalSelfCycles > 0 ? 100.0 * entry.selfCycles / totalSelfCycles : 0.0;
+
+        lines.append(QString("%1 %2 %3 %4 %5 %6")
+                         .arg(entry.name, -40)
+                         .arg(entry.calls, 12)
+                         .arg(entry.cycles / 1e6, 12, 'f', 1)
+                         .arg(entry.selfCycles / 1e6, 13, 'f', 1)
+                         .arg(selfShare, 7, 'f', 1)
+                         .arg(static_cast<double>(entry.cycles) / entry.calls, 12, 'f', 0));
+    }
+
+    return lines.join('\n') + '\n';
+}
+
+void Profiler::reset()
+{
+    ProfileRegistry& profileRegistry = registry();
+
+    std::lock_guard<std::mutex> lock(profileRegistry.mutex);
+
+    profileRegistry.retiredCounters = {};
+    for (ProfileBuffer* buffer : profileRegistry.liveBuffers) {
+        buffer->counters = {};
+    }
+}
@@ -0,0 +1,149 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <QVector>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// CHESS_PROFILE_SCOPE("name") times the rest of the enclosing scope when the build defines CHESS_PROFILE,
+// see the CMake option of the same name, and the flat profile of all scopes is printed to stderr at exit.
+// Without CHESS_PROFILE it is an empty statement, release builds time and count nothing.
+#define CHESS_PROFILE_CONCAT_(a, b) a##b
+#define CHESS_PROFILE_CONCAT(a, b) CHESS_PROFILE_CONCAT_(a, b)
+
+#ifdef CHESS_PROFILE
+#define CHESS_PROFILE_SCOPE(name) \
+    static const int CHESS_PROFILE_CONCAT(chessProfileProbe, __LINE__) = ::Chess::Profiler::registerProbe(name); \
+    ::Chess::ScopedTimer CHESS_PROFILE_CONCAT(chessProfileTimer, __LINE__)(CHESS_PROFILE_CONCAT(chessProfileProbe, __LINE__))
+#else
+#define CHESS_PROFILE_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace Chess
+{
+
+// Cycles of the time stamp counter on x86, steady clock ticks elsewhere
+inline uint64_t readCycleCounter()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+struct ProfileCounter
+{
+    uint64_t calls = 0;
+
+    // Of the whole scope and of the scopes timed within it
+    uint64_t cycles = 0;
+    uint64_t childCycles = 0;
+};
+
+class ScopedTimer;
+
+// The counters of one thread. Only that thread writes them, so counting is a plain add, the buffers of
+// all threads are summed up when the profile is read. A thread that ends adds its counters to the totals.
+class ProfileBuffer
+{
+public:
+    static constexpr int MAX_PROBES = 64;
+
+    ProfileBuffer();
+    ~ProfileBuffer();
+
+    ProfileBuffer(const ProfileBuffer&) = delete;
+    ProfileBuffer& operator=(const ProfileBuffer&) = delete;
+
+    std::array<ProfileCounter, MAX_PROBES> counters;
+
+    // The innermost running timer, its scope is charged with the time of the nested ones
+    ScopedTimer* current = nullptr;
+};
+
+inline ProfileBuffer& threadProfileBuffer()
+{
+    thread_local ProfileBuffer buffer;
+    return buffer;
+}
+
+struct ProfileEntry
+{
+    QString name;
+
+    uint64_t calls = 0;
+
+    // A scope entered again from within itself counts its inner time twice here, but once in the self cycles
+    uint64_t cycles = 0;
+
+    // Without the scopes timed within it
+    uint64_t selfCycles = 0;
+};
+
+class Profiler
+{
+public:
+    // Returns the id of the probe, one per CHESS_PROFILE_SCOPE
+    static int registerProbe(const char* name);
+
+    // The counters of all threads summed up, by most self cycles first. Threads that are still running
+    // should be idle, their counters are read without synchronization.
+    static QVector<ProfileEntry> entries();
+
+    // A table of the entries
+    static QString report();
+
+    // Starts over, for tests. No thread may be in a timed scope.
+    static void reset();
+};
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(int probe)
+        : m_buffer(threadProfileBuffer()),
+        m_probe(probe),
+        m_parent(m_buffer.current)
+    {
+        m_buffer.current = this;
+        m_start = readCycleCounter();
+    }
+
+    ~ScopedTimer()
+    {
+        uint64_t elapsed = readCycleCounter() - m_start;
+
+        ProfileCounter& counter = m_buffer.counters[m_probe];
+        counter.calls++;
+        counter.cycles += elapsed;
+
+        if(m_parent)
+        {
+            m_buffer.counters[m_parent->m_probe].childCycles += elapsed;
+        }
+
+        m_buffer.current = m_parent;
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+private:
+    ProfileBuffer& m_buffer;
+    int m_probe;
+    ScopedTimer* m_parent;
+    uint64_t m_start = 0;
+};
+
+}
+
+#endif // PROFILER_H
@@ -0,0 +1,713 @@
+#include "search.h"
+#include "binarydata.h"
+#include "evaluation.h"
+#include "see.h"
+#include "tablebase.h"
+#include "transpositiontable.h"
+
+#include <QStringList>
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace Chess;
+
+// Nodes between checks of the limits
+static constexpr uint64_t ABORT_CHECK_INTERVAL = 1024;
+
+// Mate and tablebase scores count the plies from the root, in the table they count from the stored position
+static constexpr int PLY_DEPENDENT_SCORE = TABLEBASE_WIN_SCORE - MAX_PLY;
+
+// Null moves are searched this much shallower than real ones, and only where that leaves some depth
+static constexpr int NULL_MOVE_REDUCTION = 2;
+static constexpr int NULL_MOVE_MIN_DEPTH = 3;
+
+// The first moves are searched at full depth, they are the most likely to be best
+static constexpr int LATE_MOVE_INDEX = 3;
+static constexpr int VERY_LATE_MOVE_INDEX = 8;
+static constexpr int LATE_MOVE_MIN_DEPTH = 3;
+
+// How far below alpha the static evaluation of a node of the given depth has to be to skip its quiet moves,
+// about what a quiet move could gain within that depth
+static constexpr std::array<int, 3> FUTILITY_MARGINS = {0, 150, 400};
+
+static constexpr int ASPIRATION_WINDOW = 50;
+static constexpr int ASPIRATION_MIN_DEPTH = 4;
+
+// Keeps the history of quiet moves below the scores of good captures in the move ordering
+static constexpr int MAX_HISTORY_SCORE = 40000;
+
+static int scoreToTable(int score, int ply)
+{
+    return score >= PLY_DEPENDENT_SCORE ? score + ply : score <= -PLY_DEPENDENT_SCORE ? score - ply : score;
+}
+
+static int scoreFromTable(int score, int ply)
+{
+    return score >= PLY_DEPENDENT_SCORE ? score - ply : score <= -PLY_DEPENDENT_SCORE ? score + ply : score;
+}
+
+// Without pieces, having to move is likely to be a disadvantage and passing the turn tells nothing
+static bool hasNonPawnMaterial(const Position& position, Color color)
+{
+    const Board& board = position.board();
+    for (size_t y = 0; y < Board::HEIGHT; ++y) {
+        for (size_t x = 0; x < Board::WIDTH; ++x) {
+            std::optional<Piece> piece = board.pieceAt(QPoint(x, y));
+            if(piece && piece->color == color && piece->type != PieceType::Pawn && piece->type != PieceType::King)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static bool isQuietMove(const Move& move)
+{
+    return !move.isCapture() && !(move.flags & PromotionAny);
+}
+
+// Index of the move in a history table of its color
+static int historyIndex(const Move& move)
+{
+    int from = move.from.y() * Board::WIDTH + move.from.x();
+    int to = move.to.y() * Board::WIDTH + move.to.x();
+    return from * Board::WIDTH * Board::HEIGHT + to;
+}
+
+SearchFeatures SearchFeatures::none()
+{
+    SearchFeatures features;
+    features.nullMovePruning = false;
+    features.lateMoveReductions = false;
+    features.futilityPruning = false;
+    features.aspirationWindows = false;
+    return features;
+}
+
+QVector<double> SearchStatistics::effectiveBranchingFactors() const
+{
+    QVector<double> factors;
+    for (int i = 1; i < iterationNodes.count(); ++i) {
+        factors.append(iterationNodes[i - 1] > 0 ? static_cast<double>(iterationNodes[i]) / iterationNodes[i - 1] : 0.0);
+    }
+
+    return factors;
+}
+
+static double share(uint64_t part, uint64_t total)
+{
+    return total > 0 ? static_cast<double>(part) / total : 0.0;
+}
+
+double SearchStatistics::tableHitRate() const
+{
+    return share(tableHits, tableProbes);
+}
+
+double SearchStatistics::firstMoveCutoffRate() const
+{
+    return share(firstMoveBetaCutoffs, betaCutoffs);
+}
+
+double SearchStatistics::quiescenceRate() const
+{
+    return share(quiescenceNodes, nodes);
+}
+
+QString SearchStatistics::toString() const
+{
+    QStringList factors;
+    for (double factor : effectiveBranchingFactors()) {
+        factors.append(QString::number(factor, 'f', 2));
+    }
+
+    auto line = [](const QString& name, const QString& value) {
+        return QString("%1 %2").arg(name, -21).arg(value);
+    };
+
+    auto counter = [](uint64_t count, double rate) {
+        return QString("%1 (%2%)").arg(count).arg(rate * 100, 0, 'f', 1);
+    };
+
+    QStringList lines = {
+        line("nodes", QString::number(nodes)),
+        line("quiescence nodes", counter(quiescenceNodes, quiescenceRate())),
+        line("table probes", QString::number(tableProbes)),
+        line("table hits", counter(tableHits, tableHitRate())),
+        line("table cutoffs", QString::number(tableCutoffs)),
+        line("beta cutoffs", QString::number(betaCutoffs)),
+        line("first move cutoffs", counter(firstMoveBetaCutoffs, firstMoveCutoffRate())),
+        line("null move prunes", QString::number(nullMovePrunes)),
+        line("late move reductions", QString::number(lateMoveReductions)),
+        line("branching factors", factors.join(' ')),
+    };
+
+    return lines.join('\n');
+}
+
+SearchStatistics &SearchStatistics::operator+=(const SearchStatistics &other)
+{
+    nodes += other.nodes;
+    quiescenceNodes += other.quiescenceNodes;
+    tableProbes += other.tableProbes;
+    tableHits += other.tableHits;
+    tableCutoffs += other.tableCutoffs;
+    betaCutoffs += other.betaCutoffs;
+    firstMoveBetaCutoffs += other.firstMoveBetaCutoffs;
+    nullMovePrunes += other.nullMovePrunes;
+    lateMoveReductions += other.lateMoveReductions;
+
+    // A search that ended early on a mate has fewer iterations, it adds nothing to the deeper ones
+    if(iterationNodes.count() < other.iterationNodes.count())
+    {
+        iterationNodes.resize(other.iterationNodes.count());
+    }
+
+    for (int i = 0; i < other.iterationNodes.count(); ++i) {
+        iterationNodes[i] += other.iterationNodes[i];
+    }
+
+    return *this;
+}
+
+Search::Search(TranspositionTable *transpositionTable)
+    : m_transpositionTable(transpositionTable)
+{
+}
+
+SearchResult Search::search(const Position& position, const SearchLimits& limits)
+{
+    m_statistics = SearchStatistics();
+    m_tablebaseHits = 0;
+    m_rootBestMove.reset();
+
+    for (auto& colorHistory : m_history) {
+        colorHistory.fill(0);
+    }
+
+    if(m_transpositionTable)
+    {
+        m_transpositionTable->newSearch();
+    }
+
+    m_limits = limits;
+    m_startTime = std::chrono::steady_clock::now();
+    m_isAborted = false;
+
+    SearchResult result;
+
+    const Tablebases& tablebases = Tablebases::instance();
+    if(tablebases.canProbe(position))
+    {
+        std::optional<TablebaseProbe> probe = tablebases.probe(position);
+        std::optional<Move> move = tablebases.bestMove(position);
+        if(probe && move)
+        {
+            result.bestMove = move;
+            result.principalVariation = {*move};
+            result.score = probe->wdl == Wdl::Win ? TABLEBASE_WIN_SCORE : probe->wdl == Wdl::Loss ? -TABLEBASE_WIN_SCORE : 0;
+            result.tablebaseHits = 1;
+            return result;
+        }
+    }
+
+    Position root = position;
+
+    for (int depth = 1; depth <= limits.depth; ++depth) {
+        uint64_t nodesBefore = m_statistics.nodes;
+
+        int score = searchRoot(root, depth, result.score);
+        if(m_isAborted)
+        {
+            result.isAborted = true;
+            break;
+        }
+
+        m_statistics.iterationNodes.append(m_statistics.nodes - nodesBefore);
+
+        result.bestMove = m_rootBestMove;
+        result.principalVariation = principalVariation(root);
+        result.score = score;
+        result.depth = depth;
+
+        if(limits.onIteration)
+        {
+            result.nodes = m_statistics.nodes;
+            result.tablebaseHits = m_tablebaseHits;
+            result.statistics = m_statistics;
+            limits.onIteration(result);
+        }
+
+        // a mate is as good as it gets, searching deeper only finds it again
+        if(std::abs(score) >= MATE_SCORE - MAX_PLY)
+        {
+            break;
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+        if(limits.softTimeMs && elapsed >= std::chrono::milliseconds(*limits.softTimeMs))
+        {
+            break;
+        }
+    }
+
+    // aborted in the first iteration, any legal move is better than none
+    if(!result.bestMove)
+    {
+        QVector<Move> moves = position.getLegalMoves();
+        result.bestMove = m_rootBestMove ? m_rootBestMove : moves.isEmpty() ? std::nullopt : std::optional<Move>(moves.first());
+    }
+
+    result.nodes = m_statistics.nodes;
+    result.tablebaseHits = m_tablebaseHits;
+    result.statistics = m_statistics;
+
+    return result;
+}
+
+int Search::searchRoot(Position &root, int depth, int previousScore)
+{
+    bool isNearMate = std::abs(previousScore) >= PLY_DEPENDENT_SCORE;
+    if(!m_limits.features.aspirationWindows || depth < ASPIRATION_MIN_DEPTH || isNearMate)
+    {
+        return alphaBeta(root, depth, 0, -MATE_SCORE, MATE_SCORE);
+    }
+
+    int window = ASPIRATION_WINDOW;
+    int alpha = previousScore - window;
+    int beta = previousScore + window;
+
+    // The window grows on every miss, at worst it ends up covering every score
+    while(true)
+    {
+        int score = alphaBeta(root, depth, 0, alpha, beta);
+        if(m_isAborted)
+        {
+            return 0;
+        }
+
+        window *= 2;
+
+        if(score <= alpha)
+        {
+            alpha = std::max(-MATE_SCORE, score - window);
+        }
+        else if(score >= beta)
+        {
+            beta = std::min(MATE_SCORE, score + window);
+        }
+        else
+        {
+            return score;
+        }
+    }
+}
+
+QVector<Move> Search::principalVariation(const Position &root) const
+{
+    QVector<Move> line = m_principalVariations[0];
+    if(line.isEmpty() && m_rootBestMove)
+    {
+        line = {*m_rootBestMove};
+    }
+
+    if(!m_transpositionTable)
+    {
+        return line;
+    }
+
+    Position position = root;
+    for (const Move& move : line) {
+        position.doMove(move);
+    }
+
+    // Where a position of the line was taken from the table, the rest of the line is in there as well.
+    // Its entries may go deeper than the iteration, a line running in circles stops at the maximum ply.
+    while(line.size() < MAX_PLY)
+    {
+        std::optional<TranspositionEntry> entry = m_transpositionTable->probe(position.hash());
+        if(!entry || entry->bound != ScoreBound::Exact || entry->move == 0)
+        {
+            break;
+        }
+
+        QVector<Move> moves = position.getLegalMoves();
+        auto moveIter = std::find_if(std::begin(moves), std::end(moves), [&](const Move& move) {
+            return packMove(move) == entry->move;
+        });
+
+        if(moveIter == std::end(moves))
+        {
+            break;
+        }
+
+        line.append(*moveIter);
+        position.doMove(*moveIter);
+    }
+
+    return line;
+}
+
+bool Search::shouldAbort()
+{
+    if(m_isAborted)
+    {
+        return true;
+    }
+
+    if(m_limits.maxNodes && m_statistics.nodes >= *m_limits.maxNodes)
+    {
+        m_isAborted = true;
+    }
+    else if(m_statistics.nodes % ABORT_CHECK_INTERVAL != 0)
+    {
+        return false;
+    }
+    else if(m_limits.stop && m_limits.stop->load(std::memory_order_relaxed))
+    {
+        m_isAborted = true;
+    }
+    else if(m_limits.hardTimeMs)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+        m_isAborted = elapsed >= std::chrono::milliseconds(*m_limits.hardTimeMs);
+    }
+
+    return m_isAborted;
+}
+
+int Search::alphaBeta(Position& position, int depth, int ply, int alpha, int beta, bool isNullMoveAllowed)
+{
+    if(depth <= 0 || ply >= MAX_PLY)
+    {
+        return quiescence(position, ply, alpha, beta);
+    }
+
+    m_statistics.nodes++;
+
+    QVector<Move>& principalVariation = m_principalVariations[ply];
+    principalVariation.clear();
+
+    // the score doesn't matter, the aborted iteration is thrown away
+    if(shouldAbort())
+    {
+        return 0;
+    }
+
+    // The root never gets here with a probeable position, search() already played the tablebase move
+    const Tablebases& tablebases = Tablebases::instance();
+    if(ply > 0 && tablebases.canProbe(position))
+    {
+        if(std::optional<Wdl> wdl = tablebases.probeWdl(position))
+        {
+            m_tablebaseHits++;
+
+            switch(*wdl)
+            {
+            case Wdl::Win: return TABLEBASE_WIN_SCORE - ply;
+            case Wdl::Draw: return 0;
+            case Wdl::Loss: return -TABLEBASE_WIN_SCORE + ply;
+            }
+        }
+    }
+
+    std::optional<TranspositionEntry> entry;
+    if(m_transpositionTable)
+    {
+        entry = m_transpositionTable->probe(position.hash());
+
+        m_statistics.tableProbes++;
+        m_statistics.tableHits += entry.has_value();
+    }
+
+    // The root always searches, it has to come up with a move and its line
+    if(entry && ply > 0 && entry->depth >= depth)
+    {
+        int score = scoreFromTable(entry->score, ply);
+        if(entry->bound == ScoreBound::Exact
+            || (entry->bound == ScoreBound::Lower && score >= beta)
+            || (entry->bound == ScoreBound::Upper && score <= alpha))
+        {
+            m_statistics.tableCutoffs++;
+            return std::clamp(score, alpha, beta);
+        }
+    }
+
+    QVector<Move> moves = position.getLegalMoves();
+    bool isInCheck = position.isKingInCheck();
+    if(moves.empty())
+    {
+        // prefer the quickest mate and the slowest defeat
+        return isInCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    const SearchFeatures& features = m_limits.features;
+
+    // A king in check has few moves and they all matter, the root has to come up with a move
+    bool canPrune = !isInCheck && ply > 0;
+
+    int staticEvaluation = 0;
+    if(canPrune && (features.nullMovePruning || features.futilityPruning))
+    {
+        staticEvaluation = evaluate(position);
+    }
+
+    if(features.nullMovePruning && canPrune && isNullMoveAllowed && depth >= NULL_MOVE_MIN_DEPTH
+        && staticEvaluation >= beta && hasNonPawnMaterial(position, position.currentPlayer()))
+    {
+        std::optional<QPoint> enPassantSquare = position.doNullMove();
+        int score = -alphaBeta(position, depth - 1 - NULL_MOVE_REDUCTION, ply + 1, -beta, -beta + 1, false);
+        position.undoNullMove(enPassantSquare);
+
+        if(m_isAborted)
+        {
+            return 0;
+        }
+
+        // A mate found after passing isn't a mate of the real position, beta is all that is known
+        if(score >= beta)
+        {
+            m_statistics.nullMovePrunes++;
+            return beta;
+        }
+    }
+
+    bool canPruneQuietMoves = features.futilityPruning && canPrune && depth < static_cast<int>(FUTILITY_MARGINS.size())
+                              && std::abs(alpha) < PLY_DEPENDENT_SCORE
+                              && staticEvaluation + FUTILITY_MARGINS[depth] <= alpha;
+
+    std::optional<Move> tableMove;
+    if(entry && entry->move != 0)
+    {
+        auto moveIter = std::find_if(std::begin(moves), std::end(moves), [&](const Move& move) {
+            return packMove(move) == entry->move;
+        });
+
+        if(moveIter != std::end(moves))
+        {
+            tableMove = *moveIter;
+        }
+    }
+
+    orderMoves(position, moves, ply == 0 && m_rootBestMove ? m_rootBestMove : tableMove);
+
+    std::optional<Move> bestMove;
+    int originalAlpha = alpha;
+    int moveIndex = 0;
+
+    for (const Move& move : moves) {
+        m_principalVariations[ply + 1].clear();
+
+        bool isQuiet = isQuietMove(move);
+
+        position.doMove(move);
+
+        // Checks are never pruned or reduced, they are the quiet moves most likely to change the score
+        bool mayPruneOrReduce = isQuiet && !isInCheck && (canPruneQuietMoves || features.lateMoveReductions);
+        bool givesCheck = mayPruneOrReduce && position.isKingInCheck();
+
+        if(canPruneQuietMoves && isQuiet && !givesCheck)
+        {
+            position.undoMove(move);
+            continue;
+        }
+
+        int score;
+        if(!features.lateMoveReductions || moveIndex == 0)
+        {
+            score = -alphaBeta(position, depth - 1, ply + 1, -beta, -alpha);
+        }
+        else
+        {
+            int reduction = 0;
+            if(depth >= LATE_MOVE_MIN_DEPTH && moveIndex >= LATE_MOVE_INDEX && mayPruneOrReduce && !givesCheck)
+            {
+                reduction = moveIndex >= VERY_LATE_MOVE_INDEX ? 2 : 1;
+
+                // A move that refuted other positions may well refute this one
+                if(m_history[indexOfColor(oppositeColor(position.currentPlayer()))][historyIndex(move)] > 0)
+                {
+                    reduction--;
+                }
+            }
+
+            if(reduction > 0)
+            {
+                m_statistics.lateMoveReductions++;
+            }
+
+            // Later moves only have to be shown to be no better than the best so far, a null window does that
+            score = -alphaBeta(position, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha);
+
+            if(score > alpha && reduction > 0)
+            {
+                score = -alphaBeta(position, depth - 1, ply + 1, -alpha - 1, -alpha);
+            }
+
+            if(score > alpha && score < beta)
+            {
+                score = -alphaBeta(position, depth - 1, ply + 1, -beta, -alpha);
+            }
+        }
+
+        position.undoMove(move);
+
+        if(m_isAborted)
+        {
+            return 0;
+        }
+
+        if(score >= beta)
+        {
+            m_statistics.betaCutoffs++;
+            m_statistics.firstMoveBetaCutoffs += moveIndex == 0;
+
+            if(isQuiet)
+            {
+                int& moveHistory = m_history[indexOfColor(position.currentPlayer())][historyIndex(move)];
+                moveHistory = std::min(MAX_HISTORY_SCORE, moveHistory + depth * depth);
+            }
+
+            // An aspiration window that failed high searches this move first again
+            if(ply == 0)
+            {
+                m_rootBestMove = move;
+            }
+
+            storeResult(position, depth, ply, beta, ScoreBound::Lower, move);
+            return beta;
+        }
+
+        moveIndex++;
+
+        if(score > alpha)
+        {
+            alpha = score;
+            bestMove = move;
+
+            principalVariation = {move};
+            principalVariation += m_principalVariations[ply + 1];
+
+            if(ply == 0)
+            {
+                m_rootBestMove = move;
+            }
+        }
+    }
+
+    // a root search where every move fails low still needs a move to play
+    if(ply == 0 && !m_rootBestMove)
+    {
+        m_rootBestMove = moves.first();
+    }
+
+    storeResult(position, depth, ply, alpha, alpha > originalAlpha ? ScoreBound::Exact : ScoreBound::Upper, bestMove);
+
+    return alpha;
+}
+
+void Search::storeResult(const Position &position, int depth, int ply, int score, ScoreBound bound, std::optional<Move> bestMove)
+{
+    if(m_transpositionTable)
+    {
+        m_transpositionTable->store(position.hash(), depth, scoreToTable(score, ply), bound, bestMove ? packMove(*bestMove) : 0);
+    }
+}
+
+int Search::quiescence(Position& position, int ply, int alpha, int beta)
+{
+    m_statistics.nodes++;
+    m_statistics.quiescenceNodes++;
+
+    if(shouldAbort())
+    {
+        return 0;
+    }
+
+    int standPat = evaluate(position);
+    if(standPat >= beta || ply >= MAX_PLY)
+    {
+        return standPat;
+    }
+
+    alpha = std::max(alpha, standPat);
+
+    QVector<Move> moves = position.getLegalMoves();
+    moves.removeIf([&](const Move& move) {
+        if(move.flags & PromotionAny)
+        {
+            return false;
+        }
+
+        // Losing captures can't raise alpha over the stand pat score in a quiet position, skip them
+        return !move.isCapture() || staticExchangeEvaluation(position, move) < 0;
+    });
+
+    orderMoves(position, moves);
+
+    for (const Move& move : moves) {
+        position.doMove(move);
+        int score = -quiescence(position, ply + 1, -beta, -alpha);
+        position.undoMove(move);
+
+        if(m_isAborted)
+        {
+            return 0;
+        }
+
+        if(score >= beta)
+        {
+            return beta;
+        }
+
+        alpha = std::max(alpha, score);
+    }
+
+    return alpha;
+}
+
+void Search::orderMoves(const Position& position, QVector<Move>& moves, std::optional<Move> bestMove) const
+{
+    static constexpr int BEST_MOVE_SCORE = 1000000;
+    static constexpr int PROMOTION_SCORE = 100000;
+    static constexpr int GOOD_CAPTURE_SCORE = 50000;
+    static constexpr int BAD_CAPTURE_SCORE = -50000;
+
+    auto moveScore = [&](const Move& move) {
+        if(bestMove && move == *bestMove)
+        {
+            return BEST_MOVE_SCORE;
+        }
+
+        if(move.flags & PromotionQueen)
+        {
+            return PROMOTION_SCORE;
+        }
+
+        if(move.isCapture())
+        {
+            int see = staticExchangeEvaluation(position, move);
+            return see >= 0 ? GOOD_CAPTURE_SCORE + see : BAD_CAPTURE_SCORE + see;
+        }
+
+        return m_limits.features.lateMoveReductions ? m_history[indexOfColor(position.currentPlayer())][historyIndex(move)] : 0;
+    };
+
+    QVector<std::pair<int, Move>> scoredMoves;
+    scoredMoves.reserve(moves.count());
+
+    for (const Move& move : moves) {
+        scoredMoves.append({moveScore(move), move});
+    }
+
+    std::stable_sort(std::begin(scoredMoves), std::end(scoredMoves), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+
+    for (size_t i = 0; i < moves.count(); ++i) {
+        moves[i] = scoredMoves[i].second;
+    }
+}
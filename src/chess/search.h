@@ -0,0 +1,181 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "chess.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace Chess
+{
+
+static constexpr int MATE_SCORE = 100000;
+static constexpr int MAX_PLY = 64;
+
+// Tablebase wins are scored below every mate the search can find, but above any evaluation
+static constexpr int TABLEBASE_WIN_SCORE = MATE_SCORE - 2 * MAX_PLY;
+
+// Counters of a search, kept by the searching thread in plain members of its Search. Searches of several
+// threads or positions are summed up with +=, where and when the numbers are needed.
+struct SearchStatistics
+{
+    // Every node, those of the quiescence search included
+    uint64_t nodes = 0;
+    uint64_t quiescenceNodes = 0;
+
+    uint64_t tableProbes = 0;
+    uint64_t tableHits = 0;
+
+    // Nodes whose table entry was deep enough to return its score without searching
+    uint64_t tableCutoffs = 0;
+
+    uint64_t betaCutoffs = 0;
+
+    // Cutoffs by the first move searched, the higher their share the better the move ordering
+    uint64_t firstMoveBetaCutoffs = 0;
+
+    uint64_t nullMovePrunes = 0;
+    uint64_t lateMoveReductions = 0;
+
+    // Nodes of every completed iteration, the first one for depth 1
+    QVector<uint64_t> iterationNodes;
+
+    // How many times more nodes an iteration took than the one before, from the second iteration on
+    QVector<double> effectiveBranchingFactors() const;
+
+    // Shares from 0 to 1, 0 if there was nothing to share
+    double tableHitRate() const;
+    double firstMoveCutoffRate() const;
+    double quiescenceRate() const;
+
+    // One counter per line, for the headless tools
+    QString toString() const;
+
+    SearchStatistics& operator+=(const SearchStatistics& other);
+};
+
+struct SearchResult
+{
+    std::optional<Move> bestMove;
+
+    // From the point of view of the player to move in the searched position
+    int score = 0;
+    int depth = 0;
+
+    // Starts with the best move. Ends early in a mate or a tablebase position, may go on beyond the depth
+    // with what the transposition table knows.
+    QVector<Move> principalVariation;
+
+    uint64_t nodes = 0;
+    uint64_t tablebaseHits = 0;
+
+    SearchStatistics statistics;
+
+    // A limit ended the search before the requested depth
+    bool isAborted = false;
+};
+
+// Selective parts of the search, each can be turned off to measure what it gains and what it costs.
+// With all of them off the search is a plain alpha-beta search over every move to the full depth.
+struct SearchFeatures
+{
+    // Lets the opponent move twice at reduced depth, a position still good enough after that is pruned.
+    // Not done with only king and pawns left, where having to move can be what loses (zugzwang).
+    bool nullMovePruning = true;
+
+    // Orders quiet moves by the cutoffs they caused before and searches the late ones with reduced depth
+    // and a null window, fewer plies less for those that have caused cutoffs. A move that turns out
+    // better than expected is searched again at full depth.
+    bool lateMoveReductions = true;
+
+    // Skips quiet moves near the leaves where the static evaluation is too far below alpha for them to catch up
+    bool futilityPruning = true;
+
+    // Searches each iteration with a window around the score of the previous one, widening it on a miss
+    bool aspirationWindows = true;
+
+    static SearchFeatures none();
+};
+
+struct SearchLimits
+{
+    int depth = 4;
+
+    // No new iteration is started once the soft time is used up, the search is aborted at the hard time.
+    // The result always comes from the last completed iteration, an aborted one is thrown away.
+    std::optional<qint64> softTimeMs;
+    std::optional<qint64> hardTimeMs;
+
+    // Aborts like the hard time, but at the same node on every run
+    std::optional<uint64_t> maxNodes;
+
+    // Set from another thread to abort the search
+    const std::atomic<bool>* stop = nullptr;
+
+    // Called on the searching thread with the result of every completed iteration
+    std::function<void(const SearchResult&)> onIteration;
+
+    SearchFeatures features;
+};
+
+class TranspositionTable;
+enum class ScoreBound : uint8_t;
+
+// Iterative deepening alpha-beta search with a quiescence search over captures.
+// Positions covered by the loaded Tablebases are scored by their WDL value instead of being searched,
+// at the root the tablebase move is played directly.
+// With a TranspositionTable, positions already searched deep enough aren't searched again and the best move
+// found before is tried first, also in later searches of the same or following positions.
+class Search
+{
+public:
+    // Without a table every search starts from scratch
+    explicit Search(TranspositionTable* transpositionTable = nullptr);
+
+    SearchResult search(const Position& position, const SearchLimits& limits);
+private:
+    // Checked every few nodes, reading the clock at every node would cost more than searching it
+    bool shouldAbort();
+
+    // Searches the root within an aspiration window around the previous score, if they are enabled
+    int searchRoot(Position& root, int depth, int previousScore);
+
+    // The null move isn't tried twice in a row, that would just pass the turn back
+    int alphaBeta(Position& position, int depth, int ply, int alpha, int beta, bool isNullMoveAllowed = true);
+    int quiescence(Position& position, int ply, int alpha, int beta);
+
+    // The line of the root, continued from the table where it was cut short by an entry of an earlier search
+    QVector<Move> principalVariation(const Position& root) const;
+
+    void storeResult(const Position& position, int depth, int ply, int score, ScoreBound bound, std::optional<Move> bestMove);
+
+    // Sorts the moves by promotions, winning and equal captures, quiet moves and losing captures.
+    // The previous best move, if any, is always searched first. With late move reductions the quiet moves
+    // are sorted by their history.
+    void orderMoves(const Position& position, QVector<Move>& moves, std::optional<Move> bestMove = std::nullopt) const;
+private:
+    TranspositionTable* m_transpositionTable;
+
+    // Not atomic, every thread searches with a Search of its own
+    SearchStatistics m_statistics;
+    uint64_t m_tablebaseHits = 0;
+
+    std::optional<Move> m_rootBestMove;
+
+    // Counts the cutoffs caused by each quiet move, weighted by depth, by color, from and to square
+    std::array<std::array<int, 64 * 64>, COLOR_COUNT> m_history;
+
+    // The best line found from each ply on, the line of a ply is built from the one of the next
+    std::array<QVector<Move>, MAX_PLY + 1> m_principalVariations;
+
+    SearchLimits m_limits;
+    std::chrono::steady_clock::time_point m_startTime;
+    bool m_isAborted = false;
+};
+
+}
+
+#endif // SEARCH_H
@@ -0,0 +1,191 @@
+#include "see.h"
+
+#include <cassert>
+
+using namespace Chess;
+
+// Squares are tracked as bits of y * 8 + x
+using SquareMask = uint64_t;
+
+static SquareMask squareBit(QPoint pos)
+{
+    return SquareMask(1) << (pos.y() * Board::WIDTH + pos.x());
+}
+
+int Chess::exchangeValue(PieceType pieceType)
+{
+    switch(pieceType)
+    {
+    case PieceType::Pawn: return 100;
+    case PieceType::Knight: return 320;
+    case PieceType::Bishop: return 330;
+    case PieceType::Rook: return 500;
+    case PieceType::Queen: return 900;
+    case PieceType::King: return 20000;
+    }
+
+    return 0;
+}
+
+static std::optional<Piece> pieceAt(const Board& board, QPoint pos, SquareMask removed)
+{
+    if(!board.isValid(pos) || (removed & squareBit(pos)))
+    {
+        return std::nullopt;
+    }
+
+    return board.pieceAt(pos);
+}
+
+struct Attacker
+{
+    QPoint pos;
+    Piece piece;
+};
+
+// Finds the least valuable piece of the given color attacking the target,
+// treating the removed squares as empty
+static std::optional<Attacker> leastValuableAttacker(const Board& board, QPoint target, Color color, SquareMask removed)
+{
+    std::optional<Attacker> best;
+
+    auto consider = [&](QPoint pos, std::initializer_list<PieceType> types) {
+        std::optional<Piece> piece = pieceAt(board, pos, removed);
+        if(!piece || piece->color != color)
+        {
+            return;
+        }
+
+        if(std::find(types.begin(), types.end(), piece->type) == types.end())
+        {
+            return;
+        }
+
+        if(!best || exchangeValue(piece->type) < exchangeValue(best->piece.type))
+        {
+            best = Attacker{pos, *piece};
+        }
+    };
+
+    // pawns attack diagonally forward, so they stand one rank behind the target
+    int pawnRankOffset = color == Color::White ? 1 : -1;
+    consider(target + QPoint(-1, pawnRankOffset), {PieceType::Pawn});
+    consider(target + QPoint(+1, pawnRankOffset), {PieceType::Pawn});
+
+    static constexpr std::array<QPoint, 8> knightOffsets = {
+        QPoint(+2, +1), QPoint(+2, -1), QPoint(-2, +1), QPoint(-2, -1),
+        QPoint(+1, +2), QPoint(+1, -2), QPoint(-1, +2), QPoint(-1, -2),
+    };
+
+    for (QPoint offset : knightOffsets) {
+        consider(target + offset, {PieceType::Knight});
+    }
+
+    static constexpr std::array<QPoint, 4> diagonals = {
+        QPoint(1, 1), QPoint(-1, -1), QPoint(1, -1), QPoint(-1, 1),
+    };
+
+    static constexpr std::array<QPoint, 4> straights = {
+        QPoint(+1, 0), QPoint(-1, 0), QPoint(0, +1), QPoint(0, -1),
+    };
+
+    // only the first piece on each ray can attack, pieces behind it are x-rays
+    // that take part once the piece in front has been removed
+    auto considerRay = [&](QPoint direction, std::initializer_list<PieceType> types) {
+        QPoint pos = target + direction;
+        while(board.isValid(pos))
+        {
+            if(pieceAt(board, pos, removed))
+            {
+                consider(pos, types);
+                return;
+            }
+
+            pos += direction;
+        }
+    };
+
+    for (QPoint direction : diagonals) {
+        considerRay(direction, {PieceType::Bishop, PieceType::Queen});
+    }
+
+    for (QPoint direction : straights) {
+        considerRay(direction, {PieceType::Rook, PieceType::Queen});
+    }
+
+    for (QPoint direction : diagonals) {
+        consider(target + direction, {PieceType::King});
+    }
+
+    for (QPoint direction : straights) {
+        consider(target + direction, {PieceType::King});
+    }
+
+    return best;
+}
+
+int Chess::staticExchangeEvaluation(const Position& position, const Move& move)
+{
+    const Board& board = position.board();
+    QPoint target = move.to;
+
+    SquareMask removed = 0;
+
+    // gains[i] is the material balance for the side making the i-th capture,
+    // assuming the exchange stops right after it
+    std::array<int, 32> gains;
+    int depth = 0;
+
+    if(move.flags & EnPassant)
+    {
+        gains[0] = exchangeValue(PieceType::Pawn);
+        removed |= squareBit(QPoint(move.to.x(), move.from.y()));
+    }
+    else
+    {
+        gains[0] = move.capture ? exchangeValue(move.capture->type) : 0;
+    }
+
+    Attacker attacker{move.from, move.piece};
+    Color side = move.piece.color;
+
+    while(depth + 1 < static_cast<int>(gains.size()))
+    {
+        depth++;
+
+        // speculative value of capturing the piece that just moved onto the target
+        gains[depth] = exchangeValue(attacker.piece.type) - gains[depth - 1];
+
+        // neither side can profit from continuing
+        if(std::max(-gains[depth - 1], gains[depth]) < 0)
+        {
+            break;
+        }
+
+        removed |= squareBit(attacker.pos);
+        side = oppositeColor(side);
+
+        std::optional<Attacker> next = leastValuableAttacker(board, target, side, removed);
+        if(!next)
+        {
+            break;
+        }
+
+        // the king may only recapture if the square is no longer defended
+        if(next->piece.type == PieceType::King
+            && leastValuableAttacker(board, target, oppositeColor(side), removed | squareBit(next->pos)))
+        {
+            break;
+        }
+
+        attacker = *next;
+    }
+
+    // Let each side pick whether to continue the exchange or stop, from the last capture back to the first
+    while(--depth)
+    {
+        gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+    }
+
+    return gains[0];
+}
@@ -0,0 +1,21 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "chess.h"
+
+namespace Chess
+{
+
+// Piece values used to resolve exchanges, in centipawns
+int exchangeValue(PieceType pieceType);
+
+// Static exchange evaluation: the material the moving side gains (or loses, if negative)
+// when both sides keep recapturing on the target square with their least valuable attacker,
+// each side being free to stop when continuing would lose material.
+// Sliders lined up behind other attackers (x-rays) join in once the square in front is vacated.
+// Doesn't make any moves and ignores pins.
+int staticExchangeEvaluation(const Position& position, const Move& move);
+
+}
+
+#endif // SEE_H
@@ -0,0 +1,392 @@
+#include "tablebase.h"
+
+#include <QDir>
+#include <QtEndian>
+
+#include <algorithm>
+#include <limits>
+
+using namespace Chess;
+
+static constexpr int SQUARE_COUNT = 64;
+
+// Order of the pieces of one side in signatures and table indices
+static int tablebasePieceOrder(PieceType type)
+{
+    switch(type)
+    {
+    case PieceType::King: return 0;
+    case PieceType::Queen: return 1;
+    case PieceType::Rook: return 2;
+    case PieceType::Bishop: return 3;
+    case PieceType::Knight: return 4;
+    case PieceType::Pawn: return 5;
+    }
+
+    return 0;
+}
+
+static int tablebasePieceValue(PieceType type)
+{
+    switch(type)
+    {
+    case PieceType::Pawn: return 1;
+    case PieceType::Knight: return 3;
+    case PieceType::Bishop: return 3;
+    case PieceType::Rook: return 5;
+    case PieceType::Queen: return 9;
+    case PieceType::King: return 0;
+    }
+
+    return 0;
+}
+
+static QChar tablebasePieceLetter(PieceType type)
+{
+    switch(type)
+    {
+    case PieceType::King: return 'K';
+    case PieceType::Queen: return 'Q';
+    case PieceType::Rook: return 'R';
+    case PieceType::Bishop: return 'B';
+    case PieceType::Knight: return 'N';
+    case PieceType::Pawn: return 'P';
+    }
+
+    return '?';
+}
+
+static QString sideSignature(const TablebasePlacement& placement, Color color)
+{
+    QVector<int> orders;
+    for (const TablebasePiece& entry : placement) {
+        if(entry.piece.color == color)
+        {
+            orders.append(tablebasePieceOrder(entry.piece.type));
+        }
+    }
+
+    std::sort(std::begin(orders), std::end(orders));
+
+    static constexpr std::array<PieceType, 6> typesByOrder = {
+        PieceType::King, PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight, PieceType::Pawn,
+    };
+
+    QString signature;
+    for (int order : orders) {
+        signature.append(tablebasePieceLetter(typesByOrder[order]));
+    }
+
+    return signature;
+}
+
+bool Chess::canonicalizeTablebasePlacement(TablebasePlacement &placement, Color &sideToMove)
+{
+    int whiteValue = 0;
+    int blackValue = 0;
+
+    for (const TablebasePiece& entry : placement) {
+        int value = tablebasePieceValue(entry.piece.type);
+        (entry.piece.color == Color::White ? whiteValue : blackValue) += value;
+    }
+
+    // Sides of equal value are told apart by their signatures, so that every material
+    // combination has exactly one stored orientation. Identical sides are stored in both.
+    bool flip = whiteValue < blackValue;
+    if(whiteValue == blackValue)
+    {
+        flip = sideSignature(placement, Color::White) > sideSignature(placement, Color::Black);
+    }
+
+    if(flip)
+    {
+        for (TablebasePiece& entry : placement) {
+            entry.piece.color = oppositeColor(entry.piece.color);
+
+            // mirror the rank, keep the file
+            entry.square ^= 56;
+        }
+
+        sideToMove = oppositeColor(sideToMove);
+    }
+
+    std::stable_sort(std::begin(placement), std::end(placement), [](const TablebasePiece& a, const TablebasePiece& b) {
+        if(a.piece.color != b.piece.color)
+        {
+            return a.piece.color == Color::White;
+        }
+
+        return tablebasePieceOrder(a.piece.type) < tablebasePieceOrder(b.piece.type);
+    });
+
+    return flip;
+}
+
+QString Chess::tablebaseSignature(const TablebasePlacement &placement)
+{
+    return QString("%1v%2").arg(sideSignature(placement, Color::White), sideSignature(placement, Color::Black));
+}
+
+size_t Chess::tablebaseIndex(const TablebasePlacement &placement, Color sideToMove)
+{
+    size_t index = indexOfColor(sideToMove);
+
+    for (const TablebasePiece& entry : placement) {
+        index = index * SQUARE_COUNT + entry.square;
+    }
+
+    return index;
+}
+
+size_t Chess::tablebaseEntryCount(int pieceCount)
+{
+    size_t count = COLOR_COUNT;
+
+    for (int i = 0; i < pieceCount; ++i) {
+        count *= SQUARE_COUNT;
+    }
+
+    return count;
+}
+
+Tablebases &Tablebases::instance()
+{
+    static Tablebases s_tablebases;
+    return s_tablebases;
+}
+
+Tablebases::~Tablebases()
+{
+    unload();
+}
+
+bool Tablebases::mapFile(MappedFile &mappedFile, const QString &path, uint32_t magic, const QString &signature)
+{
+    mappedFile.file.setFileName(path);
+    if(!mappedFile.file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 size = mappedFile.file.size();
+    if(size < static_cast<qint64>(TablebaseHeader::SIZE))
+    {
+        return false;
+    }
+
+    const uchar* data = mappedFile.file.map(0, size);
+    if(!data)
+    {
+        return false;
+    }
+
+    uint32_t fileMagic = qFromLittleEndian<quint32>(data);
+    uint32_t version = qFromLittleEndian<quint32>(data + 4);
+    uint32_t pieceCount = qFromLittleEndian<quint32>(data + 8);
+    QString fileSignature = QString::fromLatin1(reinterpret_cast<const char*>(data + 12));
+
+    bool isValid = fileMagic == magic
+                   && version == TablebaseHeader::VERSION
+                   && pieceCount <= TABLEBASE_MAX_PIECES
+                   && fileSignature == signature
+                   && static_cast<size_t>(size) == TablebaseHeader::SIZE + tablebaseEntryCount(pieceCount);
+
+    if(!isValid)
+    {
+        mappedFile.file.unmap(const_cast<uchar*>(data));
+        return false;
+    }
+
+    mappedFile.data = data + TablebaseHeader::SIZE;
+    mappedFile.entryCount = tablebaseEntryCount(pieceCount);
+
+    return true;
+}
+
+int Tablebases::load(const QString &directory)
+{
+    unload();
+
+    m_directory = directory;
+
+    QDir dir(directory);
+    const QStringList wdlFiles = dir.entryList({"*.ctbw"}, QDir::Files);
+
+    for (const QString& wdlFile : wdlFiles) {
+        QString signature = wdlFile.left(wdlFile.size() - 5);
+
+        auto table = std::make_unique<Table>();
+
+        bool isMapped = mapFile(table->wdl, dir.filePath(signature + ".ctbw"), TablebaseHeader::WDL_MAGIC, signature)
+                        && mapFile(table->dtz, dir.filePath(signature + ".ctbz"), TablebaseHeader::DTZ_MAGIC, signature);
+        if(!isMapped)
+        {
+            continue;
+        }
+
+        int pieceCount = signature.size() - 1;
+        m_maxPieces = std::max(m_maxPieces, pieceCount);
+
+        m_tables[signature] = std::move(table);
+    }
+
+    return m_tables.size();
+}
+
+void Tablebases::unload()
+{
+    // unmapping is left to QFile, which unmaps everything it mapped when it is destroyed
+    m_tables.clear();
+    m_maxPieces = 0;
+    m_directory.clear();
+}
+
+const QString &Tablebases::directory() const
+{
+    return m_directory;
+}
+
+int Tablebases::maxPieces() const
+{
+    return m_maxPieces;
+}
+
+bool Tablebases::canProbe(const Position &position) const
+{
+    return position.pieceCount() <= m_maxPieces
+           && position.castlingRights() == 0
+           && !position.enPassantSquare();
+}
+
+bool Tablebases::lookup(const Position &position, uint8_t &wdl, uint8_t *dtz) const
+{
+    if(!canProbe(position))
+    {
+        return false;
+    }
+
+    // bare kings are always a draw and don't need a table
+    if(position.pieceCount() == 2)
+    {
+        wdl = static_cast<uint8_t>(Wdl::Draw);
+        if(dtz)
+        {
+            *dtz = 0;
+        }
+        return true;
+    }
+
+    TablebasePlacement placement;
+    const Board& board = position.board();
+
+    for (int y = 0; y < Board::HEIGHT; ++y) {
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            std::optional<Piece> piece = board.pieceAt(QPoint(x, y));
+            if(piece)
+            {
+                placement.append(TablebasePiece{*piece, y * static_cast<int>(Board::WIDTH) + x});
+            }
+        }
+    }
+
+    Color sideToMove = position.currentPlayer();
+    canonicalizeTablebasePlacement(placement, sideToMove);
+
+    auto table = m_tables.find(tablebaseSignature(placement));
+    if(table == m_tables.end())
+    {
+        return false;
+    }
+
+    size_t index = tablebaseIndex(placement, sideToMove);
+    if(index >= table->second->wdl.entryCount)
+    {
+        return false;
+    }
+
+    wdl = table->second->wdl.data[index];
+    if(wdl < static_cast<uint8_t>(Wdl::Loss) || wdl > static_cast<uint8_t>(Wdl::Win))
+    {
+        return false;
+    }
+
+    if(dtz)
+    {
+        *dtz = table->second->dtz.data[index];
+    }
+
+    return true;
+}
+
+std::optional<Wdl> Tablebases::probeWdl(const Position &position) const
+{
+    uint8_t wdl;
+    if(!lookup(position, wdl, nullptr))
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<Wdl>(wdl);
+}
+
+std::optional<TablebaseProbe> Tablebases::probe(const Position &position) const
+{
+    uint8_t wdl;
+    uint8_t dtz;
+    if(!lookup(position, wdl, &dtz))
+    {
+        return std::nullopt;
+    }
+
+    return TablebaseProbe{static_cast<Wdl>(wdl), dtz};
+}
+
+std::optional<Move> Tablebases::bestMove(const Position &position) const
+{
+    if(!canProbe(position) || !probeWdl(position))
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Move> bestMove;
+    int bestRank = std::numeric_limits<int>::min();
+
+    for (const Move& move : position.getLegalMoves()) {
+        Position next = position.nextPosition(move);
+
+        bool isZeroing = move.isCapture() || move.piece.type == PieceType::Pawn;
+
+        // Rank the moves by result first, then by how many plies it takes to reach the next zeroing move
+        int rank = 0;
+        if(next.getLegalMoves().empty())
+        {
+            // checkmate beats everything, stalemate is a draw
+            rank = next.isKingInCheck() ? 2000 : 0;
+        }
+        else
+        {
+            std::optional<TablebaseProbe> result = probe(next);
+            if(!result)
+            {
+                continue;
+            }
+
+            int dtz = isZeroing ? 1 : result->dtz + 1;
+
+            switch(result->wdl)
+            {
+            case Wdl::Loss: rank = 1000 - dtz; break;
+            case Wdl::Draw: rank = 0; break;
+            case Wdl::Win: rank = -1000 + dtz; break;
+            }
+        }
+
+        if(rank > bestRank)
+        {
+            bestRank = rank;
+            bestMove = move;
+        }
+    }
+
+    return bestMove;
+}
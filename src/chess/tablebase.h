@@ -0,0 +1,132 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "chess.h"
+
+#include <QFile>
+
+#include <map>
+#include <memory>
+
+namespace Chess
+{
+
+// Endgame tablebases in the spirit of Syzygy: for every material signature (e.g. "KRvK")
+// a WDL file (.ctbw) holds win/draw/loss and a DTZ file (.ctbz) the distance to the next
+// zeroing move (capture or pawn move) in plies, one byte per position.
+// Tables are indexed by the squares of all pieces and the side to move. Positions are stored
+// with the stronger side as white, the other orientation is probed by mirroring the board.
+// Castling and en passant are not part of the tables, such positions are never probed.
+// The fifty move rule is ignored, a win may take more than 100 plies to convert.
+
+enum class Wdl : uint8_t
+{
+    Loss = 1,
+    Draw = 2,
+    Win = 3,
+};
+
+static constexpr int TABLEBASE_MAX_PIECES = 4;
+
+struct TablebasePiece
+{
+    Piece piece;
+
+    // y * 8 + x
+    int square;
+};
+
+using TablebasePlacement = QVector<TablebasePiece>;
+
+// Mirrors the placement if needed so that the stronger side is white and sorts the pieces
+// into the order the tables are indexed in. Returns whether the colors got flipped.
+bool canonicalizeTablebasePlacement(TablebasePlacement& placement, Color& sideToMove);
+
+// Material signature like "KQvK" of a canonical placement, white's pieces first
+QString tablebaseSignature(const TablebasePlacement& placement);
+
+size_t tablebaseIndex(const TablebasePlacement& placement, Color sideToMove);
+size_t tablebaseEntryCount(int pieceCount);
+
+// File header shared by WDL and DTZ files, followed by tablebaseEntryCount() bytes
+struct TablebaseHeader
+{
+    static constexpr uint32_t WDL_MAGIC = 0x57425443; // "CTBW"
+    static constexpr uint32_t DTZ_MAGIC = 0x5A425443; // "CTBZ"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t SIZE = 32;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pieceCount;
+    char signature[20];
+};
+
+struct TablebaseProbe
+{
+    // From the point of view of the player to move
+    Wdl wdl;
+
+    // Plies to the next capture or pawn move with best play, 0 for draws and checkmates
+    int dtz;
+};
+
+// Probes memory mapped tables. Loading is not thread safe, but once loaded
+// the tables are read only and can be probed from any number of search threads without locking.
+class Tablebases
+{
+public:
+    static Tablebases& instance();
+
+    Tablebases() = default;
+    ~Tablebases();
+
+    Tablebases(const Tablebases&) = delete;
+    Tablebases& operator=(const Tablebases&) = delete;
+
+    // Maps all tables found in the directory, replacing the previously loaded ones.
+    // Returns the number of tables loaded. No search may be probing while the tables change.
+    int load(const QString& directory);
+    void unload();
+
+    const QString& directory() const;
+
+    // Largest piece count for which tables are loaded, 0 if there are none
+    int maxPieces() const;
+
+    // Whether the position could be in the loaded tables, a cheap check before probing
+    bool canProbe(const Position& position) const;
+
+    std::optional<Wdl> probeWdl(const Position& position) const;
+    std::optional<TablebaseProbe> probe(const Position& position) const;
+
+    // The move keeping the best result, winning as fast and losing as slowly as possible by DTZ.
+    // Meant for the root of a search, as it probes the positions after every legal move.
+    std::optional<Move> bestMove(const Position& position) const;
+private:
+    struct MappedFile
+    {
+        QFile file;
+        const uchar* data = nullptr;
+        size_t entryCount = 0;
+    };
+
+    struct Table
+    {
+        MappedFile wdl;
+        MappedFile dtz;
+    };
+
+    static bool mapFile(MappedFile& mappedFile, const QString& path, uint32_t magic, const QString& signature);
+
+    // Looks up the raw WDL and DTZ bytes of a position, the DTZ byte only if asked for
+    bool lookup(const Position& position, uint8_t& wdl, uint8_t* dtz) const;
+private:
+    QString m_directory;
+    std::map<QString, std::unique_ptr<Table>> m_tables;
+    int m_maxPieces = 0;
+};
+
+}
+
+#endif // TABLEBASE_H
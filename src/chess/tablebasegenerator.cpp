@@ -0,0 +1,846 @@
+#include "tablebasegenerator.h"
+
+#include <QDir>
+#include <QtEndian>
+
+#include <bitset>
+#include <cassert>
+#include <cstdlib>
+
+using namespace Chess;
+
+// Marks positions whose result is not known yet while solving, they end up as draws
+static constexpr uint8_t WDL_INVALID = 0;
+static constexpr uint8_t WDL_UNDECIDED = 0xFF;
+static constexpr uint8_t DTZ_UNKNOWN = 0xFF;
+static constexpr int DTZ_MAX = 0xFE;
+
+static constexpr std::array<PieceType, 4> PROMOTION_TYPES = {
+    PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight,
+};
+
+static constexpr std::array<std::array<int, 2>, 8> KNIGHT_OFFSETS = {{
+    {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2},
+}};
+
+static constexpr std::array<std::array<int, 2>, 8> KING_OFFSETS = {{
+    {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1},
+}};
+
+using Squares = std::array<int, TABLEBASE_MAX_PIECES>;
+
+// A move of the retrograde move generator, pieces are referred to by their index in the table
+struct GeneratorMove
+{
+    int piece;
+    int to;
+    int captured = -1;
+    std::optional<PieceType> promotion;
+
+    bool staysInTable() const
+    {
+        return captured < 0 && !promotion;
+    }
+};
+
+static int squareAt(int x, int y)
+{
+    return y * Board::WIDTH + x;
+}
+
+static bool isOnBoard(int x, int y)
+{
+    return x >= 0 && x < static_cast<int>(Board::WIDTH) && y >= 0 && y < static_cast<int>(Board::HEIGHT);
+}
+
+static int pawnDirection(Color color)
+{
+    return color == Color::White ? -1 : 1;
+}
+
+static bool movesDiagonally(PieceType type)
+{
+    return type == PieceType::Bishop || type == PieceType::Queen;
+}
+
+static bool movesStraight(PieceType type)
+{
+    return type == PieceType::Rook || type == PieceType::Queen;
+}
+
+static int pieceOnSquare(const Squares& squares, int count, int square)
+{
+    for (int i = 0; i < count; ++i) {
+        if(squares[i] == square)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static bool isPathClear(int from, int to, uint64_t occupied)
+{
+    int dx = (to % 8 > from % 8) - (to % 8 < from % 8);
+    int dy = (to / 8 > from / 8) - (to / 8 < from / 8);
+
+    for (int square = from + dy * 8 + dx; square != to; square += dy * 8 + dx) {
+        if(occupied & (1ull << square))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool attacksSquare(Piece piece, int from, int target, uint64_t occupied)
+{
+    int dx = target % 8 - from % 8;
+    int dy = target / 8 - from / 8;
+    int adx = std::abs(dx);
+    int ady = std::abs(dy);
+
+    switch(piece.type)
+    {
+    case PieceType::Pawn:
+        return adx == 1 && dy == pawnDirection(piece.color);
+    case PieceType::Knight:
+        return (adx == 1 && ady == 2) || (adx == 2 && ady == 1);
+    case PieceType::King:
+        return std::max(adx, ady) == 1;
+    case PieceType::Bishop:
+    case PieceType::Rook:
+    case PieceType::Queen:
+    {
+        bool isDiagonal = adx == ady && adx != 0;
+        bool isStraight = (adx == 0) != (ady == 0);
+        bool isLine = (isDiagonal && movesDiagonally(piece.type)) || (isStraight && movesStraight(piece.type));
+        return isLine && isPathClear(from, target, occupied);
+    }
+    }
+
+    return false;
+}
+
+static bool isSquareAttacked(const QVector<Piece>& pieces, const Squares& squares, int target, Color byColor, uint64_t occupied, int ignoredPiece)
+{
+    for (int i = 0; i < pieces.size(); ++i) {
+        if(i != ignoredPiece && pieces[i].color == byColor && attacksSquare(pieces[i], squares[i], target, occupied))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint64_t occupiedSquares(const Squares& squares, int count)
+{
+    uint64_t occupied = 0;
+    for (int i = 0; i < count; ++i) {
+        occupied |= 1ull << squares[i];
+    }
+
+    return occupied;
+}
+
+static int kingOf(const QVector<Piece>& pieces, Color color)
+{
+    for (int i = 0; i < pieces.size(); ++i) {
+        if(pieces[i].type == PieceType::King && pieces[i].color == color)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static size_t positionIndex(const Squares& squares, int count, Color sideToMove)
+{
+    size_t index = indexOfColor(sideToMove);
+    for (int i = 0; i < count; ++i) {
+        index = index * 64 + squares[i];
+    }
+
+    return index;
+}
+
+static Color decodePosition(size_t index, int count, Squares& squares)
+{
+    for (int i = count - 1; i >= 0; --i) {
+        squares[i] = index % 64;
+        index /= 64;
+    }
+
+    return index == indexOfColor(Color::White) ? Color::White : Color::Black;
+}
+
+// Distinct squares, no pawns on the first or last rank and the side not to move isn't in check
+static bool isValidPosition(const QVector<Piece>& pieces, const Squares& squares, Color sideToMove)
+{
+    int count = pieces.size();
+    uint64_t occupied = occupiedSquares(squares, count);
+
+    if(std::bitset<64>(occupied).count() != static_cast<size_t>(count))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int y = squares[i] / 8;
+        if(pieces[i].type == PieceType::Pawn && (y == 0 || y == static_cast<int>(Board::HEIGHT) - 1))
+        {
+            return false;
+        }
+    }
+
+    Color opponent = oppositeColor(sideToMove);
+    return !isSquareAttacked(pieces, squares, squares[kingOf(pieces, opponent)], sideToMove, occupied, -1);
+}
+
+static void addPawnMove(const GeneratorMove& move, int lastRank, QVector<GeneratorMove>& moves)
+{
+    if(move.to / 8 != lastRank)
+    {
+        moves.append(move);
+        return;
+    }
+
+    for (PieceType type : PROMOTION_TYPES) {
+        GeneratorMove promotion = move;
+        promotion.promotion = type;
+        moves.append(promotion);
+    }
+}
+
+// All legal moves of the side to move. Kings are never captured, positions allowing that are invalid.
+static void generateMoves(const QVector<Piece>& pieces, const Squares& squares, Color sideToMove, QVector<GeneratorMove>& moves)
+{
+    moves.clear();
+
+    int count = pieces.size();
+    uint64_t occupied = occupiedSquares(squares, count);
+
+    QVector<GeneratorMove> pseudoLegalMoves;
+
+    // Returns whether a slider may continue past the square
+    auto addTarget = [&](int piece, int to) {
+        int target = pieceOnSquare(squares, count, to);
+        if(target < 0)
+        {
+            pseudoLegalMoves.append(GeneratorMove{piece, to});
+            return true;
+        }
+
+        if(pieces[target].color != sideToMove && pieces[target].type != PieceType::King)
+        {
+            pseudoLegalMoves.append(GeneratorMove{piece, to, target});
+        }
+
+        return false;
+    };
+
+    for (int i = 0; i < count; ++i) {
+        const Piece& piece = pieces[i];
+        if(piece.color != sideToMove)
+        {
+            continue;
+        }
+
+        int x = squares[i] % 8;
+        int y = squares[i] / 8;
+
+        switch(piece.type)
+        {
+        case PieceType::Pawn:
+        {
+            int dy = pawnDirection(piece.color);
+            int startRank = piece.color == Color::White ? Board::HEIGHT - 2 : 1;
+            int lastRank = piece.color == Color::White ? 0 : Board::HEIGHT - 1;
+
+            int oneStep = squareAt(x, y + dy);
+            if(!(occupied & (1ull << oneStep)))
+            {
+                addPawnMove(GeneratorMove{i, oneStep}, lastRank, pseudoLegalMoves);
+
+                int twoSteps = squareAt(x, y + 2 * dy);
+                if(y == startRank && !(occupied & (1ull << twoSteps)))
+                {
+                    pseudoLegalMoves.append(GeneratorMove{i, twoSteps});
+                }
+            }
+
+            for (int dx : {-1, 1}) {
+                if(!isOnBoard(x + dx, y + dy))
+                {
+                    continue;
+                }
+
+                int to = squareAt(x + dx, y + dy);
+                int target = pieceOnSquare(squares, count, to);
+                if(target >= 0 && pieces[target].color != sideToMove && pieces[target].type != PieceType::King)
+                {
+                    addPawnMove(GeneratorMove{i, to, target}, lastRank, pseudoLegalMoves);
+                }
+            }
+            break;
+        }
+        case PieceType::Knight:
+        case PieceType::King:
+        {
+            const auto& offsets = piece.type == PieceType::Knight ? KNIGHT_OFFSETS : KING_OFFSETS;
+            for (const auto& offset : offsets) {
+                if(isOnBoard(x + offset[0], y + offset[1]))
+                {
+                    addTarget(i, squareAt(x + offset[0], y + offset[1]));
+                }
+            }
+            break;
+        }
+        case PieceType::Bishop:
+        case PieceType::Rook:
+        case PieceType::Queen:
+            for (const auto& offset : KING_OFFSETS) {
+                bool isDiagonal = offset[0] != 0 && offset[1] != 0;
+                if(isDiagonal ? !movesDiagonally(piece.type) : !movesStraight(piece.type))
+                {
+                    continue;
+                }
+
+                for (int tx = x + offset[0], ty = y + offset[1]; isOnBoard(tx, ty); tx += offset[0], ty += offset[1]) {
+                    if(!addTarget(i, squareAt(tx, ty)))
+                    {
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+    }
+
+    int king = kingOf(pieces, sideToMove);
+    Color opponent = oppositeColor(sideToMove);
+
+    for (const GeneratorMove& move : pseudoLegalMoves) {
+        Squares after = squares;
+        after[move.piece] = move.to;
+
+        uint64_t occupiedAfter = (occupied & ~(1ull << squares[move.piece])) | (1ull << move.to);
+        if(!isSquareAttacked(pieces, after, after[king], opponent, occupiedAfter, move.captured))
+        {
+            moves.append(move);
+        }
+    }
+}
+
+// Calls visit(piece, from) for every non capturing, non promoting move of the color
+// that could have led to this position. Checks of the resulting positions are left to the caller.
+template<typename Visit>
+static void generateUnmoves(const QVector<Piece>& pieces, const Squares& squares, Color color, bool includePawns, Visit visit)
+{
+    int count = pieces.size();
+    uint64_t occupied = occupiedSquares(squares, count);
+
+    auto isEmpty = [occupied](int square) {
+        return !(occupied & (1ull << square));
+    };
+
+    for (int i = 0; i < count; ++i) {
+        const Piece& piece = pieces[i];
+        if(piece.color != color)
+        {
+            continue;
+        }
+
+        int x = squares[i] % 8;
+        int y = squares[i] / 8;
+
+        switch(piece.type)
+        {
+        case PieceType::Pawn:
+        {
+            if(!includePawns)
+            {
+                break;
+            }
+
+            int dy = pawnDirection(piece.color);
+            int startRank = piece.color == Color::White ? Board::HEIGHT - 2 : 1;
+
+            int from = y - dy;
+            if(from == 0 || from == static_cast<int>(Board::HEIGHT) - 1 || !isEmpty(squareAt(x, from)))
+            {
+                break;
+            }
+
+            visit(i, squareAt(x, from));
+
+            if(from - dy == startRank && isEmpty(squareAt(x, startRank)))
+            {
+                visit(i, squareAt(x, startRank));
+            }
+            break;
+        }
+        case PieceType::Knight:
+        case PieceType::King:
+        {
+            const auto& offsets = piece.type == PieceType::Knight ? KNIGHT_OFFSETS : KING_OFFSETS;
+            for (const auto& offset : offsets) {
+                if(isOnBoard(x + offset[0], y + offset[1]) && isEmpty(squareAt(x + offset[0], y + offset[1])))
+                {
+                    visit(i, squareAt(x + offset[0], y + offset[1]));
+                }
+            }
+            break;
+        }
+        case PieceType::Bishop:
+        case PieceType::Rook:
+        case PieceType::Queen:
+            for (const auto& offset : KING_OFFSETS) {
+                bool isDiagonal = offset[0] != 0 && offset[1] != 0;
+                if(isDiagonal ? !movesDiagonally(piece.type) : !movesStraight(piece.type))
+                {
+                    continue;
+                }
+
+                for (int tx = x + offset[0], ty = y + offset[1]; isOnBoard(tx, ty) && isEmpty(squareAt(tx, ty)); tx += offset[0], ty += offset[1]) {
+                    visit(i, squareAt(tx, ty));
+                }
+            }
+            break;
+        }
+    }
+}
+
+static bool writeTableFile(const QString& path, uint32_t magic, const QString& signature, int pieceCount, const std::vector<uint8_t>& data)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    QByteArray header(TablebaseHeader::SIZE, '\0');
+    uchar* out = reinterpret_cast<uchar*>(header.data());
+
+    qToLittleEndian<quint32>(magic, out);
+    qToLittleEndian<quint32>(TablebaseHeader::VERSION, out + 4);
+    qToLittleEndian<quint32>(pieceCount, out + 8);
+
+    QByteArray name = signature.toLatin1();
+    std::copy_n(name.constData(), std::min<size_t>(name.size(), sizeof(TablebaseHeader::signature) - 1), header.data() + 12);
+
+    return file.write(header) == header.size()
+           && file.write(reinterpret_cast<const char*>(data.data()), data.size()) == static_cast<qint64>(data.size());
+}
+
+TablebaseGenerator::TablebaseGenerator(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+bool TablebaseGenerator::generate(const QString &signature)
+{
+    std::optional<QVector<Piece>> pieces = parseSignature(signature);
+    if(!pieces)
+    {
+        return false;
+    }
+
+    // bare kings are a draw without a table
+    return pieces->size() == 2 || generateTable(*pieces);
+}
+
+std::optional<QVector<Piece>> TablebaseGenerator::parseSignature(const QString &signature)
+{
+    QStringList sides = signature.toUpper().split('V');
+    if(sides.size() != 2)
+    {
+        return std::nullopt;
+    }
+
+    TablebasePlacement placement;
+
+    for (int side = 0; side < 2; ++side) {
+        Color color = side == 0 ? Color::White : Color::Black;
+        int kingCount = 0;
+
+        for (QChar letter : sides[side]) {
+            PieceType type;
+            switch(letter.toLatin1())
+            {
+            case 'K': type = PieceType::King; ++kingCount; break;
+            case 'Q': type = PieceType::Queen; break;
+            case 'R': type = PieceType::Rook; break;
+            case 'B': type = PieceType::Bishop; break;
+            case 'N': type = PieceType::Knight; break;
+            case 'P': type = PieceType::Pawn; break;
+            default: return std::nullopt;
+            }
+
+            // the squares only need to be distinct for canonicalizing
+            placement.append(TablebasePiece{Piece{color, type}, static_cast<int>(placement.size())});
+        }
+
+        if(kingCount != 1)
+        {
+            return std::nullopt;
+        }
+    }
+
+    if(placement.size() > TABLEBASE_MAX_PIECES)
+    {
+        return std::nullopt;
+    }
+
+    Color sideToMove = Color::White;
+    canonicalizeTablebasePlacement(placement, sideToMove);
+
+    QVector<Piece> pieces;
+    for (const TablebasePiece& entry : placement) {
+        pieces.append(entry.piece);
+    }
+
+    return pieces;
+}
+
+const TablebaseGenerator::Table *TablebaseGenerator::generateTable(const QVector<Piece> &unorderedPieces)
+{
+    TablebasePlacement placement;
+    for (const Piece& piece : unorderedPieces) {
+        placement.append(TablebasePiece{piece, static_cast<int>(placement.size())});
+    }
+
+    Color sideToMove = Color::White;
+    canonicalizeTablebasePlacement(placement, sideToMove);
+
+    QString signature = tablebaseSignature(placement);
+
+    auto existing = m_tables.find(signature);
+    if(existing != m_tables.end())
+    {
+        return existing->second.get();
+    }
+
+    QVector<Piece> pieces;
+    for (const TablebasePiece& entry : placement) {
+        pieces.append(entry.piece);
+    }
+
+    // Every table a capture or promotion leads to has to be solved first
+    QVector<QVector<Piece>> conversions;
+    for (int i = 0; i < pieces.size(); ++i) {
+        if(pieces[i].type == PieceType::King)
+        {
+            continue;
+        }
+
+        QVector<Piece> captured = pieces;
+        captured.removeAt(i);
+        conversions.append(captured);
+
+        if(pieces[i].type != PieceType::Pawn)
+        {
+            continue;
+        }
+
+        for (PieceType type : PROMOTION_TYPES) {
+            QVector<Piece> promoted = pieces;
+            promoted[i].type = type;
+            conversions.append(promoted);
+
+            for (int j = 0; j < pieces.size(); ++j) {
+                if(pieces[j].color != pieces[i].color && pieces[j].type != PieceType::King)
+                {
+                    QVector<Piece> promotedWithCapture = promoted;
+                    promotedWithCapture.removeAt(j);
+                    conversions.append(promotedWithCapture);
+                }
+            }
+        }
+    }
+
+    for (const QVector<Piece>& conversion : conversions) {
+        if(conversion.size() > 2 && !generateTable(conversion))
+        {
+            return nullptr;
+        }
+    }
+
+    auto table = std::make_unique<Table>();
+    table->signature = signature;
+    table->pieces = pieces;
+
+    solve(*table);
+
+    QDir dir(m_directory);
+    bool isWritten = writeTableFile(dir.filePath(signature + ".ctbw"), TablebaseHeader::WDL_MAGIC, signature, pieces.size(), table->wdl)
+                     && writeTableFile(dir.filePath(signature + ".ctbz"), TablebaseHeader::DTZ_MAGIC, signature, pieces.size(), table->dtz);
+    if(!isWritten)
+    {
+        return nullptr;
+    }
+
+    const Table* result = table.get();
+    m_tables[signature] = std::move(table);
+
+    return result;
+}
+
+uint8_t TablebaseGenerator::convertedWdl(const TablebasePlacement &placement, Color sideToMove) const
+{
+    if(placement.size() == 2)
+    {
+        return static_cast<uint8_t>(Wdl::Draw);
+    }
+
+    TablebasePlacement canonicalPlacement = placement;
+    canonicalizeTablebasePlacement(canonicalPlacement, sideToMove);
+
+    auto table = m_tables.find(tablebaseSignature(canonicalPlacement));
+    assert(table != m_tables.end());
+
+    return table->second->wdl[tablebaseIndex(canonicalPlacement, sideToMove)];
+}
+
+void TablebaseGenerator::solve(Table &table) const
+{
+    const QVector<Piece>& pieces = table.pieces;
+    int count = pieces.size();
+    size_t entryCount = tablebaseEntryCount(count);
+
+    std::vector<uint8_t>& wdl = table.wdl;
+    std::vector<uint8_t>& dtz = table.dtz;
+    wdl.assign(entryCount, WDL_INVALID);
+    dtz.assign(entryCount, 0);
+
+    // Moves per position that are not known to lose the game yet
+    std::vector<uint8_t> remaining(entryCount, 0);
+
+    QVector<GeneratorMove> moves;
+    std::vector<size_t> decided;
+
+    auto convertedResult = [&](const Squares& squares, const GeneratorMove& move, Color sideToMove) {
+        TablebasePlacement placement;
+        for (int i = 0; i < count; ++i) {
+            if(i == move.captured)
+            {
+                continue;
+            }
+
+            Piece piece = pieces[i];
+            int square = squares[i];
+            if(i == move.piece)
+            {
+                square = move.to;
+                piece.type = move.promotion.value_or(piece.type);
+            }
+
+            placement.append(TablebasePiece{piece, square});
+        }
+
+        return convertedWdl(placement, oppositeColor(sideToMove));
+    };
+
+    // Checkmates, stalemates and everything decided by captures and promotions
+    for (size_t index = 0; index < entryCount; ++index) {
+        Squares squares = {};
+        Color sideToMove = decodePosition(index, count, squares);
+
+        if(!isValidPosition(pieces, squares, sideToMove))
+        {
+            continue;
+        }
+
+        generateMoves(pieces, squares, sideToMove, moves);
+
+        int unresolved = 0;
+        bool isWin = false;
+
+        for (const GeneratorMove& move : moves) {
+            if(move.staysInTable())
+            {
+                ++unresolved;
+                continue;
+            }
+
+            uint8_t result = convertedResult(squares, move, sideToMove);
+            if(result == static_cast<uint8_t>(Wdl::Loss))
+            {
+                isWin = true;
+            }
+            else if(result != static_cast<uint8_t>(Wdl::Win))
+            {
+                ++unresolved;
+            }
+        }
+
+        if(moves.empty())
+        {
+            int king = kingOf(pieces, sideToMove);
+            bool isInCheck = isSquareAttacked(pieces, squares, squares[king], oppositeColor(sideToMove), occupiedSquares(squares, count), -1);
+            wdl[index] = static_cast<uint8_t>(isInCheck ? Wdl::Loss : Wdl::Draw);
+        }
+        else if(isWin)
+        {
+            wdl[index] = static_cast<uint8_t>(Wdl::Win);
+        }
+        else if(unresolved == 0)
+        {
+            wdl[index] = static_cast<uint8_t>(Wdl::Loss);
+        }
+        else
+        {
+            wdl[index] = WDL_UNDECIDED;
+            remaining[index] = unresolved;
+            continue;
+        }
+
+        if(wdl[index] != static_cast<uint8_t>(Wdl::Draw))
+        {
+            decided.push_back(index);
+        }
+    }
+
+    // Retrograde analysis: a move into a lost position wins, if all moves lead into won positions it's lost
+    for (size_t next = 0; next < decided.size(); ++next) {
+        size_t index = decided[next];
+        Squares squares = {};
+        Color sideToMove = decodePosition(index, count, squares);
+        Color previousPlayer = oppositeColor(sideToMove);
+        bool isLoss = wdl[index] == static_cast<uint8_t>(Wdl::Loss);
+
+        generateUnmoves(pieces, squares, previousPlayer, true, [&](int piece, int from) {
+            Squares previous = squares;
+            previous[piece] = from;
+
+            size_t previousIndex = positionIndex(previous, count, previousPlayer);
+            if(wdl[previousIndex] != WDL_UNDECIDED)
+            {
+                return;
+            }
+
+            if(isLoss)
+            {
+                wdl[previousIndex] = static_cast<uint8_t>(Wdl::Win);
+                decided.push_back(previousIndex);
+            }
+            else if(--remaining[previousIndex] == 0)
+            {
+                wdl[previousIndex] = static_cast<uint8_t>(Wdl::Loss);
+                decided.push_back(previousIndex);
+            }
+        });
+    }
+
+    // Whatever could not be decided can be held forever
+    for (uint8_t& result : wdl) {
+        if(result == WDL_UNDECIDED)
+        {
+            result = static_cast<uint8_t>(Wdl::Draw);
+        }
+    }
+
+    // DTZ is solved the same way, layer by layer, except that captures and pawn moves
+    // count as one ply no matter what comes after them
+    std::vector<std::vector<size_t>> layers(2);
+
+    for (size_t index : decided) {
+        Squares squares = {};
+        Color sideToMove = decodePosition(index, count, squares);
+
+        generateMoves(pieces, squares, sideToMove, moves);
+
+        if(moves.empty())
+        {
+            layers[0].push_back(index);
+            continue;
+        }
+
+        dtz[index] = DTZ_UNKNOWN;
+
+        if(wdl[index] == static_cast<uint8_t>(Wdl::Win))
+        {
+            for (const GeneratorMove& move : moves) {
+                if(move.staysInTable() && pieces[move.piece].type != PieceType::Pawn)
+                {
+                    continue;
+                }
+
+                uint8_t result;
+                if(move.staysInTable())
+                {
+                    Squares after = squares;
+                    after[move.piece] = move.to;
+                    result = wdl[positionIndex(after, count, oppositeColor(sideToMove))];
+                }
+                else
+                {
+                    result = convertedResult(squares, move, sideToMove);
+                }
+
+                if(result == static_cast<uint8_t>(Wdl::Loss))
+                {
+                    dtz[index] = 1;
+                    layers[1].push_back(index);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            int reversibleMoves = 0;
+            for (const GeneratorMove& move : moves) {
+                if(move.staysInTable() && pieces[move.piece].type != PieceType::Pawn)
+                {
+                    ++reversibleMoves;
+                }
+            }
+
+            remaining[index] = reversibleMoves;
+            if(reversibleMoves == 0)
+            {
+                dtz[index] = 1;
+                layers[1].push_back(index);
+            }
+        }
+    }
+
+    for (size_t ply = 0; ply < layers.size(); ++ply) {
+        uint8_t nextDtz = std::min<int>(ply + 1, DTZ_MAX);
+
+        for (size_t index : layers[ply]) {
+            Squares squares = {};
+            Color sideToMove = decodePosition(index, count, squares);
+            Color previousPlayer = oppositeColor(sideToMove);
+            bool isLoss = wdl[index] == static_cast<uint8_t>(Wdl::Loss);
+
+            generateUnmoves(pieces, squares, previousPlayer, false, [&](int piece, int from) {
+                Squares previous = squares;
+                previous[piece] = from;
+
+                size_t previousIndex = positionIndex(previous, count, previousPlayer);
+                if(dtz[previousIndex] != DTZ_UNKNOWN)
+                {
+                    return;
+                }
+
+                bool isPreviousWin = wdl[previousIndex] == static_cast<uint8_t>(Wdl::Win);
+                if(isLoss != isPreviousWin || (!isLoss && --remaining[previousIndex] != 0))
+                {
+                    return;
+                }
+
+                dtz[previousIndex] = nextDtz;
+                if(layers.size() <= ply + 1)
+                {
+                    layers.emplace_back();
+                }
+                layers[ply + 1].push_back(previousIndex);
+            });
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef TABLEBASEGENERATOR_H
+#define TABLEBASEGENERATOR_H
+
+#include "tablebase.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Chess
+{
+
+// Builds the WDL and DTZ files read by Tablebases by retrograde analysis.
+// Tables for up to TABLEBASE_MAX_PIECES pieces are small enough to be built in memory,
+// a four piece table takes 2 * 64^4 bytes per file.
+class TablebaseGenerator
+{
+public:
+    explicit TablebaseGenerator(const QString& directory);
+
+    // Generates the table of a material signature like "KRvK", and first every table
+    // that captures and promotions convert into. Tables generated before are reused.
+    // Returns false for invalid signatures or if the files could not be written.
+    bool generate(const QString& signature);
+private:
+    struct Table
+    {
+        QString signature;
+
+        // In the order the tables are indexed in, see canonicalizeTablebasePlacement
+        QVector<Piece> pieces;
+
+        std::vector<uint8_t> wdl;
+        std::vector<uint8_t> dtz;
+    };
+
+    // Parses a signature into the canonical piece list of its table
+    static std::optional<QVector<Piece>> parseSignature(const QString& signature);
+
+    const Table* generateTable(const QVector<Piece>& pieces);
+    void solve(Table& table) const;
+
+    // WDL of the position after a capture or promotion from the tables generated before
+    uint8_t convertedWdl(const TablebasePlacement& placement, Color sideToMove) const;
+private:
+    QString m_directory;
+    std::map<QString, std::unique_ptr<Table>> m_tables;
+};
+
+}
+
+#endif // TABLEBASEGENERATOR_H
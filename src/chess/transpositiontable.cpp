@@ -0,0 +1,75 @@
+#include "transpositiontable.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Chess;
+
+TranspositionTable::TranspositionTable(size_t entryCount)
+{
+    resize(entryCount);
+}
+
+std::optional<TranspositionEntry> TranspositionTable::probe(uint64_t key) const
+{
+    const TranspositionEntry& entry = m_entries[key & m_indexMask];
+    if(entry.key != key)
+    {
+        return std::nullopt;
+    }
+
+    return entry;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, ScoreBound bound, uint16_t move)
+{
+    TranspositionEntry& entry = m_entries[key & m_indexMask];
+
+    bool isSamePosition = entry.key == key;
+    if(isSamePosition && entry.age == m_age && entry.depth > depth && bound != ScoreBound::Exact)
+    {
+        return;
+    }
+
+    // a bound from a shallower search doesn't know a better move, the old one still orders first
+    if(isSamePosition && move == 0)
+    {
+        move = entry.move;
+    }
+
+    entry.key = key;
+    entry.move = move;
+    entry.score = score;
+    entry.depth = static_cast<int8_t>(depth);
+    entry.bound = bound;
+    entry.age = m_age;
+}
+
+void TranspositionTable::newSearch()
+{
+    m_age++;
+}
+
+void TranspositionTable::resize(size_t entryCount)
+{
+    assert(entryCount > 0);
+
+    size_t powerOfTwo = 1;
+    while(powerOfTwo * 2 <= entryCount)
+    {
+        powerOfTwo *= 2;
+    }
+
+    m_entries.assign(powerOfTwo, TranspositionEntry{});
+    m_indexMask = powerOfTwo - 1;
+}
+
+void TranspositionTable::clear()
+{
+    std::fill(m_entries.begin(), m_entries.end(), TranspositionEntry{});
+}
+
+size_t TranspositionTable::entryCount() const
+{
+    return m_entries.size();
+}
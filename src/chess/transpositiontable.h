@@ -0,0 +1,68 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Chess
+{
+
+enum class ScoreBound : uint8_t
+{
+    Exact,
+
+    // The score is at least this, the search failed high
+    Lower,
+
+    // The score is at most this, no move raised alpha
+    Upper,
+};
+
+struct TranspositionEntry
+{
+    uint64_t key = 0;
+
+    // packMove of the best move, 0 if there is none. No move goes from a square to itself.
+    uint16_t move = 0;
+
+    int score = 0;
+    int8_t depth = 0;
+    ScoreBound bound = ScoreBound::Exact;
+
+    // Search the entry was stored in, see TranspositionTable::newSearch
+    uint8_t age = 0;
+};
+
+// Results of searched positions by Position::hash(), kept from one search to the next.
+// Like the PawnHashTable it isn't synchronized, only one search may use a table at a time.
+class TranspositionTable
+{
+public:
+    static constexpr size_t DEFAULT_ENTRY_COUNT = 1 << 20;
+
+    explicit TranspositionTable(size_t entryCount = DEFAULT_ENTRY_COUNT);
+
+    std::optional<TranspositionEntry> probe(uint64_t key) const;
+
+    // Keeps a deeper result of the same position from the current search, replaces everything else
+    void store(uint64_t key, int depth, int score, ScoreBound bound, uint16_t move);
+
+    // Entries of earlier searches are still used, but are the first to be replaced
+    void newSearch();
+
+    // Rounds the entry count down to a power of two and clears the table
+    void resize(size_t entryCount);
+    void clear();
+
+    size_t entryCount() const;
+private:
+    std::vector<TranspositionEntry> m_entries;
+    uint64_t m_indexMask = 0;
+
+    uint8_t m_age = 0;
+};
+
+}
+
+#endif // TRANSPOSITIONTABLE_H
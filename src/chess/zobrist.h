@@ -0,0 +1,24 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "chess.h"
+
+#include <cstdint>
+
+namespace Chess
+{
+
+// The keys of the Polyglot opening book format for Zobrist hashing:
+// 768 piece-square keys, 4 castling keys, 8 en passant file keys and 1 side to move key.
+static constexpr size_t ZOBRIST_KEY_COUNT = 781;
+
+const std::array<uint64_t, ZOBRIST_KEY_COUNT>& zobristKeys();
+
+uint64_t zobristPieceKey(Piece piece, QPoint pos);
+uint64_t zobristCastlingKey(uint8_t castlingRights);
+uint64_t zobristEnPassantKey(int file);
+uint64_t zobristWhiteToMoveKey();
+
+}
+
+#endif // ZOBRIST_H
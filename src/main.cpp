@@ -1,6 +1,7 @@
+#include "project_hub/pluginprojects.h"
 #include "project_hub/projecthub.h"
-
-#include "chess/chess.h"
+#include "project_hub/projectworker.h"
+#include "project_hub/tracerecorder.h"
 
 #include <QApplication>
 #include <QPushButton>
@@ -10,9 +11,27 @@
 
 int main(int argc, char *argv[])
 {
+    auto applicationStart = TraceRecorder::Clock::now();
 
     QApplication app(argc, argv);
 
+    // The hub starts itself again to run projects out of process
+    if(argc > 1 && qstrcmp(argv[1], PROJECT_WORKER_ARGUMENT) == 0)
+    {
+        return runProjectWorker(app);
+    }
+
+    TraceRecorder::instance().addSpan("construct application", applicationStart, TraceRecorder::Clock::now());
+
+    // PROJECT_HUB_TRACE=trace.json writes the recorded spans there on exit
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, []() {
+        TraceRecorder& recorder = TraceRecorder::instance();
+        if(recorder.isEnabled() && !recorder.writeChromeTrace(TraceRecorder::outputPath()))
+        {
+            qWarning("Could not write the trace to %s", qPrintable(TraceRecorder::outputPath()));
+        }
+    });
+
     QApplication::setStyle("Fusion");
 
     QVector<Project> projects = {
@@ -42,19 +61,14 @@ int main(int argc, char *argv[])
                 window->show();
             },
         },
-        Project
-        {
-            .type = ProjectType::QtWidgets,
-            .title = "Chess Game",
-            .shortDescription = "A networked multiplayer chess game.",
-            .description = "A networked multiplayer chess game.",
-            .launch = []() {
-                auto *chessWindow = new Chess::MainWindow();
-                chessWindow->show();
-            },
-        },
     };
 
+    // Every other project is a plugin, loaded only once it is launched
+    {
+        TraceSpan span("discover plugins");
+        projects += discoverPluginProjects(QApplication::applicationDirPath() + "/projects");
+    }
+
     ProjectHub projectHub(projects);
     projectHub.setWindowTitle("Project Hub");
     projectHub.show();
@@ -0,0 +1,9 @@
+#include "chessplugin.h"
+
+#include "chess/chess.h"
+
+void ChessPlugin::launch()
+{
+    auto *chessWindow = new Chess::MainWindow();
+    chessWindow->show();
+}
@@ -0,0 +1,18 @@
+#ifndef CHESSPLUGIN_H
+#define CHESSPLUGIN_H
+
+#include "project_hub/projectplugin.h"
+
+#include <QObject>
+
+class ChessPlugin : public QObject, public ProjectPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID ProjectPlugin_iid FILE "chessplugin.json")
+    Q_INTERFACES(ProjectPlugin)
+
+public:
+    void launch() override;
+};
+
+#endif // CHESSPLUGIN_H
@@ -0,0 +1,149 @@
+#include "bannercache.h"
+
+#include <QCryptographicHash>
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QTimer>
+
+#include <algorithm>
+
+// Decoding is mostly waiting for the disk, a second thread keeps a slow file from holding up the others
+static constexpr int LOAD_THREAD_COUNT = 2;
+
+BannerCache::BannerCache(const QString &cacheDirectory, int memoryLimitKb, QObject *parent)
+    : QObject(parent),
+    m_cacheDirectory(cacheDirectory),
+    m_images(memoryLimitKb)
+{
+    m_loadPool.setMaxThreadCount(LOAD_THREAD_COUNT);
+}
+
+BannerCache::~BannerCache()
+{
+    m_loadPool.waitForDone();
+}
+
+std::optional<QImage> BannerCache::cachedBanner(const QString &path, const QSize &size)
+{
+    // Looking an image up makes it the most recently used one
+    QImage* image = m_images.object(memoryKey(path, size));
+    if(!image)
+    {
+        return std::nullopt;
+    }
+
+    return *image;
+}
+
+void BannerCache::requestBanner(const QString &path, const QSize &size)
+{
+    QString key = memoryKey(path, size);
+
+    if(std::optional<QImage> image = cachedBanner(path, size))
+    {
+        // Emitted like a loaded banner would be, after the caller returned
+        QTimer::singleShot(0, this, [this, path, size, image = *image]() {
+            emit bannerLoaded(path, size, image);
+        });
+        return;
+    }
+
+    if(m_loadingKeys.contains(key))
+    {
+        return;
+    }
+
+    m_loadingKeys.insert(key);
+
+    m_loadPool.start([this, path, size, key, cacheDirectory = m_cacheDirectory]() {
+        QImage image = loadBanner(path, size, cacheDirectory);
+
+        QMetaObject::invokeMethod(this, [this, path, size, key, image]() {
+            m_loadingKeys.remove(key);
+
+            // Failures aren't cached, the file may show up later
+            if(!image.isNull())
+            {
+                m_images.insert(key, new QImage(image), std::max<qsizetype>(1, image.sizeInBytes() / 1024));
+            }
+
+            emit bannerLoaded(path, size, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+QImage BannerCache::loadBanner(const QString &path, const QSize &size, const QString &cacheDirectory)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return QImage();
+    }
+
+    // Reading the file is cheap next to decoding it, its hash tells whether the scaled banner is still current
+    QByteArray content = file.readAll();
+
+    QString cachePath;
+    if(!cacheDirectory.isEmpty())
+    {
+        cachePath = QDir(cacheDirectory).filePath(diskCacheKey(content, size));
+
+        QImage cached(cachePath);
+        if(!cached.isNull())
+        {
+            return cached;
+        }
+    }
+
+    QBuffer buffer(&content);
+    QImageReader reader(&buffer);
+
+    // Formats that support it, like JPEG, decode at the reduced size right away
+    QSize originalSize = reader.size();
+    if(originalSize.isValid())
+    {
+        reader.setScaledSize(originalSize.scaled(size, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if(image.isNull())
+    {
+        return QImage();
+    }
+
+    if(image.width() > size.width() || image.height() > size.height())
+    {
+        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    if(!cachePath.isEmpty() && QDir().mkpath(cacheDirectory))
+    {
+        // Another hub may write the same banner at the same time, each writes a whole file
+        QSaveFile cacheFile(cachePath);
+        if(cacheFile.open(QIODevice::WriteOnly) && image.save(&cacheFile, "PNG"))
+        {
+            cacheFile.commit();
+        }
+    }
+
+    return image;
+}
+
+QString BannerCache::diskCacheKey(const QByteArray &content, const QSize &size)
+{
+    QByteArray hash = QCryptographicHash::hash(content, QCryptographicHash::Sha1).toHex();
+    return QString("%1-%2x%3.png").arg(QString::fromLatin1(hash)).arg(size.width()).arg(size.height());
+}
+
+QString BannerCache::cacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+QString BannerCache::memoryKey(const QString &path, const QSize &size)
+{
+    return QString("%1|%2x%3").arg(path).arg(size.width()).arg(size.height());
+}
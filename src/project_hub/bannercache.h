@@ -0,0 +1,59 @@
+#ifndef BANNERCACHE_H
+#define BANNERCACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include <optional>
+
+// Banner images of the projects, decoded on a thread of their own and scaled down once to the size they
+// are shown at. The scaled images are kept in memory, least recently used first out, and on disk under
+// the hash of the original's content, so a changed banner is never mistaken for the old one.
+class BannerCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_MEMORY_LIMIT_KB = 32 * 1024;
+
+    // An empty cache directory keeps the banners in memory only
+    explicit BannerCache(const QString& cacheDirectory, int memoryLimitKb = DEFAULT_MEMORY_LIMIT_KB, QObject *parent = nullptr);
+
+    // Waits for the loading banners, they would be posted to a deleted cache
+    ~BannerCache() override;
+
+    // Never blocks, a banner that isn't in memory yet has to be requested
+    std::optional<QImage> cachedBanner(const QString& path, const QSize& size);
+
+    // Loads the banner in the background and emits bannerLoaded, right away if it is in memory
+    void requestBanner(const QString& path, const QSize& size);
+
+    // The work of requestBanner: the image from the disk cache or the original scaled to fit the size,
+    // which is written to the disk cache then. A null image if the original can't be read.
+    static QImage loadBanner(const QString& path, const QSize& size, const QString& cacheDirectory);
+
+    // File name of the scaled banner in the disk cache
+    static QString diskCacheKey(const QByteArray& content, const QSize& size);
+
+    QString cacheDirectory() const;
+
+signals:
+    // A null image if the banner couldn't be loaded
+    void bannerLoaded(const QString& path, const QSize& size, const QImage& image);
+
+private:
+    static QString memoryKey(const QString& path, const QSize& size);
+
+    QString m_cacheDirectory;
+
+    // The cost of an image is its size in KB
+    QCache<QString, QImage> m_images;
+
+    QSet<QString> m_loadingKeys;
+    QThreadPool m_loadPool;
+};
+
+#endif // BANNERCACHE_H
@@ -0,0 +1,70 @@
+#include "pluginprojects.h"
+#include "projectplugin.h"
+
+#include <QDir>
+#include <QJsonObject>
+#include <QLibrary>
+#include <QMessageBox>
+#include <QPluginLoader>
+
+#include <memory>
+
+QVector<Project> discoverPluginProjects(const QString &directory)
+{
+    QVector<Project> projects;
+
+    QDir pluginDirectory(directory);
+    for (const QString& fileName : pluginDirectory.entryList(QDir::Files, QDir::Name)) {
+        if(!QLibrary::isLibrary(fileName))
+        {
+            continue;
+        }
+
+        // Reads the metadata from the file, the library isn't loaded
+        auto loader = std::make_shared<QPluginLoader>(pluginDirectory.absoluteFilePath(fileName));
+
+        QJsonObject pluginMetaData = loader->metaData();
+        if(pluginMetaData.value("IID").toString() != ProjectPlugin_iid)
+        {
+            continue;
+        }
+
+        QJsonObject metaData = pluginMetaData.value("MetaData").toObject();
+
+        Project project;
+        project.type = metaData.value("type").toString() == "qml" ? ProjectType::Qml : ProjectType::QtWidgets;
+        project.title = metaData.value("title").toString();
+        project.shortDescription = metaData.value("shortDescription").toString();
+        project.description = metaData.value("description").toString();
+        project.startDate = QDate::fromString(metaData.value("startDate").toString(), Qt::ISODate);
+        project.endDate = QDate::fromString(metaData.value("endDate").toString(), Qt::ISODate);
+        project.pluginPath = loader->fileName();
+
+        // The banner is a file next to the plugin
+        QString banner = metaData.value("banner").toString();
+        if(!banner.isEmpty())
+        {
+            project.bannerPath = pluginDirectory.absoluteFilePath(banner);
+        }
+
+        if(project.title.isEmpty())
+        {
+            continue;
+        }
+
+        project.launch = [loader, title = project.title]() {
+            auto plugin = qobject_cast<ProjectPlugin*>(loader->instance());
+            if(!plugin)
+            {
+                QMessageBox::warning(nullptr, "Launch Failed", QString("%1 could not be loaded:\n%2").arg(title, loader->errorString()));
+                return;
+            }
+
+            plugin->launch();
+        };
+
+        projects.append(project);
+    }
+
+    return projects;
+}
@@ -0,0 +1,27 @@
+#ifndef PLUGINPROJECTS_H
+#define PLUGINPROJECTS_H
+
+#include "project.h"
+
+#include <QVector>
+
+// The projects of the ProjectPlugin libraries in the directory, sorted by file name. Only the metadata of the
+// plugins is read, a library is loaded the first time its project is launched and stays loaded from then on.
+// Files that aren't project plugins or lack a title are skipped.
+//
+// The metadata is the JSON file given to Q_PLUGIN_METADATA:
+// {
+//     "type": "widgets" or "qml",
+//     "title": "...",
+//     "shortDescription": "...",
+//     "description": "...",
+//     "startDate": "2024-01-31",
+//     "endDate": "2024-02-29",
+//     "banner": "chess/banner.png"
+// }
+//
+// The banner is optional and relative to the plugin directory. Projects without one, like the chess
+// plugin so far, show the placeholder.
+QVector<Project> discoverPluginProjects(const QString& directory);
+
+#endif // PLUGINPROJECTS_H
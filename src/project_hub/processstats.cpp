@@ -0,0 +1,55 @@
+#include "processstats.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+static std::optional<QByteArray> readProcFile(qint64 processId, const char* name)
+{
+    QFile file(QString("/proc/%1/%2").arg(processId).arg(name));
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return std::nullopt;
+    }
+
+    // The size of proc files is always 0, readAll reads until the end anyway
+    return file.readAll();
+}
+
+std::optional<ProcessStats> readProcessStats(qint64 processId)
+{
+#ifdef Q_OS_LINUX
+    std::optional<QByteArray> stat = readProcFile(processId, "stat");
+    std::optional<QByteArray> statm = readProcFile(processId, "statm");
+    if(!stat || !statm)
+    {
+        return std::nullopt;
+    }
+
+    // The command name in parentheses may contain spaces, the fields after it don't.
+    // utime and stime are the 14th and 15th field, the 12th and 13th after the name.
+    int nameEnd = stat->lastIndexOf(')');
+    QList<QByteArray> fields = stat->mid(nameEnd + 2).split(' ');
+    QList<QByteArray> memoryFields = statm->split(' ');
+    if(nameEnd < 0 || fields.size() < 13 || memoryFields.size() < 2)
+    {
+        return std::nullopt;
+    }
+
+    qint64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+    qint64 cpuTicks = fields[11].toLongLong() + fields[12].toLongLong();
+
+    ProcessStats stats;
+    stats.cpuTimeMs = cpuTicks * 1000 / ticksPerSecond;
+    stats.residentBytes = memoryFields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+
+    return stats;
+#else
+    Q_UNUSED(processId);
+    return std::nullopt;
+#endif
+}
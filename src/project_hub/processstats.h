@@ -0,0 +1,19 @@
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+#include <QtGlobal>
+
+#include <optional>
+
+struct ProcessStats
+{
+    // User and system time the process used so far
+    qint64 cpuTimeMs = 0;
+
+    qint64 residentBytes = 0;
+};
+
+// Read from /proc on Linux, nothing on other systems or for processes that don't exist (anymore)
+std::optional<ProcessStats> readProcessStats(qint64 processId);
+
+#endif // PROCESSSTATS_H
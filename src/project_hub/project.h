@@ -0,0 +1,36 @@
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include <QDate>
+#include <QString>
+
+#include <functional>
+
+enum class ProjectType
+{
+    QtWidgets,
+    Qml,
+};
+
+struct Project
+{
+    ProjectType type;
+
+    QString title;
+    QString shortDescription;
+    QString description;
+
+    QDate startDate;
+    QDate endDate;
+
+    // Image shown in the details, none if empty
+    QString bannerPath;
+
+    std::function<void()> launch;
+
+    // Library of a ProjectPlugin, empty for projects built into the hub.
+    // Only plugin projects can be launched in a worker process.
+    QString pluginPath;
+};
+
+#endif // PROJECT_H
@@ -1,31 +1,121 @@
 #include "projecthub.h"
+#include "bannercache.h"
+#include "projectlistmodel.h"
+#include "projectsearchindex.h"
+#include "projectworkerpool.h"
 
 #include <QGroupBox>
+#include <QGuiApplication>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
+#include <QMessageBox>
 #include <QPushButton>
 #include <QSplitter>
+#include <QStandardPaths>
 #include <QVBoxLayout>
+#include <QWindow>
+
+// Typing faster than this doesn't search for every letter
+static constexpr int SEARCH_DEBOUNCE_MS = 150;
+
+// Catalogs this large are searched off the UI thread, smaller ones are done before a thread would have started
+static constexpr int BACKGROUND_SEARCH_PROJECT_COUNT = 2000;
+
+// A project that hasn't shown a window by then isn't traced anymore
+static constexpr int LAUNCH_TRACE_TIMEOUT_MS = 60000;
+
+// Waits for the first of the windows to be exposed and records the launch span then
+class LaunchTraceWatcher : public QObject
+{
+public:
+    LaunchTraceWatcher(const QString& title, TraceRecorder::Clock::time_point launchStart, const QList<QWindow*>& windows, QObject *parent)
+        : QObject(parent),
+        m_title(title),
+        m_launchStart(launchStart)
+    {
+        for (QWindow* window : windows) {
+            window->installEventFilter(this);
+        }
+
+        QTimer::singleShot(LAUNCH_TRACE_TIMEOUT_MS, this, &QObject::deleteLater);
+    }
+
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if(!m_isDone && event->type() == QEvent::Expose && static_cast<QWindow*>(watched)->isExposed())
+        {
+            TraceRecorder::instance().addSpan("launch until exposed", m_launchStart, TraceRecorder::Clock::now(), m_title);
+
+            m_isDone = true;
+            deleteLater();
+        }
+
+        return false;
+    }
+private:
+    QString m_title;
+    TraceRecorder::Clock::time_point m_launchStart;
+    bool m_isDone = false;
+};
 
 ProjectHub::ProjectHub(QVector<Project> projects, QWidget *parent)
     : m_projects(std::move(projects)),
     QMainWindow{parent}
 {
+    TraceSpan span("construct hub");
+
+    m_searchIndex = std::make_shared<const ProjectSearchIndex>(m_projects);
+    m_searchPool.setMaxThreadCount(1);
+
+    // One warm worker hides the startup of a process, projects are rarely launched in quick succession
+    m_workerPool = new ProjectWorkerPool(QCoreApplication::applicationFilePath(), 1, this);
+    connect(m_workerPool, &ProjectWorkerPool::launchFailed, this, &ProjectHub::onLaunchFailed);
+
+    // Banners are decoded off the UI thread, so selecting a project never waits for an image
+    m_bannerCache = new BannerCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/banners", BannerCache::DEFAULT_MEMORY_LIMIT_KB, this);
+    connect(m_bannerCache, &BannerCache::bannerLoaded, this, &ProjectHub::onBannerLoaded);
+
     setupUI();
 
+    connect(m_workerPool, &ProjectWorkerPool::processesChanged, this, &ProjectHub::updateProcessInfo);
+
     setFixedSize(1280, 720);
+
+    m_constructedAt = TraceRecorder::Clock::now();
+    TraceRecorder::instance().addSpan("process start until hub constructed", TraceRecorder::processStart(), m_constructedAt);
+}
+
+ProjectHub::~ProjectHub()
+{
+    m_searchPool.waitForDone();
+}
+
+void ProjectHub::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+
+    if(!m_hasPainted)
+    {
+        m_hasPainted = true;
+
+        TraceRecorder& recorder = TraceRecorder::instance();
+        auto now = TraceRecorder::Clock::now();
+
+        recorder.addSpan("hub constructed until first paint", m_constructedAt, now);
+        recorder.addSpan("process start until first paint", TraceRecorder::processStart(), now);
+    }
 }
 
 void ProjectHub::onProjectSelected()
 {
-    QListWidgetItem *selectedItem = m_projectListWidget->currentItem();
-    if(!selectedItem)
+    QModelIndexList selectedRows = m_projectListView->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty())
     {
         return;
     }
 
-    m_selectedProjectIndex = selectedItem->data(Qt::UserRole).value<int>();
+    m_selectedProjectIndex = selectedRows.first().data(ProjectListModel::ProjectIndexRole).toInt();
 
     Project* project = selectedProject();
 
@@ -36,6 +126,80 @@ void ProjectHub::onProjectSelected()
 
     m_titleLabel->setText(project->title);
     m_descriptionLabel->setText(project->description);
+
+    updateBanner();
+
+    // Built-in projects have no plugin a worker could load
+    m_separateProcessCheckBox->setEnabled(!project->pluginPath.isEmpty());
+
+    updateProcessInfo();
+}
+
+void ProjectHub::updateBanner()
+{
+    Project* project = selectedProject();
+    if(!project || project->bannerPath.isEmpty())
+    {
+        m_bannerLabel->clear();
+        return;
+    }
+
+    QSize size = m_bannerLabel->contentsRect().size();
+    if(std::optional<QImage> image = m_bannerCache->cachedBanner(project->bannerPath, size))
+    {
+        m_bannerLabel->setPixmap(QPixmap::fromImage(*image));
+        return;
+    }
+
+    // The grey placeholder shows until the banner is loaded
+    m_bannerLabel->clear();
+    m_bannerCache->requestBanner(project->bannerPath, size);
+}
+
+void ProjectHub::onBannerLoaded(const QString &path, const QSize &size, const QImage &image)
+{
+    // Another project may have been selected while it loaded
+    Project* project = selectedProject();
+    if(!project || project->bannerPath != path || m_bannerLabel->contentsRect().size() != size || image.isNull())
+    {
+        return;
+    }
+
+    m_bannerLabel->setPixmap(QPixmap::fromImage(image));
+}
+
+void ProjectHub::updateProcessInfo()
+{
+    Project* project = selectedProject();
+    if(!project || project->pluginPath.isEmpty())
+    {
+        m_processLabel->clear();
+        return;
+    }
+
+    std::optional<ProjectProcess> process = m_workerPool->latestProcess(project->pluginPath);
+    if(!process)
+    {
+        m_processLabel->clear();
+        return;
+    }
+
+    QString text = QString("Process %1: %2").arg(process->processId).arg(projectProcessStateName(process->state));
+    if(process->state == ProjectProcessState::Running)
+    {
+        text += QString(", CPU %1%, Memory %2 MB").arg(process->cpuPercent, 0, 'f', 1).arg(process->residentBytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    else if(process->state == ProjectProcessState::Failed)
+    {
+        text += ", " + process->error;
+    }
+
+    m_processLabel->setText(text);
+}
+
+void ProjectHub::onLaunchFailed(const QString &title, const QString &error)
+{
+    QMessageBox::warning(this, "Launch Failed", QString("%1 could not be launched:\n%2").arg(title, error));
 }
 
 void ProjectHub::launchSelectedProject()
@@ -46,20 +210,80 @@ void ProjectHub::launchSelectedProject()
         return;
     }
 
-    project->launch();
+    if(m_separateProcessCheckBox->isChecked() && !project->pluginPath.isEmpty())
+    {
+        // The pool records the span until the project's window is exposed once the worker reports it
+        TraceSpan span("launch in worker", project->title);
+        m_workerPool->launch(project->title, project->pluginPath);
+        return;
+    }
+
+    if(!TraceRecorder::instance().isEnabled())
+    {
+        project->launch();
+        return;
+    }
+
+    auto launchStart = TraceRecorder::Clock::now();
+    QList<QWindow*> windowsBefore = QGuiApplication::topLevelWindows();
+
+    {
+        TraceSpan span("launch call", project->title);
+        project->launch();
+    }
+
+    traceLaunchedWindow(project->title, launchStart, windowsBefore);
+}
+
+void ProjectHub::traceLaunchedWindow(const QString &title, TraceRecorder::Clock::time_point launchStart, const QList<QWindow*> &windowsBefore)
+{
+    QList<QWindow*> newWindows;
+    for (QWindow* window : QGuiApplication::topLevelWindows()) {
+        if(!windowsBefore.contains(window))
+        {
+            newWindows.append(window);
+        }
+    }
+
+    if(newWindows.isEmpty())
+    {
+        return;
+    }
+
+    new LaunchTraceWatcher(title, launchStart, newWindows, this);
 }
 
 void ProjectHub::filterProjects(const QString &text)
 {
-    for (int i = 0; i < m_projectListWidget->count(); ++i) {
-        QListWidgetItem *item = m_projectListWidget->item(i);
-        int index = item->data(Qt::UserRole).value<int>();
+    m_searchText = text;
+    m_searchTimer->start();
+}
 
-        Project& project = m_projects[index];
+void ProjectHub::runSearch()
+{
+    uint64_t generation = ++m_searchGeneration;
 
-        item->setHidden(!project.title.contains(text, Qt::CaseInsensitive));
+    if(m_searchIndex->projectCount() < BACKGROUND_SEARCH_PROJECT_COUNT)
+    {
+        showSearchResults(m_searchIndex->search(m_searchText));
+        return;
     }
 
+    m_searchPool.start([this, index = m_searchIndex, text = m_searchText, generation]() {
+        QVector<int> projectIndices = index->search(text);
+
+        QMetaObject::invokeMethod(this, [this, projectIndices, generation]() {
+            if(generation == m_searchGeneration)
+            {
+                showSearchResults(projectIndices);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ProjectHub::showSearchResults(const QVector<int> &projectIndices)
+{
+    m_projectListModel->setProjectIndices(projectIndices);
 }
 
 Project *ProjectHub::selectedProject()
@@ -77,31 +301,33 @@ void ProjectHub::setupUI()
     // Projects
     auto projectsWidget = new QGroupBox("Projects");
     auto projectsLayout = new QVBoxLayout(projectsWidget);
-    m_projectListWidget = new QListWidget();
-    connect(m_projectListWidget, &QListWidget::itemSelectionChanged, this, &ProjectHub::onProjectSelected);
+    m_projectListModel = new ProjectListModel(&m_projects, this);
+
+    // Tiles are painted by the delegate for the visible rows only, uniform sizes spare the view
+    // from asking every row for its size
+    m_projectListView = new QListView();
+    m_projectListView->setUniformItemSizes(true);
+    m_projectListView->setItemDelegate(new ProjectTileDelegate(m_projectListView));
+    m_projectListView->setModel(m_projectListModel);
+    connect(m_projectListView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &ProjectHub::onProjectSelected);
 
     auto projectSearchLineEdit = new QLineEdit();
     projectSearchLineEdit->setPlaceholderText("Search...");
     connect(projectSearchLineEdit, &QLineEdit::textChanged, this, &ProjectHub::filterProjects);
-    projectsLayout->addWidget(projectSearchLineEdit);
-    projectsLayout->addWidget(m_projectListWidget);
-    
-    for (size_t i = 0; i < m_projects.count(); ++i) {
-
-        auto projectItem = new QListWidgetItem(m_projectListWidget);
-        projectItem->setData(Qt::UserRole, QVariant::fromValue(i));
 
-        auto projectListTile = new ProjectListTile(m_projects[i]);
-
-        projectItem->setSizeHint(projectListTile->sizeHint());
-
-        m_projectListWidget->setItemWidget(projectItem, projectListTile);
-    }
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(SEARCH_DEBOUNCE_MS);
+    connect(m_searchTimer, &QTimer::timeout, this, &ProjectHub::runSearch);
+    projectsLayout->addWidget(projectSearchLineEdit);
+    projectsLayout->addWidget(m_projectListView);
 
     // Details
     auto detailsWidget = new QGroupBox("Details");
-    auto detailsBanner = new QWidget();
-    detailsBanner->setStyleSheet("background-color: grey");
+    m_bannerLabel = new QLabel();
+    m_bannerLabel->setAlignment(Qt::AlignCenter);
+    m_bannerLabel->setMinimumSize(1, 1);
+    m_bannerLabel->setStyleSheet("background-color: grey");
 
     QFont titleFont;
     titleFont.setBold(true);
@@ -113,7 +339,7 @@ void ProjectHub::setupUI()
     descriptionFont.setPointSize(10);
     m_descriptionLabel->setFont(descriptionFont);
     auto detailsLayout = new QVBoxLayout(detailsWidget);
-    detailsLayout->addWidget(detailsBanner, 3);
+    detailsLayout->addWidget(m_bannerLabel, 3);
 
     auto detailsInfoLayout = new QVBoxLayout();
     detailsLayout->addLayout(detailsInfoLayout, 2);
@@ -122,6 +348,15 @@ void ProjectHub::setupUI()
     detailsInfoLayout->addWidget(m_titleLabel);
     detailsInfoLayout->addWidget(m_descriptionLabel);
 
+    m_processLabel = new QLabel("");
+    m_processLabel->setFont(descriptionFont);
+    detailsInfoLayout->addWidget(m_processLabel);
+
+    m_separateProcessCheckBox = new QCheckBox("Run in a separate process");
+    m_separateProcessCheckBox->setChecked(true);
+    m_separateProcessCheckBox->setEnabled(false);
+    detailsLayout->addWidget(m_separateProcessCheckBox);
+
     QFont launchFont;
     launchFont.setBold(true);
     launchFont.setPointSize(12);
@@ -141,38 +376,3 @@ void ProjectHub::setupUI()
 
     setCentralWidget(centralWidget);
 }
-
-ProjectListTile::ProjectListTile(const Project &project, QWidget *parent)
-    : QWidget(parent)
-{
-    auto outerLayout = new QHBoxLayout(this);
-
-    auto icon = new QLabel(project.type == ProjectType::Qml ? "QML" : "Widgets");
-
-    icon->setStyleSheet("color: green");
-
-    QFont iconFont;
-    iconFont.setBold(true);
-    iconFont.setPointSize(project.type == ProjectType::Qml ? 14 : 9);
-
-    icon->setFont(iconFont);
-    outerLayout->addWidget(icon, 2, Qt::AlignCenter);
-
-    auto innerLayout = new QVBoxLayout();
-    outerLayout->addLayout(innerLayout, 8);
-
-    innerLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-
-    QFont titleFont;
-    titleFont.setBold(true);
-    titleFont.setPointSize(12);
-    auto projectTitleLabel = new QLabel(project.title);
-    projectTitleLabel->setFont(titleFont);
-    innerLayout->addWidget(projectTitleLabel);
-
-    QFont subtitleFont;
-    subtitleFont.setItalic(true);
-    auto projectSubtitleLabel = new QLabel(project.shortDescription);
-    projectSubtitleLabel->setFont(subtitleFont);
-    innerLayout->addWidget(projectSubtitleLabel);
-}
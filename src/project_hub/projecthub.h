@@ -1,40 +1,24 @@
 #ifndef PROJECTHUB_H
 #define PROJECTHUB_H
 
-#include <QListWidget>
+#include "project.h"
+#include "tracerecorder.h"
+
+#include <QCheckBox>
+#include <QImage>
+#include <QListView>
 #include <QMainWindow>
-#include <QDate>
 #include <QLabel>
+#include <QThreadPool>
+#include <QTimer>
 
-#include <functional>
-
-enum class ProjectType
-{
-    QtWidgets,
-    Qml,
-};
-
-struct Project
-{
-    ProjectType type;
-
-    QString title;
-    QString shortDescription;
-    QString description;
+#include <memory>
 
-    QDate startDate;
-    QDate endDate;
-
-    std::function<void()> launch;
-};
-
-class ProjectListTile : public QWidget
-{
-    Q_OBJECT
-
-public:
-    explicit ProjectListTile(const Project& project, QWidget *parent = nullptr);
-};
+class BannerCache;
+class ProjectListModel;
+class ProjectSearchIndex;
+class ProjectWorkerPool;
+class QWindow;
 
 class ProjectHub : public QMainWindow
 {
@@ -43,25 +27,69 @@ class ProjectHub : public QMainWindow
 public:
     explicit ProjectHub(QVector<Project> projects, QWidget *parent = nullptr);
 
+    // Waits for a running search, it would post its results to a deleted window
+    ~ProjectHub() override;
+
 signals:
 
+protected:
+    // Records the first paint of the hub for the startup trace
+    void paintEvent(QPaintEvent* event) override;
+
 private slots:
     void onProjectSelected();
     void launchSelectedProject();
 
+    // Searches once the text stopped changing for a moment
     void filterProjects(const QString& text);
+
+    // Shows the state, CPU and memory usage of the selected project's worker process
+    void updateProcessInfo();
+    void onLaunchFailed(const QString& title, const QString& error);
+
+    void onBannerLoaded(const QString& path, const QSize& size, const QImage& image);
 private:
     Project *selectedProject();;
     void setupUI();
+
+    // Shows the banner of the selected project if it is cached, otherwise requests it
+    void updateBanner();
+
+    // Large catalogs are searched on a thread of their own, the results of outdated searches are dropped
+    void runSearch();
+    void showSearchResults(const QVector<int>& projectIndices);
+
+    // Records the time from the launch click until the first window of the project is shown
+    void traceLaunchedWindow(const QString& title, TraceRecorder::Clock::time_point launchStart, const QList<QWindow*>& windowsBefore);
 private:
     QVector<Project> m_projects;
 
+    QLabel *m_bannerLabel;
     QLabel *m_titleLabel;
     QLabel *m_descriptionLabel;
+    QLabel *m_processLabel;
+    QCheckBox *m_separateProcessCheckBox;
+
+    BannerCache *m_bannerCache;
+
+    // Plugin projects may run in worker processes, so they can't stall or crash the hub
+    ProjectWorkerPool *m_workerPool;
 
     int m_selectedProjectIndex = -1;
 
-    QListWidget *m_projectListWidget;
+    ProjectListModel *m_projectListModel;
+    QListView *m_projectListView;
+
+    // Shared with the running search, so a new index may replace it any time
+    std::shared_ptr<const ProjectSearchIndex> m_searchIndex;
+    QThreadPool m_searchPool;
+
+    QTimer *m_searchTimer;
+    QString m_searchText;
+    uint64_t m_searchGeneration = 0;
+
+    TraceRecorder::Clock::time_point m_constructedAt;
+    bool m_hasPainted = false;
 };
 
 #endif // PROJECTHUB_H
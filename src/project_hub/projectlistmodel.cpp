@@ -0,0 +1,136 @@
+#include "projectlistmodel.h"
+
+#include <QApplication>
+#include <QPainter>
+
+#include <algorithm>
+
+// Space around and between the parts of a tile, like the layouts of a widget would leave
+static constexpr int TILE_MARGIN = 9;
+static constexpr int TILE_SPACING = 6;
+
+// Share of the tile width taken by the badge, the text gets the rest
+static constexpr qreal BADGE_WIDTH_RATIO = 0.2;
+
+ProjectListModel::ProjectListModel(const QVector<Project> *projects, QObject *parent)
+    : QAbstractListModel(parent),
+    m_projects(projects)
+{
+    m_projectIndices.reserve(projects->count());
+    for (int i = 0; i < projects->count(); ++i) {
+        m_projectIndices.append(i);
+    }
+}
+
+void ProjectListModel::setProjectIndices(const QVector<int> &projectIndices)
+{
+    beginResetModel();
+    m_projectIndices = projectIndices;
+    endResetModel();
+}
+
+int ProjectListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_projectIndices.count();
+}
+
+QVariant ProjectListModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row() >= m_projectIndices.count())
+    {
+        return QVariant();
+    }
+
+    int projectIndex = m_projectIndices[index.row()];
+    const Project& project = (*m_projects)[projectIndex];
+
+    switch(role)
+    {
+    case Qt::DisplayRole:
+        return project.title;
+    case Qt::ToolTipRole:
+        return project.description;
+    case ShortDescriptionRole:
+        return project.shortDescription;
+    case TypeRole:
+        return static_cast<int>(project.type);
+    case ProjectIndexRole:
+        return projectIndex;
+    }
+
+    return QVariant();
+}
+
+ProjectTileDelegate::ProjectTileDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+    m_qmlBadgeFont.setBold(true);
+    m_qmlBadgeFont.setPointSize(14);
+
+    m_widgetsBadgeFont.setBold(true);
+    m_widgetsBadgeFont.setPointSize(9);
+
+    m_titleFont.setBold(true);
+    m_titleFont.setPointSize(12);
+
+    m_subtitleFont.setItalic(true);
+
+    // Every tile is as high as two lines of text, measured once
+    int textHeight = QFontMetrics(m_titleFont).height() + TILE_SPACING + QFontMetrics(m_subtitleFont).height();
+    int badgeHeight = QFontMetrics(m_qmlBadgeFont).height();
+
+    m_tileSize = QSize(200, std::max(textHeight, badgeHeight) + 2 * TILE_MARGIN);
+}
+
+void ProjectTileDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem panelOption = option;
+    initStyleOption(&panelOption, index);
+
+    // Only the selection and hover background, the text is drawn below
+    panelOption.text.clear();
+
+    const QWidget* widget = option.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &panelOption, painter, widget);
+
+    QRect contentRect = option.rect.adjusted(TILE_MARGIN, TILE_MARGIN, -TILE_MARGIN, -TILE_MARGIN);
+
+    int badgeWidth = qRound(contentRect.width() * BADGE_WIDTH_RATIO);
+    QRect badgeRect(contentRect.left(), contentRect.top(), badgeWidth, contentRect.height());
+    QRect textRect = contentRect.adjusted(badgeWidth + TILE_SPACING, 0, 0, 0);
+
+    bool isQml = static_cast<ProjectType>(index.data(ProjectListModel::TypeRole).toInt()) == ProjectType::Qml;
+    bool isSelected = option.state & QStyle::State_Selected;
+
+    painter->save();
+
+    painter->setFont(isQml ? m_qmlBadgeFont : m_widgetsBadgeFont);
+    painter->setPen(QColor("green"));
+    painter->drawText(badgeRect, Qt::AlignCenter, isQml ? "QML" : "Widgets");
+
+    painter->setPen(option.palette.color(isSelected ? QPalette::HighlightedText : QPalette::Text));
+
+    QFontMetrics titleMetrics(m_titleFont);
+    QString title = titleMetrics.elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, textRect.width());
+
+    painter->setFont(m_titleFont);
+    painter->drawText(textRect, Qt::AlignLeft | Qt::AlignTop, title);
+
+    QFontMetrics subtitleMetrics(m_subtitleFont);
+    QString subtitle = subtitleMetrics.elidedText(index.data(ProjectListModel::ShortDescriptionRole).toString(),
+                                                  Qt::ElideRight, textRect.width());
+
+    painter->setFont(m_subtitleFont);
+    painter->drawText(textRect.adjusted(0, titleMetrics.height() + TILE_SPACING, 0, 0), Qt::AlignLeft | Qt::AlignTop, subtitle);
+
+    painter->restore();
+}
+
+QSize ProjectTileDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(option);
+    Q_UNUSED(index);
+
+    return m_tileSize;
+}
@@ -0,0 +1,62 @@
+#ifndef PROJECTLISTMODEL_H
+#define PROJECTLISTMODEL_H
+
+#include "project.h"
+
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+
+// The projects of the hub, one row per shown project. The vector isn't copied,
+// it has to outlive the model and must not change size while the model is in use.
+class ProjectListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        ShortDescriptionRole = Qt::UserRole + 1,
+
+        // ProjectType as an int
+        TypeRole,
+
+        // Index of the project in the vector
+        ProjectIndexRole,
+    };
+
+    // Shows all projects in the order of the vector
+    explicit ProjectListModel(const QVector<Project>* projects, QObject *parent = nullptr);
+
+    // Shows only these projects, in this order
+    void setProjectIndices(const QVector<int>& projectIndices);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+private:
+    const QVector<Project>* m_projects;
+
+    QVector<int> m_projectIndices;
+};
+
+// Paints the tile of a project: its type as a badge on the left, the title and the short description
+// on the right. Nothing is created per project, the view only asks for the rows it shows, and every tile
+// has the same size, so a list of thousands of projects costs what a list of ten does.
+class ProjectTileDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit ProjectTileDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+private:
+    QFont m_qmlBadgeFont;
+    QFont m_widgetsBadgeFont;
+    QFont m_titleFont;
+    QFont m_subtitleFont;
+
+    QSize m_tileSize;
+};
+
+#endif // PROJECTLISTMODEL_H
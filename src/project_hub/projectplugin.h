@@ -0,0 +1,21 @@
+#ifndef PROJECTPLUGIN_H
+#define PROJECTPLUGIN_H
+
+#include <QtPlugin>
+
+// Implemented by the shared library of a project. The title, descriptions and type of the project are
+// in the metadata of the plugin, see discoverPluginProjects, so the hub can list it without loading it.
+class ProjectPlugin
+{
+public:
+    virtual ~ProjectPlugin() = default;
+
+    // Opens the window of the project, which owns itself from then on
+    virtual void launch() = 0;
+};
+
+#define ProjectPlugin_iid "learn-widgets.ProjectPlugin/1.0"
+
+Q_DECLARE_INTERFACE(ProjectPlugin, ProjectPlugin_iid)
+
+#endif // PROJECTPLUGIN_H
@@ -0,0 +1,173 @@
+#include "projectsearchindex.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+// How much a matching trigram counts in each field
+static constexpr std::array<double, 3> FIELD_WEIGHTS = {3.0, 2.0, 1.0};
+
+// Share of the query trigrams a field needs to have for the project to match at all.
+// One wrong letter in a short word costs about half of its trigrams.
+static constexpr double MIN_COVERAGE = 0.5;
+
+static constexpr double TITLE_CONTAINS_BONUS = 2.0;
+static constexpr double TITLE_PREFIX_BONUS = 1.0;
+
+ProjectSearchIndex::ProjectSearchIndex(const QVector<Project> &projects)
+{
+    m_titles.reserve(projects.count());
+
+    for (int i = 0; i < projects.count(); ++i) {
+        const Project& project = projects[i];
+
+        std::array<QString, FIELD_COUNT> fields = {
+            normalize(project.title),
+            normalize(project.shortDescription),
+            normalize(project.description),
+        };
+
+        QHash<Trigram, uint8_t> projectTrigrams;
+        for (int field = 0; field < FIELD_COUNT; ++field) {
+            for (const QString& word : fields[field].split(' ', Qt::SkipEmptyParts)) {
+                for (Trigram trigram : trigrams(word, false)) {
+                    projectTrigrams[trigram] |= 1 << field;
+                }
+            }
+        }
+
+        for (auto it = projectTrigrams.cbegin(); it != projectTrigrams.cend(); ++it) {
+            m_postings[it.key()].append(Posting{i, it.value()});
+        }
+
+        m_titles.append(fields[Title].simplified());
+    }
+}
+
+QVector<int> ProjectSearchIndex::search(const QString &query) const
+{
+    QString normalizedQuery = normalize(query).simplified();
+
+    QVector<int> results;
+    if(normalizedQuery.isEmpty())
+    {
+        results.reserve(projectCount());
+        for (int i = 0; i < projectCount(); ++i) {
+            results.append(i);
+        }
+
+        return results;
+    }
+
+    // Every word is typed from its start, but may not be finished yet
+    QSet<Trigram> queryTrigrams;
+    for (const QString& word : normalizedQuery.split(' ')) {
+        for (Trigram trigram : trigrams(word, true)) {
+            queryTrigrams.insert(trigram);
+        }
+    }
+
+    // Trigrams in common with the query, per project and field
+    QVector<std::array<int, FIELD_COUNT>> hits(projectCount(), {0, 0, 0});
+    for (Trigram trigram : queryTrigrams) {
+        auto postingsIter = m_postings.constFind(trigram);
+        if(postingsIter == m_postings.cend())
+        {
+            continue;
+        }
+
+        for (const Posting& posting : *postingsIter) {
+            for (int field = 0; field < FIELD_COUNT; ++field) {
+                if(posting.fields & (1 << field))
+                {
+                    hits[posting.project][field]++;
+                }
+            }
+        }
+    }
+
+    QVector<std::pair<double, int>> rankedProjects;
+    for (int i = 0; i < projectCount(); ++i) {
+        double bestCoverage = 0.0;
+        double score = 0.0;
+
+        for (int field = 0; field < FIELD_COUNT; ++field) {
+            double coverage = static_cast<double>(hits[i][field]) / queryTrigrams.size();
+            bestCoverage = std::max(bestCoverage, coverage);
+            score += FIELD_WEIGHTS[field] * coverage * coverage;
+        }
+
+        if(bestCoverage < MIN_COVERAGE)
+        {
+            continue;
+        }
+
+        if(m_titles[i].contains(normalizedQuery))
+        {
+            score += TITLE_CONTAINS_BONUS;
+
+            if(m_titles[i].startsWith(normalizedQuery))
+            {
+                score += TITLE_PREFIX_BONUS;
+            }
+        }
+
+        rankedProjects.append({score, i});
+    }
+
+    std::stable_sort(rankedProjects.begin(), rankedProjects.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+
+    results.reserve(rankedProjects.count());
+    for (const auto& rankedProject : rankedProjects) {
+        results.append(rankedProject.second);
+    }
+
+    return results;
+}
+
+int ProjectSearchIndex::projectCount() const
+{
+    return m_titles.count();
+}
+
+QString ProjectSearchIndex::normalize(const QString &text)
+{
+    // Decomposed, an accent is a mark of its own that can be dropped
+    QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString normalized;
+    normalized.reserve(decomposed.size());
+
+    for (QChar c : decomposed) {
+        if(c.isMark())
+        {
+            continue;
+        }
+
+        normalized.append(c.isLetterOrNumber() ? c.toLower() : QChar(' '));
+    }
+
+    return normalized;
+}
+
+QVector<ProjectSearchIndex::Trigram> ProjectSearchIndex::trigrams(const QString &word, bool isPrefix)
+{
+    // Two spaces in front make the first letters trigrams of their own, so short prefixes match.
+    // Only complete words end in a space, a prefix matches every word it is the start of.
+    QString padded = "  " + word;
+    if(!isPrefix)
+    {
+        padded += ' ';
+    }
+
+    QVector<Trigram> result;
+    result.reserve(padded.size() - 2);
+
+    for (int i = 0; i + 2 < padded.size(); ++i) {
+        result.append(Trigram(padded[i].unicode()) << 32 | Trigram(padded[i + 1].unicode()) << 16 | padded[i + 2].unicode());
+    }
+
+    return result;
+}
@@ -0,0 +1,56 @@
+#ifndef PROJECTSEARCHINDEX_H
+#define PROJECTSEARCHINDEX_H
+
+#include "project.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <array>
+
+// Trigram index over the title, short description and description of projects, for searching as the user types.
+// Text is compared lower case, without accents and split into words. A query word matches the words starting
+// like it, and a few typos still leave enough trigrams in common to find a project.
+// The index copies what it needs and never changes after construction, so it may be searched from any thread.
+class ProjectSearchIndex
+{
+public:
+    explicit ProjectSearchIndex(const QVector<Project>& projects);
+
+    // Indices of the matching projects, best match first. Equally good matches and all projects
+    // for an empty query come in the order they were given.
+    QVector<int> search(const QString& query) const;
+
+    int projectCount() const;
+
+    // Lower case letters and digits without accents, everything else becomes a space
+    static QString normalize(const QString& text);
+private:
+    enum Field
+    {
+        Title,
+        ShortDescription,
+        Description,
+        FIELD_COUNT,
+    };
+
+    struct Posting
+    {
+        int project;
+
+        // One bit per Field the trigram occurs in
+        uint8_t fields;
+    };
+
+    // Three characters packed into one key
+    using Trigram = uint64_t;
+
+    static QVector<Trigram> trigrams(const QString& word, bool isPrefix);
+private:
+    QHash<Trigram, QVector<Posting>> m_postings;
+
+    // Normalized titles, for ranking titles that contain the whole query first
+    QVector<QString> m_titles;
+};
+
+#endif // PROJECTSEARCHINDEX_H
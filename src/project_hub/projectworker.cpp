@@ -0,0 +1,129 @@
+#include "projectworker.h"
+#include "projectplugin.h"
+
+#include <QApplication>
+#include <QPluginLoader>
+#include <QProcess>
+#include <QWindow>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+static void reply(const QString& line)
+{
+    std::fputs(qPrintable(line + "\n"), stdout);
+    std::fflush(stdout);
+}
+
+// Lives as long as the process, the stdin thread may still post commands while the application shuts down
+static bool hasLaunched = false;
+
+// Replies "exposed" once the first of the project's windows is on screen, the hub traces the launch until then
+class ExposeWatcher : public QObject
+{
+public:
+    explicit ExposeWatcher(const QList<QWindow*>& windows, QObject *parent)
+        : QObject(parent)
+    {
+        for (QWindow* window : windows) {
+            window->installEventFilter(this);
+        }
+    }
+
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if(!m_isDone && event->type() == QEvent::Expose && static_cast<QWindow*>(watched)->isExposed())
+        {
+            reply("exposed");
+
+            m_isDone = true;
+            deleteLater();
+        }
+
+        return false;
+    }
+private:
+    bool m_isDone = false;
+};
+
+static void handleCommand(const QString& command)
+{
+    if(!command.startsWith("launch "))
+    {
+        reply("error Unknown command " + command);
+        return;
+    }
+
+    if(hasLaunched)
+    {
+        reply("error A worker only launches one project");
+        return;
+    }
+
+    // The loader stays alive with the process, the plugin must not be unloaded while its windows are open
+    auto loader = new QPluginLoader(command.mid(QString("launch ").size()), qApp);
+    auto plugin = qobject_cast<ProjectPlugin*>(loader->instance());
+    if(!plugin)
+    {
+        reply("error " + loader->errorString());
+        return;
+    }
+
+    hasLaunched = true;
+    plugin->launch();
+
+    reply("launched");
+
+    // A warm worker has no windows of its own, all of them belong to the project
+    QList<QWindow*> windows = QGuiApplication::topLevelWindows();
+    if(!windows.isEmpty())
+    {
+        new ExposeWatcher(windows, qApp);
+    }
+}
+
+int runProjectWorker(QApplication& app)
+{
+    QApplication::setStyle("Fusion");
+
+    // A warm worker has no windows yet, it must not quit before it launched a project
+    QApplication::setQuitOnLastWindowClosed(false);
+
+    // Reading stdin blocks, so it is read on a thread of its own and every line is handled on the GUI thread
+    std::thread reader([]() {
+        std::string line;
+        while(std::getline(std::cin, line))
+        {
+            QString command = QString::fromStdString(line).trimmed();
+            QMetaObject::invokeMethod(qApp, [command]() {
+                handleCommand(command);
+
+                if(hasLaunched)
+                {
+                    QApplication::setQuitOnLastWindowClosed(true);
+                }
+            }, Qt::QueuedConnection);
+        }
+
+        // The hub is gone or doesn't need the worker anymore, a launched project keeps running on its own.
+        // Nobody reads its stdout from now on, writing to the pipe would end the project with SIGPIPE.
+        QMetaObject::invokeMethod(qApp, []() {
+            if(!hasLaunched)
+            {
+                QApplication::quit();
+                return;
+            }
+
+            std::freopen(qPrintable(QProcess::nullDevice()), "w", stdout);
+        }, Qt::QueuedConnection);
+    });
+
+    // Blocked in getline, it can't be joined, it ends with the process
+    reader.detach();
+
+    reply("ready");
+
+    return app.exec();
+}
@@ -0,0 +1,15 @@
+#ifndef PROJECTWORKER_H
+#define PROJECTWORKER_H
+
+class QApplication;
+
+// Started by the ProjectWorkerPool of the hub with this argument
+inline constexpr const char* PROJECT_WORKER_ARGUMENT = "--project-worker";
+
+// Runs the hub executable as a worker: it reports "ready" and waits for a "launch <plugin path>" line
+// on stdin, answers "launched" or "error <message>", then "exposed" once a window of the project is on
+// screen, and keeps running until the project's windows are closed. A worker that never launched anything quits once the hub closes its stdin, a launched project
+// keeps running without the hub.
+int runProjectWorker(QApplication& app);
+
+#endif // PROJECTWORKER_H
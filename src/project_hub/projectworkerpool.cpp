@@ -0,0 +1,332 @@
+#include "projectworkerpool.h"
+#include "processstats.h"
+#include "projectworker.h"
+
+#include <algorithm>
+
+static constexpr int STATS_INTERVAL_MS = 1000;
+
+// Ended projects listed by processes(), enough for every project of the hub to show how it ended
+static constexpr int MAX_ENDED_PROCESSES = 50;
+
+QString projectProcessStateName(ProjectProcessState state)
+{
+    switch(state)
+    {
+    case ProjectProcessState::Starting: return "Starting";
+    case ProjectProcessState::Idle: return "Idle";
+    case ProjectProcessState::Launching: return "Launching";
+    case ProjectProcessState::Running: return "Running";
+    case ProjectProcessState::Exited: return "Exited";
+    case ProjectProcessState::Crashed: return "Crashed";
+    case ProjectProcessState::Failed: return "Failed";
+    }
+
+    return QString();
+}
+
+ProjectWorkerPool::ProjectWorkerPool(const QString &program, int warmWorkerCount, QObject *parent)
+    : QObject(parent),
+    m_program(program),
+    m_warmWorkerCount(warmWorkerCount)
+{
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(STATS_INTERVAL_MS);
+    connect(m_statsTimer, &QTimer::timeout, this, &ProjectWorkerPool::sampleStats);
+    m_statsTimer->start();
+
+    replenish();
+}
+
+ProjectWorkerPool::~ProjectWorkerPool()
+{
+    for (const auto& worker : m_workers) {
+        worker->process->disconnect(this);
+
+        // Without stdin an idle worker quits by itself and a launched one knows that the hub is gone
+        worker->process->closeWriteChannel();
+
+        // ~QProcess would kill the project, its process object is let go instead and only cleans up
+        // after itself if the hub outlives the project
+        if(isLaunched(worker.get()))
+        {
+            worker->process->setParent(nullptr);
+            connect(worker->process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), worker->process, &QObject::deleteLater);
+        }
+    }
+}
+
+int ProjectWorkerPool::launch(const QString &title, const QString &pluginPath)
+{
+    // Any warm worker will do, the one that started first is the most likely to be ready
+    auto workerIter = std::find_if(std::begin(m_workers), std::end(m_workers), [this](const auto& worker) {
+        return !isLaunched(worker.get());
+    });
+
+    bool isNewWorker = workerIter == std::end(m_workers);
+    Worker* worker = isNewWorker ? addWorker() : workerIter->get();
+
+    int id = m_nextId++;
+    worker->info.id = id;
+    worker->info.title = title;
+    worker->info.pluginPath = pluginPath;
+    worker->launchStart = TraceRecorder::Clock::now();
+
+    // A worker that is still starting gets the project once it reports to be ready.
+    // A new one is only started now, if it fails to start it reports that for the project right away.
+    if(isNewWorker)
+    {
+        startWorker(worker);
+    }
+    else if(worker->info.state == ProjectProcessState::Idle)
+    {
+        sendLaunch(worker);
+    }
+
+    replenish();
+
+    emit processesChanged();
+
+    return id;
+}
+
+QVector<ProjectProcess> ProjectWorkerPool::processes() const
+{
+    QVector<ProjectProcess> processes = m_endedProcesses;
+    for (const auto& worker : m_workers) {
+        if(isLaunched(worker.get()))
+        {
+            processes.append(worker->info);
+        }
+    }
+
+    std::sort(std::begin(processes), std::end(processes), [](const ProjectProcess& a, const ProjectProcess& b) {
+        return a.id < b.id;
+    });
+
+    return processes;
+}
+
+std::optional<ProjectProcess> ProjectWorkerPool::latestProcess(const QString &pluginPath) const
+{
+    std::optional<ProjectProcess> latest;
+    for (const ProjectProcess& process : processes()) {
+        if(process.pluginPath == pluginPath)
+        {
+            latest = process;
+        }
+    }
+
+    return latest;
+}
+
+int ProjectWorkerPool::warmWorkerCount() const
+{
+    // Workers that died or failed to start are removed, the rest is starting or idle
+    return std::count_if(std::begin(m_workers), std::end(m_workers), [this](const auto& worker) {
+        return !isLaunched(worker.get());
+    });
+}
+
+ProjectWorkerPool::Worker *ProjectWorkerPool::addWorker()
+{
+    auto worker = std::make_unique<Worker>();
+    worker->process = new QProcess(this);
+
+    // Warnings of the project end up where the hub's go
+    worker->process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+    Worker* workerPtr = worker.get();
+    connect(worker->process, &QProcess::started, this, [workerPtr]() {
+        workerPtr->info.processId = workerPtr->process->processId();
+    });
+    connect(worker->process, &QProcess::readyReadStandardOutput, this, [this, workerPtr]() {
+        onOutput(workerPtr);
+    });
+    connect(worker->process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, [this, workerPtr](int exitCode, QProcess::ExitStatus exitStatus) {
+        onFinished(workerPtr, exitCode, exitStatus);
+    });
+    connect(worker->process, &QProcess::errorOccurred, this, [this, workerPtr](QProcess::ProcessError error) {
+        onError(workerPtr, error);
+    });
+
+    m_workers.push_back(std::move(worker));
+
+    return workerPtr;
+}
+
+void ProjectWorkerPool::startWorker(Worker *worker)
+{
+    // May fail right away, the worker is gone then
+    worker->process->start(m_program, {PROJECT_WORKER_ARGUMENT});
+}
+
+void ProjectWorkerPool::replenish()
+{
+    for (int i = warmWorkerCount(); i < m_warmWorkerCount; ++i) {
+        startWorker(addWorker());
+    }
+}
+
+void ProjectWorkerPool::removeWorker(Worker *worker)
+{
+    if(isLaunched(worker))
+    {
+        m_endedProcesses.append(worker->info);
+        if(m_endedProcesses.size() > MAX_ENDED_PROCESSES)
+        {
+            m_endedProcesses.removeFirst();
+        }
+    }
+
+    // Called from the signals of the process, it can only be deleted once they returned
+    worker->process->disconnect(this);
+    worker->process->deleteLater();
+
+    m_workers.erase(std::find_if(std::begin(m_workers), std::end(m_workers), [worker](const auto& other) {
+        return other.get() == worker;
+    }));
+}
+
+void ProjectWorkerPool::onOutput(Worker *worker)
+{
+    worker->output += worker->process->readAllStandardOutput();
+
+    // Projects may print to stdout as well, only the worker's replies are of interest
+    int lineEnd;
+    while((lineEnd = worker->output.indexOf('\n')) >= 0)
+    {
+        QString line = QString::fromUtf8(worker->output.left(lineEnd)).trimmed();
+        worker->output.remove(0, lineEnd + 1);
+
+        if(line == "ready" && worker->info.state == ProjectProcessState::Starting)
+        {
+            worker->info.state = ProjectProcessState::Idle;
+            if(isLaunched(worker))
+            {
+                sendLaunch(worker);
+            }
+        }
+        else if(line == "launched" && worker->info.state == ProjectProcessState::Launching)
+        {
+            worker->info.state = ProjectProcessState::Running;
+            emit processesChanged();
+        }
+        else if(line == "exposed" && worker->info.state == ProjectProcessState::Running)
+        {
+            // Same span as for projects launched in the hub itself
+            TraceRecorder::instance().addSpan("launch until exposed", worker->launchStart, TraceRecorder::Clock::now(), worker->info.title);
+        }
+        else if(line.startsWith("error ") && worker->info.state == ProjectProcessState::Launching)
+        {
+            fail(worker, line.mid(QString("error ").size()));
+        }
+    }
+}
+
+void ProjectWorkerPool::onFinished(Worker *worker, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if(!isLaunched(worker))
+    {
+        // A warm worker that died is dropped, it isn't replaced right away in case it dies again
+        removeWorker(worker);
+        return;
+    }
+
+    if(worker->info.state == ProjectProcessState::Running)
+    {
+        bool isCrash = exitStatus == QProcess::CrashExit || exitCode != 0;
+        worker->info.state = isCrash ? ProjectProcessState::Crashed : ProjectProcessState::Exited;
+        worker->info.cpuPercent = 0.0;
+        worker->info.residentBytes = 0;
+    }
+    else if(worker->info.state != ProjectProcessState::Failed)
+    {
+        fail(worker, QString("The worker quit before the project was launched"));
+    }
+
+    removeWorker(worker);
+
+    emit processesChanged();
+}
+
+void ProjectWorkerPool::onError(Worker *worker, QProcess::ProcessError error)
+{
+    // Crashes are reported by onFinished as well
+    if(error != QProcess::FailedToStart)
+    {
+        return;
+    }
+
+    worker->info.state = ProjectProcessState::Failed;
+    worker->info.error = worker->process->errorString();
+
+    // There is no process that could finish, the worker is removed right away.
+    // A warm one is dropped like one that died.
+    ProjectProcess info = worker->info;
+    bool wasLaunched = isLaunched(worker);
+    removeWorker(worker);
+
+    if(wasLaunched)
+    {
+        emit launchFailed(info.title, info.error);
+        emit processesChanged();
+    }
+}
+
+void ProjectWorkerPool::sendLaunch(Worker *worker)
+{
+    worker->info.state = ProjectProcessState::Launching;
+    worker->process->write(QString("launch %1\n").arg(worker->info.pluginPath).toUtf8());
+}
+
+void ProjectWorkerPool::fail(Worker *worker, const QString &error)
+{
+    worker->info.state = ProjectProcessState::Failed;
+    worker->info.error = error;
+
+    // The worker quits once its stdin is closed, it hasn't launched anything
+    worker->process->closeWriteChannel();
+
+    emit launchFailed(worker->info.title, error);
+    emit processesChanged();
+}
+
+void ProjectWorkerPool::sampleStats()
+{
+    bool hasChanged = false;
+
+    for (const auto& worker : m_workers) {
+        if(!isLaunched(worker.get()) || worker->info.state != ProjectProcessState::Running)
+        {
+            continue;
+        }
+
+        std::optional<ProcessStats> stats = readProcessStats(worker->info.processId);
+        if(!stats)
+        {
+            continue;
+        }
+
+        if(worker->lastCpuTimeMs >= 0 && worker->lastSample.elapsed() > 0)
+        {
+            worker->info.cpuPercent = 100.0 * (stats->cpuTimeMs - worker->lastCpuTimeMs) / worker->lastSample.elapsed();
+        }
+
+        worker->info.residentBytes = stats->residentBytes;
+        worker->lastCpuTimeMs = stats->cpuTimeMs;
+        worker->lastSample.start();
+
+        hasChanged = true;
+    }
+
+    if(hasChanged)
+    {
+        emit processesChanged();
+    }
+}
+
+bool ProjectWorkerPool::isLaunched(const Worker *worker) const
+{
+    return worker->info.id != 0;
+}
@@ -0,0 +1,118 @@
+#ifndef PROJECTWORKERPOOL_H
+#define PROJECTWORKERPOOL_H
+
+#include "tracerecorder.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+
+enum class ProjectProcessState
+{
+    Starting,   // the worker is starting up
+    Idle,       // warm, waiting for a project
+    Launching,  // loading the plugin of the project
+    Running,
+    Exited,
+    Crashed,
+    Failed      // the worker didn't start or couldn't launch the project
+};
+
+QString projectProcessStateName(ProjectProcessState state);
+
+struct ProjectProcess
+{
+    int id = 0;
+    qint64 processId = 0;
+
+    QString title;
+    QString pluginPath;
+
+    ProjectProcessState state = ProjectProcessState::Starting;
+    QString error;
+
+    // Sampled every second while the project runs
+    double cpuPercent = 0.0;
+    qint64 residentBytes = 0;
+};
+
+// Launches plugin projects in worker processes, so a busy or crashing project can't take the hub with it.
+// A few workers are started ahead of time and wait for a project, a launch only has to load the plugin.
+class ProjectWorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The program is started with PROJECT_WORKER_ARGUMENT, the hub executable itself by default
+    explicit ProjectWorkerPool(const QString& program, int warmWorkerCount = 1, QObject *parent = nullptr);
+
+    // Kills the idle workers without waiting for them, launched projects keep running
+    ~ProjectWorkerPool() override;
+
+    // Returns the id of the project process
+    int launch(const QString& title, const QString& pluginPath);
+
+    // Launched projects, newest last. Those that ended are still listed with how they ended,
+    // only the most recent ones are remembered.
+    QVector<ProjectProcess> processes() const;
+
+    // The latest process of the project, if there is one
+    std::optional<ProjectProcess> latestProcess(const QString& pluginPath) const;
+
+    int warmWorkerCount() const;
+
+signals:
+    void processesChanged();
+    void launchFailed(const QString& title, const QString& error);
+
+private:
+    struct Worker
+    {
+        QProcess* process = nullptr;
+        ProjectProcess info;
+
+        QByteArray output;
+
+        // For the launch span of the trace, which ends when the worker reports a window exposed
+        TraceRecorder::Clock::time_point launchStart;
+
+        // For the CPU usage between two samples
+        qint64 lastCpuTimeMs = -1;
+        QElapsedTimer lastSample;
+    };
+
+    Worker* addWorker();
+    void startWorker(Worker* worker);
+    void replenish();
+
+    // Drops a worker whose process is gone, the info of a launched one is kept in m_endedProcesses
+    void removeWorker(Worker* worker);
+
+    void onOutput(Worker* worker);
+    void onFinished(Worker* worker, int exitCode, QProcess::ExitStatus exitStatus);
+    void onError(Worker* worker, QProcess::ProcessError error);
+
+    void sendLaunch(Worker* worker);
+    void fail(Worker* worker, const QString& error);
+
+    void sampleStats();
+
+    bool isLaunched(const Worker* worker) const;
+
+    QString m_program;
+    int m_warmWorkerCount;
+
+    // Warm workers and the ones with a project that is still running
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    int m_nextId = 1;
+
+    QVector<ProjectProcess> m_endedProcesses;
+
+    QTimer* m_statsTimer;
+};
+
+#endif // PROJECTWORKERPOOL_H
@@ -0,0 +1,149 @@
+#include "tracerecorder.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+static const char* TRACE_ENVIRONMENT_VARIABLE = "PROJECT_HUB_TRACE";
+
+// Initialized before main runs
+static const TraceRecorder::Clock::time_point s_processStart = TraceRecorder::Clock::now();
+
+TraceRecorder::TraceRecorder(size_t capacity, bool isEnabled)
+    : m_isEnabled(isEnabled),
+    m_capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+TraceRecorder &TraceRecorder::instance()
+{
+    static TraceRecorder s_recorder(DEFAULT_CAPACITY, !outputPath().isEmpty());
+    return s_recorder;
+}
+
+QString TraceRecorder::outputPath()
+{
+    return qEnvironmentVariable(TRACE_ENVIRONMENT_VARIABLE);
+}
+
+TraceRecorder::Clock::time_point TraceRecorder::processStart()
+{
+    return s_processStart;
+}
+
+void TraceRecorder::setEnabled(bool isEnabled)
+{
+    m_isEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+void TraceRecorder::addSpan(const char *name, Clock::time_point start, Clock::time_point end, const QString &detail)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    Span span{name, detail, start, end, std::hash<std::thread::id>()(std::this_thread::get_id())};
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_spans.size() < m_capacity)
+    {
+        m_spans.push_back(std::move(span));
+    }
+    else
+    {
+        m_spans[m_nextSpan] = std::move(span);
+    }
+
+    m_nextSpan = (m_nextSpan + 1) % m_capacity;
+}
+
+size_t TraceRecorder::spanCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_spans.size();
+}
+
+void TraceRecorder::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_spans.clear();
+    m_nextSpan = 0;
+}
+
+QByteArray TraceRecorder::toChromeTraceJson() const
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    QJsonArray events;
+
+    // Until the buffer wrapped around the oldest span is the first one
+    size_t oldestSpan = m_spans.size() < m_capacity ? 0 : m_nextSpan;
+    qint64 processId = QCoreApplication::applicationPid();
+
+    for (size_t i = 0; i < m_spans.size(); ++i) {
+        const Span& span = m_spans[(oldestSpan + i) % m_spans.size()];
+
+        QJsonObject event;
+        event["name"] = span.name;
+        event["cat"] = "hub";
+        event["ph"] = "X";
+        event["ts"] = static_cast<qint64>(duration_cast<microseconds>(span.start - s_processStart).count());
+        event["dur"] = static_cast<qint64>(duration_cast<microseconds>(span.end - span.start).count());
+        event["pid"] = processId;
+        event["tid"] = static_cast<qint64>(span.thread & 0x7fffffff);
+
+        if(!span.detail.isEmpty())
+        {
+            event["args"] = QJsonObject{{"detail", span.detail}};
+        }
+
+        events.append(event);
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool TraceRecorder::writeChromeTrace(const QString &path) const
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    file.write(toChromeTraceJson());
+    return file.commit();
+}
+
+TraceSpan::TraceSpan(const char *name, const QString &detail)
+    : m_name(name),
+    m_isEnabled(TraceRecorder::instance().isEnabled())
+{
+    if(m_isEnabled)
+    {
+        m_detail = detail;
+        m_start = TraceRecorder::Clock::now();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    if(m_isEnabled)
+    {
+        TraceRecorder::instance().addSpan(m_name, m_start, TraceRecorder::Clock::now(), m_detail);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// Timing spans, kept in a ring buffer and exported as Chrome trace JSON for chrome://tracing or Perfetto.
+// The recorder of the hub is only enabled when PROJECT_HUB_TRACE names the file to write the trace to
+// when the hub quits. Disabled, recording a span costs one check of a bool.
+class TraceRecorder
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit TraceRecorder(size_t capacity = DEFAULT_CAPACITY, bool isEnabled = false);
+
+    // Enabled by the environment, see above
+    static TraceRecorder& instance();
+
+    // Path from PROJECT_HUB_TRACE, empty if tracing is off
+    static QString outputPath();
+
+    // Close to the start of the process, taken while static variables are initialized. Timestamps count from here.
+    static Clock::time_point processStart();
+
+    bool isEnabled() const { return m_isEnabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool isEnabled);
+
+    // Once the buffer is full, every new span replaces the oldest one
+    void addSpan(const char* name, Clock::time_point start, Clock::time_point end, const QString& detail = QString());
+
+    size_t spanCount() const;
+    void clear();
+
+    // The spans from oldest to newest, as "complete" events with microsecond timestamps
+    QByteArray toChromeTraceJson() const;
+    bool writeChromeTrace(const QString& path) const;
+private:
+    struct Span
+    {
+        // Names are string literals, they aren't copied
+        const char* name;
+        QString detail;
+
+        Clock::time_point start;
+        Clock::time_point end;
+
+        // Hash of the std::thread::id, for the tid of the trace
+        size_t thread;
+    };
+
+    std::atomic<bool> m_isEnabled;
+
+    mutable std::mutex m_mutex;
+    std::vector<Span> m_spans;
+    size_t m_capacity;
+    size_t m_nextSpan = 0;
+};
+
+// Records the time from its construction to its destruction into the hub's recorder, if it is enabled
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name, const QString& detail = QString());
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+private:
+    const char* m_name;
+    QString m_detail;
+    TraceRecorder::Clock::time_point m_start;
+    bool m_isEnabled;
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,89 @@
+#include "chess/bench.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <cstdio>
+
+using namespace Chess;
+
+// "bench" searches the bench positions to a fixed depth and prints the nodes, their rate and the
+// node signature, which only changes when the search does. "micro" times the move generation
+// and the functions around it one by one.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks of the chess search and move generation");
+    parser.addHelpOption();
+    parser.addPositionalArgument("mode", "bench (default) or micro");
+
+    QCommandLineOption depthOption("depth", "Depth of the bench searches.", "depth", "3");
+    QCommandLineOption timeOption("ms", "Time of every microbenchmark.", "ms", "500");
+    QCommandLineOption statisticsOption("stats", "Print the search counters summed over the bench positions.");
+
+    // What each part of the selective search is worth, in nodes and time
+    QCommandLineOption noNullMoveOption("no-null-move", "Search without null move pruning.");
+    QCommandLineOption noLateMoveReductionsOption("no-lmr", "Search without late move reductions.");
+    QCommandLineOption noFutilityOption("no-futility", "Search without futility pruning.");
+    QCommandLineOption noAspirationOption("no-aspiration", "Search without aspiration windows.");
+
+    parser.addOptions({depthOption, timeOption, statisticsOption,
+                       noNullMoveOption, noLateMoveReductionsOption, noFutilityOption, noAspirationOption});
+    parser.process(app);
+
+    QString mode = parser.positionalArguments().value(0, "bench");
+
+    if(mode == "bench")
+    {
+        int depth = parser.value(depthOption).toInt();
+        if(depth < 1 || depth > MAX_PLY)
+        {
+            std::fprintf(stderr, "The depth must be between 1 and %d\n", MAX_PLY);
+            return 1;
+        }
+
+        SearchFeatures features;
+        features.nullMovePruning = !parser.isSet(noNullMoveOption);
+        features.lateMoveReductions = !parser.isSet(noLateMoveReductionsOption);
+        features.futilityPruning = !parser.isSet(noFutilityOption);
+        features.aspirationWindows = !parser.isSet(noAspirationOption);
+
+        BenchResult result = runBench(depth, features);
+
+        std::printf("positions  %d\n", result.positionCount);
+        std::printf("depth      %d\n", result.depth);
+        std::printf("nodes      %llu\n", static_cast<unsigned long long>(result.nodes));
+        std::printf("time       %lld ms\n", static_cast<long long>(result.elapsedMs));
+        std::printf("nps        %.0f\n", result.nodesPerSecond());
+        std::printf("signature  %016llx\n", static_cast<unsigned long long>(result.signature));
+
+        if(parser.isSet(statisticsOption))
+        {
+            std::printf("\n%s\n", qPrintable(result.statistics.toString()));
+        }
+
+        return 0;
+    }
+
+    if(mode == "micro")
+    {
+        qint64 ms = parser.value(timeOption).toLongLong();
+        if(ms <= 0)
+        {
+            std::fprintf(stderr, "The time must be positive\n");
+            return 1;
+        }
+
+        for (const MicroBenchmark& benchmark : runMicroBenchmarks(ms)) {
+            std::printf("%-45s %12.1f ns/call  (%llu calls)\n", qPrintable(benchmark.name), benchmark.nanosecondsPerCall(),
+                        static_cast<unsigned long long>(benchmark.calls));
+        }
+
+        return 0;
+    }
+
+    std::fprintf(stderr, "Unknown mode %s\n", qPrintable(mode));
+    return 1;
+}
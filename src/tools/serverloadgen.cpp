@@ -0,0 +1,72 @@
+#include "chess/gameserver.h"
+#include "chess/loadgenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <cstdio>
+
+using namespace Chess;
+
+// Plays random games between simulated players on a GameServer, watched by simulated spectators,
+// and prints how many messages got through and how long moves took to arrive.
+// Without --server a server is started in this process, listening on the loopback interface.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Load generator for the chess game server");
+    parser.addHelpOption();
+
+    QCommandLineOption serverOption("server", "Server to connect to instead of starting one.", "host:port");
+    QCommandLineOption playersOption("players", "Simulated players, two per game.", "count", "100");
+    QCommandLineOption spectatorsOption("spectators", "Simulated spectators, spread over the games.", "count", "100");
+    QCommandLineOption secondsOption("seconds", "How long to run.", "seconds", "10");
+    QCommandLineOption threadsOption("threads", "Threads of the server started in this process.", "count",
+                                     QString::number(QThread::idealThreadCount()));
+    parser.addOptions({serverOption, playersOption, spectatorsOption, secondsOption, threadsOption});
+    parser.process(app);
+
+    LoadOptions options;
+    options.playerCount = parser.value(playersOption).toInt();
+    options.spectatorCount = parser.value(spectatorsOption).toInt();
+    options.durationMs = parser.value(secondsOption).toDouble() * 1000;
+
+    if(options.playerCount < 2 || options.spectatorCount < 0 || options.durationMs <= 0)
+    {
+        std::fprintf(stderr, "Needs at least 2 players, no negative spectators and a positive duration\n");
+        return 1;
+    }
+
+    std::unique_ptr<GameServer> server;
+    if(parser.isSet(serverOption))
+    {
+        QString address = parser.value(serverOption);
+        options.host = address.section(':', 0, 0);
+        options.port = address.section(':', 1).toUShort();
+    }
+    else
+    {
+        server = std::make_unique<GameServer>(parser.value(threadsOption).toInt());
+        if(!server->listen(QHostAddress::LocalHost, 0))
+        {
+            std::fprintf(stderr, "Could not start the server: %s\n", qPrintable(server->errorString()));
+            return 1;
+        }
+
+        options.port = server->serverPort();
+    }
+
+    LoadGenerator generator(options);
+    LoadReport report = generator.run();
+
+    std::printf("%d players, %d spectators, %.1f s\n", options.playerCount, options.spectatorCount, report.durationMs / 1000.0);
+    std::printf("games     %llu\n", static_cast<unsigned long long>(report.gameCount));
+    std::printf("moves     %llu\n", static_cast<unsigned long long>(report.moveCount));
+    std::printf("messages  %llu (%.0f/s)\n", static_cast<unsigned long long>(report.messageCount), report.messagesPerSecond());
+    std::printf("latency   p50 %.3f ms, p99 %.3f ms\n", report.p50LatencyMs, report.p99LatencyMs);
+    std::printf("errors    %llu\n", static_cast<unsigned long long>(report.errorCount));
+
+    return report.errorCount == 0 ? 0 : 1;
+}
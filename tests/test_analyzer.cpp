@@ -0,0 +1,257 @@
+#include <QTest>
+
+#include <numeric>
+
+#include "chess/analyzer.h"
+#include "chess/search.h"
+#include "chess/transpositiontable.h"
+
+using namespace Chess;
+
+// Qd8+ Bxd8 Re8#
+static const char* MATE_IN_TWO_FEN = "r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 1";
+
+static const char* MIDDLEGAME_FEN = "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4";
+
+class AnalyzerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Takes results until one matches or the time is up
+    static std::optional<AnalysisInfo> waitForInfo(Analyzer& analyzer, std::function<bool(const AnalysisInfo&)> isWanted,
+                                                   int timeoutMs = 10000) {
+        QElapsedTimer timer;
+        timer.start();
+
+        while(timer.elapsed() < timeoutMs)
+        {
+            std::optional<AnalysisInfo> info = analyzer.takeLatestInfo();
+            if(info && isWanted(*info))
+            {
+                return info;
+            }
+
+            QTest::qWait(10);
+        }
+
+        return std::nullopt;
+    }
+
+private slots:
+    void testTranspositionTable() {
+        TranspositionTable table(1000);
+        QCOMPARE(table.entryCount(), size_t(512));
+
+        QVERIFY(!table.probe(42));
+
+        table.store(42, 5, 17, ScoreBound::Exact, 1234);
+        std::optional<TranspositionEntry> entry = table.probe(42);
+        QVERIFY(entry);
+        QCOMPARE(entry->depth, int8_t(5));
+        QCOMPARE(entry->score, 17);
+        QCOMPARE(entry->move, uint16_t(1234));
+
+        // a shallower bound doesn't replace a deeper result of the same search
+        table.store(42, 3, 50, ScoreBound::Lower, 0);
+        QCOMPARE(table.probe(42)->score, 17);
+
+        // it does once the entry is from an earlier search, and keeps the move it knew
+        table.newSearch();
+        table.store(42, 3, 50, ScoreBound::Lower, 0);
+        QCOMPARE(table.probe(42)->score, 50);
+        QCOMPARE(table.probe(42)->move, uint16_t(1234));
+
+        // the same slot, another position
+        table.store(42 + 512, 1, 0, ScoreBound::Upper, 0);
+        QVERIFY(!table.probe(42));
+
+        table.clear();
+        QVERIFY(!table.probe(42 + 512));
+    }
+
+    void testTableSavesWork() {
+        Position position = *Position::fromFen(MIDDLEGAME_FEN);
+
+        SearchLimits limits;
+        limits.depth = 4;
+
+        SearchResult withoutTable = Search().search(position, limits);
+
+        TranspositionTable table;
+        Search search(&table);
+        SearchResult first = search.search(position, limits);
+        SearchResult second = search.search(position, limits);
+
+        QVERIFY(first.nodes < withoutTable.nodes);
+        QVERIFY(second.nodes < first.nodes / 2);
+        QVERIFY(second.bestMove == first.bestMove);
+        QCOMPARE(second.score, first.score);
+    }
+
+    void testSearchStatistics() {
+        Position position = *Position::fromFen(MIDDLEGAME_FEN);
+
+        SearchLimits limits;
+        limits.depth = 4;
+
+        TranspositionTable table;
+        SearchResult result = Search(&table).search(position, limits);
+        const SearchStatistics& statistics = result.statistics;
+
+        QCOMPARE(statistics.nodes, result.nodes);
+        QVERIFY(statistics.quiescenceNodes > 0 && statistics.quiescenceNodes < statistics.nodes);
+        QVERIFY(statistics.tableHits > 0 && statistics.tableHits <= statistics.tableProbes);
+        QVERIFY(statistics.tableCutoffs <= statistics.tableHits);
+        QVERIFY(statistics.firstMoveBetaCutoffs > 0 && statistics.firstMoveBetaCutoffs <= statistics.betaCutoffs);
+
+        // every node belongs to an iteration
+        QCOMPARE(statistics.iterationNodes.count(), 4);
+        QCOMPARE(std::accumulate(statistics.iterationNodes.begin(), statistics.iterationNodes.end(), uint64_t(0)), statistics.nodes);
+        QCOMPARE(statistics.effectiveBranchingFactors().count(), 3);
+        QVERIFY(statistics.effectiveBranchingFactors().last() > 1.0);
+
+        // summed up like the counters of several threads
+        SearchStatistics sum = statistics;
+        sum += statistics;
+        QCOMPARE(sum.nodes, 2 * statistics.nodes);
+        QCOMPARE(sum.iterationNodes.last(), 2 * statistics.iterationNodes.last());
+        QCOMPARE(sum.tableHitRate(), statistics.tableHitRate());
+
+        // a search without a table probes nothing
+        QCOMPARE(Search().search(position, limits).statistics.tableProbes, uint64_t(0));
+    }
+
+    void testSelectiveSearch() {
+        Position position = *Position::fromFen(MIDDLEGAME_FEN);
+
+        SearchLimits limits;
+        limits.depth = 5;
+        limits.features = SearchFeatures::none();
+
+        SearchResult plain = Search().search(position, limits);
+        QCOMPARE(plain.statistics.nullMovePrunes, uint64_t(0));
+        QCOMPARE(plain.statistics.lateMoveReductions, uint64_t(0));
+
+        // every part alone searches fewer nodes than none at all
+        for (int i = 0; i < 4; ++i) {
+            SearchLimits partial = limits;
+            partial.features.nullMovePruning = i == 0;
+            partial.features.lateMoveReductions = i == 1;
+            partial.features.futilityPruning = i == 2;
+            partial.features.aspirationWindows = i == 3;
+
+            SearchResult result = Search().search(position, partial);
+            QVERIFY2(result.nodes < plain.nodes, qPrintable(QString::number(i)));
+            QVERIFY(result.bestMove);
+        }
+
+        limits.features = SearchFeatures();
+        SearchResult selective = Search().search(position, limits);
+        QVERIFY(selective.nodes < plain.nodes / 2);
+        QVERIFY(selective.statistics.nullMovePrunes > 0);
+        QVERIFY(selective.statistics.lateMoveReductions > 0);
+        QVERIFY(std::abs(selective.score - plain.score) < 100);
+
+        // the pruning must not hide a mate
+        SearchResult mate = Search().search(*Position::fromFen(MATE_IN_TWO_FEN), limits);
+        QCOMPARE(mate.score, MATE_SCORE - 3);
+    }
+
+    void testPrincipalVariation() {
+        Position position = *Position::fromFen(MIDDLEGAME_FEN);
+
+        SearchLimits limits;
+        limits.depth = 4;
+
+        int iterations = 0;
+        limits.onIteration = [&](const SearchResult& result) {
+            iterations++;
+            QCOMPARE(result.depth, iterations);
+        };
+
+        SearchResult result = Search().search(position, limits);
+        QCOMPARE(iterations, 4);
+
+        QCOMPARE(result.principalVariation.size(), 4);
+        QVERIFY(result.principalVariation.first() == *result.bestMove);
+
+        for (const Move& move : result.principalVariation) {
+            QVERIFY(position.getLegalMoves().contains(move));
+            position.doMove(move);
+        }
+    }
+
+    void testMateScoresThroughTable() {
+        Position position = *Position::fromFen(MATE_IN_TWO_FEN);
+
+        SearchLimits limits;
+        limits.depth = 5;
+
+        TranspositionTable table;
+        Search search(&table);
+
+        for (int i = 0; i < 2; ++i) {
+            SearchResult result = search.search(position, limits);
+            QCOMPARE(result.score, MATE_SCORE - 3);
+            QCOMPARE(result.principalVariation.size(), 3);
+            QCOMPARE(getUciNotation(result.principalVariation.first()), QString("d5d8"));
+        }
+    }
+
+    void testAnalyzerFollowsPosition() {
+        Analyzer analyzer;
+        QVERIFY(!analyzer.isRunning());
+        analyzer.waitForIdle();
+
+        Position start;
+        analyzer.analyze(start);
+        QVERIFY(analyzer.isRunning());
+
+        std::optional<AnalysisInfo> info = waitForInfo(analyzer, [](const AnalysisInfo& info) {
+            return info.depth >= 3;
+        });
+        QVERIFY(info);
+        QCOMPARE(info->position.hash(), start.hash());
+        QVERIFY(!info->isFinished);
+        QVERIFY(!info->principalVariation.isEmpty());
+
+        Position next = start;
+        next.doMove(info->principalVariation.first());
+        analyzer.analyze(next);
+
+        // results of the old position are gone as soon as the new one is set
+        info = waitForInfo(analyzer, [](const AnalysisInfo&) {
+            return true;
+        });
+        QVERIFY(info);
+        QCOMPARE(info->position.hash(), next.hash());
+
+        analyzer.stop();
+        QVERIFY(!analyzer.isRunning());
+
+        // the search has returned, nothing of it shows up anymore
+        analyzer.waitForIdle();
+        QTest::qWait(100);
+        QVERIFY(!analyzer.takeLatestInfo());
+    }
+
+    void testAnalyzerFinishesOnMate() {
+        Analyzer analyzer;
+
+        // black to move is mated in two as well, scores are from white's point of view
+        Position position = *Position::fromFen(MATE_IN_TWO_FEN);
+        position.doMove(*findUciMove(position, "d5d8"));
+
+        analyzer.analyze(position);
+
+        std::optional<AnalysisInfo> info = waitForInfo(analyzer, [](const AnalysisInfo& info) {
+            return info.isFinished;
+        });
+        QVERIFY(info);
+        QCOMPARE(info->score, MATE_SCORE - 2);
+    }
+};
+
+QTEST_MAIN(AnalyzerTest)
+#include "test_analyzer.moc"
@@ -0,0 +1,107 @@
+#include <QDir>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "project_hub/bannercache.h"
+
+class BannerCacheTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QString writeImage(const QString& path, const QSize& size, QColor color) {
+        QImage image(size, QImage::Format_RGB32);
+        image.fill(color);
+        image.save(path, "PNG");
+        return path;
+    }
+
+private slots:
+    void testLoadScalesAndCachesOnDisk() {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+
+        QString cacheDirectory = directory.filePath("cache");
+        QString path = writeImage(directory.filePath("banner.png"), QSize(1600, 900), Qt::red);
+
+        QImage image = BannerCache::loadBanner(path, QSize(800, 300), cacheDirectory);
+        QVERIFY(!image.isNull());
+
+        // scaled to fit, keeping the aspect ratio
+        QCOMPARE(image.size(), QSize(533, 300));
+        QCOMPARE(QColor(image.pixel(10, 10)), QColor(Qt::red));
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QString cachePath = QDir(cacheDirectory).filePath(BannerCache::diskCacheKey(file.readAll(), QSize(800, 300)));
+        file.close();
+        QVERIFY(QFile::exists(cachePath));
+
+        // the same content is read from the disk cache
+        QCOMPARE(BannerCache::loadBanner(path, QSize(800, 300), cacheDirectory).size(), image.size());
+
+        // changed content, same path, a new entry
+        writeImage(path, QSize(1600, 900), Qt::blue);
+        QImage changed = BannerCache::loadBanner(path, QSize(800, 300), cacheDirectory);
+        QCOMPARE(QColor(changed.pixel(10, 10)), QColor(Qt::blue));
+        QCOMPARE(QDir(cacheDirectory).entryList(QDir::Files).count(), 2);
+
+        // small images aren't scaled up
+        QString smallPath = writeImage(directory.filePath("small.png"), QSize(40, 20), Qt::green);
+        QCOMPARE(BannerCache::loadBanner(smallPath, QSize(800, 300), QString()).size(), QSize(40, 20));
+
+        QVERIFY(BannerCache::loadBanner(directory.filePath("missing.png"), QSize(800, 300), cacheDirectory).isNull());
+    }
+
+    void testDiskCacheKey() {
+        QString key = BannerCache::diskCacheKey("content", QSize(100, 50));
+        QCOMPARE(key, BannerCache::diskCacheKey("content", QSize(100, 50)));
+        QVERIFY(key != BannerCache::diskCacheKey("content", QSize(100, 51)));
+        QVERIFY(key != BannerCache::diskCacheKey("other content", QSize(100, 50)));
+    }
+
+    void testRequestAndLeastRecentlyUsed() {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+
+        QString first = writeImage(directory.filePath("first.png"), QSize(200, 200), Qt::red);
+        QString second = writeImage(directory.filePath("second.png"), QSize(200, 200), Qt::green);
+        QString third = writeImage(directory.filePath("third.png"), QSize(200, 200), Qt::blue);
+
+        // room for two 200x200 images of 160 KB each
+        BannerCache cache(QString(), 400);
+        QSignalSpy loaded(&cache, &BannerCache::bannerLoaded);
+
+        QSize size(200, 200);
+        QVERIFY(!cache.cachedBanner(first, size));
+
+        cache.requestBanner(first, size);
+        cache.requestBanner(first, size);
+        QTRY_COMPARE(loaded.count(), 1);
+        QVERIFY(cache.cachedBanner(first, size));
+
+        cache.requestBanner(second, size);
+        QTRY_COMPARE(loaded.count(), 2);
+
+        // the first one was used last, the second one goes
+        QVERIFY(cache.cachedBanner(first, size));
+        cache.requestBanner(third, size);
+        QTRY_COMPARE(loaded.count(), 3);
+
+        QVERIFY(cache.cachedBanner(first, size));
+        QVERIFY(!cache.cachedBanner(second, size));
+        QVERIFY(cache.cachedBanner(third, size));
+
+        // a cached banner is emitted as well
+        cache.requestBanner(third, size);
+        QTRY_COMPARE(loaded.count(), 4);
+
+        cache.requestBanner(directory.filePath("missing.png"), size);
+        QTRY_COMPARE(loaded.count(), 5);
+        QVERIFY(loaded.last().at(2).value<QImage>().isNull());
+    }
+};
+
+QTEST_MAIN(BannerCacheTest)
+#include "test_bannercache.moc"
@@ -0,0 +1,46 @@
+#include <QTest>
+
+#include "chess/bench.h"
+
+using namespace Chess;
+
+class BenchTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testPositionsAreValid() {
+        QVERIFY(benchPositions().count() >= 50);
+
+        for (const QString& fen : benchPositions()) {
+            std::optional<Position> position = Position::fromFen(fen);
+            QVERIFY2(position, qPrintable(fen));
+        }
+    }
+
+    void testSignatureIsDeterministic() {
+        BenchResult first = runBench(2);
+        BenchResult second = runBench(2);
+
+        QCOMPARE(first.positionCount, benchPositions().count());
+        QVERIFY(first.nodes > 0);
+        QCOMPARE(first.nodes, second.nodes);
+        QCOMPARE(first.signature, second.signature);
+
+        // a deeper search visits other nodes
+        QVERIFY(runBench(3).signature != first.signature);
+    }
+
+    void testMicroBenchmarks() {
+        QVector<MicroBenchmark> benchmarks = runMicroBenchmarks(1);
+        QCOMPARE(benchmarks.count(), 5);
+
+        for (const MicroBenchmark& benchmark : benchmarks) {
+            QVERIFY2(benchmark.calls > 0, qPrintable(benchmark.name));
+            QVERIFY(benchmark.nanosecondsPerCall() > 0);
+        }
+    }
+};
+
+QTEST_MAIN(BenchTest)
+#include "test_bench.moc"
@@ -0,0 +1,219 @@
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QTest>
+
+#include <algorithm>
+
+#include "chess/boardrenderer.h"
+#include "chess/chess.h"
+#include "chess/offscreenrenderer.h"
+
+using namespace Chess;
+
+// Records the region of every paint event
+class RecordingBoardView : public BoardView
+{
+public:
+    using BoardView::BoardView;
+
+    QVector<QRegion> paintedRegions;
+protected:
+    void paintEvent(QPaintEvent *event) override {
+        paintedRegions.append(event->region());
+        BoardView::paintEvent(event);
+    }
+};
+
+class BoardViewTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QRect squareRect(const BoardView& view, QPoint pos) {
+        return BoardRenderer(view.size(), Color::White).getSquareRect(pos).toAlignedRect();
+    }
+
+    static void moveMouse(BoardView& view, QPoint pos) {
+        QPointF center = BoardRenderer(view.size(), Color::White).getSquareRect(pos).center();
+        QMouseEvent event(QEvent::MouseMove, center, view.mapToGlobal(center.toPoint()), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(&view, &event);
+    }
+
+    // Shows the view and waits until the first full paint is done
+    static bool showView(RecordingBoardView& view) {
+        view.resize(400, 400);
+        view.show();
+
+        if(!QTest::qWaitForWindowExposed(&view))
+        {
+            return false;
+        }
+
+        QTest::qWait(50);
+        view.paintedRegions.clear();
+        view.resetPaintCount();
+
+        return true;
+    }
+
+    // Whether the images show the same picture, allowing for rounding differences of the backends
+    static bool imagesMatch(const QImage& image, const QImage& expected) {
+        if(image.size() != expected.size())
+        {
+            return false;
+        }
+
+        QImage a = image.convertToFormat(QImage::Format_RGB32);
+        QImage b = expected.convertToFormat(QImage::Format_RGB32);
+
+        int differentPixels = 0;
+        for (int y = 0; y < a.height(); ++y) {
+            for (int x = 0; x < a.width(); ++x) {
+                QRgb pa = a.pixel(x, y);
+                QRgb pb = b.pixel(x, y);
+
+                int difference = std::max({std::abs(qRed(pa) - qRed(pb)), std::abs(qGreen(pa) - qGreen(pb)), std::abs(qBlue(pa) - qBlue(pb))});
+                differentPixels += difference > 8;
+            }
+        }
+
+        return differentPixels <= a.width() * a.height() / 1000;
+    }
+
+private slots:
+    void testHoverRepaintsOnlyTwoSquares() {
+        Position position;
+        RecordingBoardView view(&position.board());
+        QVERIFY(showView(view));
+
+        moveMouse(view, QPoint(3, 3));
+        QTRY_COMPARE(view.paintCount(), 1);
+        QCOMPARE(view.paintedRegions.first(), QRegion(squareRect(view, QPoint(3, 3))));
+
+        view.paintedRegions.clear();
+        view.resetPaintCount();
+
+        // the square that lost the hover and the one that got it, nothing else
+        moveMouse(view, QPoint(5, 4));
+        QTRY_COMPARE(view.paintCount(), 1);
+        QCOMPARE(view.paintedRegions.first(), QRegion(squareRect(view, QPoint(3, 3))) + squareRect(view, QPoint(5, 4)));
+
+        // moving within the square repaints nothing
+        view.resetPaintCount();
+        moveMouse(view, QPoint(5, 4));
+        QTest::qWait(50);
+        QCOMPARE(view.paintCount(), 0);
+    }
+
+    void testBatchRepaintsOnce() {
+        Position position;
+        RecordingBoardView view(&position.board());
+        QVERIFY(showView(view));
+
+        QVector<Move> knightMoves = position.getLegalMoves(QPoint(6, 7));
+        QCOMPARE(knightMoves.size(), 2);
+
+        {
+            BoardView::UpdateBatch batch(&view);
+
+            view.setHighlights({BoardView::Highlight{QPoint(4, 6), Qt::yellow}, BoardView::Highlight{QPoint(4, 4), Qt::yellow}});
+            view.setMoveIndicators(knightMoves);
+            view.addHighlight(QPoint(6, 7), Qt::white);
+
+            // nothing is scheduled while the batch is open, even if the event loop runs
+            QCoreApplication::processEvents();
+            QTest::qWait(20);
+            QCOMPARE(view.paintCount(), 0);
+        }
+
+        QTRY_COMPARE(view.paintCount(), 1);
+        QTest::qWait(50);
+        QCOMPARE(view.paintCount(), 1);
+
+        // only the squares that changed
+        QRegion changed;
+        for (QPoint pos : {QPoint(4, 6), QPoint(4, 4), QPoint(6, 7), QPoint(5, 5), QPoint(7, 5)}) {
+            changed += squareRect(view, pos);
+        }
+        QCOMPARE(view.paintedRegions.first(), changed);
+
+        // nested batches repaint once the outermost one ends
+        view.resetPaintCount();
+        {
+            BoardView::UpdateBatch outer(&view);
+            {
+                BoardView::UpdateBatch inner(&view);
+                view.clearHighlights();
+            }
+
+            QTest::qWait(20);
+            QCOMPARE(view.paintCount(), 0);
+
+            view.clearMoveIndicators();
+        }
+
+        QTRY_COMPARE(view.paintCount(), 1);
+        QTest::qWait(50);
+        QCOMPARE(view.paintCount(), 1);
+    }
+
+    void testEnPassantRepaintsTakenPawn() {
+        const char* fen = "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3";
+
+        // without and with an animation, the pawn taken on f5 is painted over either way
+        for (int duration : {0, 100}) {
+            Position position = *Position::fromFen(fen);
+            RecordingBoardView view(&position.board());
+            view.setAnimationDuration(duration);
+            QVERIFY(showView(view));
+
+            QVector<Move> moves = position.getLegalMoves(QPoint(4, 3));
+            auto enPassant = std::find_if(std::begin(moves), std::end(moves), [](const Move& move) {
+                return move.flags & EnPassant;
+            });
+            QVERIFY(enPassant != std::end(moves));
+
+            position.doMove(*enPassant);
+            view.animateMove(*enPassant);
+
+            QTRY_VERIFY(view.paintCount() > 0);
+            view.finishAnimation();
+            QTest::qWait(50);
+
+            QRegion painted;
+            for (const QRegion& region : view.paintedRegions) {
+                painted += region;
+            }
+
+            for (QPoint pos : {QPoint(5, 3), QPoint(4, 3), QPoint(5, 2)}) {
+                QRect rect = squareRect(view, pos);
+                QCOMPARE(painted.intersected(rect), QRegion(rect));
+            }
+        }
+    }
+
+    void testCachedLayersPaintTheBoard() {
+        Position position = *Position::fromFen("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+        RecordingBoardView view(&position.board());
+        QVERIFY(showView(view));
+
+        RenderOptions options;
+        options.highlightLastMove = false;
+
+        // the board layer and the sprite atlas are built at the first paint
+        options.size = view.size();
+        QVERIFY(imagesMatch(view.grab().toImage(), renderPositionImage(position, options)));
+
+        // and again once the size or the orientation changes
+        view.resize(300, 300);
+        options.size = view.size();
+        QVERIFY(imagesMatch(view.grab().toImage(), renderPositionImage(position, options)));
+
+        view.setViewForPlayer(Color::Black);
+        options.viewForPlayer = Color::Black;
+        QVERIFY(imagesMatch(view.grab().toImage(), renderPositionImage(position, options)));
+    }
+};
+
+QTEST_MAIN(BoardViewTest)
+#include "test_boardview.moc"
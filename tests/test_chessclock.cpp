@@ -0,0 +1,198 @@
+#include <QElapsedTimer>
+#include <QTest>
+
+#include "chess/chessclock.h"
+#include "chess/search.h"
+
+using namespace Chess;
+using namespace std::chrono;
+
+class ChessClockTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Any fixed point works, the clock only looks at differences
+    const ChessClock::TimePoint m_start = ChessClock::TimePoint() + hours(1);
+
+private slots:
+    void testParseTimeControl() {
+        std::optional<TimeControl> fischer = TimeControl::fromString("5+3");
+        QVERIFY(fischer);
+        QCOMPARE(fischer->baseMs, 300000);
+        QCOMPARE(fischer->incrementMs, 3000);
+        QCOMPARE(fischer->toString(), QString("5+3"));
+
+        std::optional<TimeControl> bronstein = TimeControl::fromString("3d2");
+        QVERIFY(bronstein);
+        QCOMPARE(bronstein->delayMs, 2000);
+        QCOMPARE(bronstein->incrementMs, 0);
+        QCOMPARE(bronstein->toString(), QString("3d2"));
+
+        std::optional<TimeControl> sessions = TimeControl::fromString(" 40/90+30 ");
+        QVERIFY(sessions);
+        QCOMPARE(sessions->movesPerSession, 40);
+        QCOMPARE(sessions->baseMs, 90 * 60000);
+        QCOMPARE(sessions->toString(), QString("40/90+30"));
+
+        QCOMPARE(TimeControl::fromString("0.5")->baseMs, 30000);
+
+        std::optional<TimeControl> untimed = TimeControl::fromString("");
+        QVERIFY(untimed && !untimed->isTimed());
+
+        QVERIFY(!TimeControl::fromString("five"));
+        QVERIFY(!TimeControl::fromString("5+"));
+        QVERIFY(!TimeControl::fromString("0+3"));
+    }
+
+    void testFischerIncrement() {
+        ChessClock clock(*TimeControl::fromString("5+3"));
+        clock.start(Color::White, m_start);
+
+        QCOMPARE(clock.remainingMs(Color::White, m_start + seconds(10)), 290000);
+        QVERIFY(clock.punch(m_start + seconds(10)));
+
+        // white's clock stopped with the increment, black's runs
+        QCOMPARE(clock.remainingMs(Color::White, m_start + seconds(60)), 293000);
+        QCOMPARE(clock.remainingMs(Color::Black, m_start + seconds(60)), 250000);
+        QVERIFY(clock.runningPlayer() == Color::Black);
+
+        QVERIFY(!clock.isOutOfTime(Color::Black, m_start + seconds(309)));
+        QVERIFY(clock.isOutOfTime(Color::Black, m_start + seconds(310)));
+        QVERIFY(!clock.isOutOfTime(Color::White, m_start + seconds(310)));
+
+        // a move after the flag fell doesn't count
+        QVERIFY(!clock.punch(m_start + seconds(311)));
+        QCOMPARE(clock.movesPlayed(Color::Black), 0);
+    }
+
+    void testBronsteinDelay() {
+        ChessClock clock(*TimeControl::fromString("3d2"));
+        clock.start(Color::White, m_start);
+
+        // the clock counts down during the delay like always
+        QCOMPARE(clock.remainingMs(Color::White, m_start + milliseconds(1500)), 178500);
+        QCOMPARE(clock.remainingMs(Color::White, m_start + milliseconds(5000)), 175000);
+
+        // and the time used comes back with the move, all of it within the delay
+        QVERIFY(clock.punch(m_start + milliseconds(1500)));
+        QCOMPARE(clock.remainingMs(Color::White, m_start + seconds(100)), 180000);
+        QCOMPARE(clock.remainingMs(Color::Black, m_start + milliseconds(11500)), 170000);
+
+        // at most the delay, unlike an increment it doesn't add up
+        QVERIFY(clock.punch(m_start + milliseconds(11500)));
+        QCOMPARE(clock.remainingMs(Color::Black, m_start + milliseconds(11500)), 172000);
+
+        QVERIFY(clock.punch(m_start + seconds(12)));
+        QCOMPARE(clock.remainingMs(Color::White, m_start + seconds(100)), 180000);
+        QCOMPARE(clock.remainingMs(Color::Black, m_start + seconds(100)), 84000);
+
+        // the refund comes too late for a flag that already fell
+        ChessClock flagging(*TimeControl::fromString("0.05d2"));
+        flagging.start(Color::White, m_start);
+        QVERIFY(flagging.isOutOfTime(Color::White, m_start + seconds(3)));
+        QVERIFY(!flagging.punch(m_start + milliseconds(3500)));
+        QCOMPARE(flagging.movesPlayed(Color::White), 0);
+    }
+
+    void testMovesPerSession() {
+        TimeControl timeControl;
+        timeControl.baseMs = 60000;
+        timeControl.movesPerSession = 2;
+
+        ChessClock clock(timeControl);
+        clock.start(Color::White, m_start);
+
+        ChessClock::TimePoint now = m_start;
+        for (int i = 0; i < 4; ++i) {
+            now += seconds(10);
+            QVERIFY(clock.punch(now));
+        }
+
+        // white used 20 seconds for the session and got a new minute for the next one
+        QCOMPARE(clock.movesPlayed(Color::White), 2);
+        QCOMPARE(clock.remainingMs(Color::White, now), 100000);
+    }
+
+    void testStop() {
+        ChessClock clock(*TimeControl::fromString("1"));
+        clock.start(Color::White, m_start);
+        clock.stop(m_start + seconds(20));
+
+        QVERIFY(!clock.runningPlayer());
+        QCOMPARE(clock.remainingMs(Color::White, m_start + hours(1)), 40000);
+        QVERIFY(!clock.isOutOfTime(Color::White, m_start + hours(1)));
+    }
+
+    void testAllocateMoveTime() {
+        TimeControl fischer = *TimeControl::fromString("5+3");
+
+        MoveTimeBudget budget = allocateMoveTime(fischer, 300000, 0);
+        QVERIFY(budget.softMs > 3000);
+        QVERIFY(budget.softMs <= budget.hardMs);
+        QVERIFY(budget.hardMs < 300000 / 4);
+
+        // less time left, less time per move
+        MoveTimeBudget shortBudget = allocateMoveTime(fischer, 30000, 40);
+        QVERIFY(shortBudget.softMs < budget.softMs);
+        QVERIFY(shortBudget.hardMs < 30000);
+
+        // the last move of a session may use everything but the overhead
+        TimeControl sessions = *TimeControl::fromString("2/1");
+        MoveTimeBudget lastMove = allocateMoveTime(sessions, 1000, 1);
+        QVERIFY(lastMove.hardMs < 1000);
+        QVERIFY(lastMove.softMs > 500);
+
+        // never nothing, an aborted search still returns a move
+        MoveTimeBudget flagging = allocateMoveTime(fischer, 5, 10);
+        QVERIFY(flagging.softMs >= 1 && flagging.hardMs >= 1);
+    }
+
+    void testSearchNodeLimitIsDeterministic() {
+        SearchLimits limits;
+        limits.depth = MAX_PLY;
+        limits.maxNodes = 20000;
+
+        SearchResult first = Search().search(Position(), limits);
+        SearchResult second = Search().search(Position(), limits);
+
+        QVERIFY(first.isAborted);
+        QVERIFY(first.bestMove);
+        QVERIFY(first.bestMove == second.bestMove);
+        QCOMPARE(first.nodes, second.nodes);
+        QCOMPARE(first.depth, second.depth);
+        QCOMPARE(first.score, second.score);
+    }
+
+    void testSearchTimeLimits() {
+        SearchLimits limits;
+        limits.depth = MAX_PLY;
+        limits.softTimeMs = 50;
+        limits.hardTimeMs = 200;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        SearchResult result = Search().search(Position(), limits);
+
+        QVERIFY(result.bestMove);
+        QVERIFY(result.depth > 0);
+        QVERIFY(timer.elapsed() < 400);
+
+        // aborted before the first iteration completed, there still is a move
+        SearchLimits tiny;
+        tiny.maxNodes = 1;
+        SearchResult aborted = Search().search(Position(), tiny);
+        QVERIFY(aborted.isAborted);
+        QVERIFY(aborted.bestMove);
+
+        std::atomic<bool> stop{true};
+        SearchLimits stopped;
+        stopped.depth = MAX_PLY;
+        stopped.stop = &stop;
+        QVERIFY(Search().search(Position(), stopped).bestMove);
+    }
+};
+
+QTEST_MAIN(ChessClockTest)
+#include "test_chessclock.moc"
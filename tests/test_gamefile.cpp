@@ -0,0 +1,167 @@
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtEndian>
+
+#include "chess/gamefile.h"
+
+#include <random>
+
+using namespace Chess;
+
+class GameFileTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Random legal moves from the start position, so every kind of move shows up over a few games
+    static SavedGame randomGame(uint32_t seed, const Position& startPosition = Position()) {
+        std::mt19937 random(seed);
+
+        SavedGame game;
+        game.settings.white = PlayerType::HardBot;
+        game.settings.openingBookSeed = seed;
+        game.settings.tablebasePath = "tables/ä";
+        game.history = MoveHistory(startPosition);
+
+        const char* timeControls[] = {"", "5+3", "3d2", "40/90+30"};
+        game.settings.timeControl = *TimeControl::fromString(timeControls[seed % 4]);
+
+        Position position = startPosition;
+        for (int i = 0; i < 80; ++i) {
+            QVector<Move> moves = position.getLegalMoves();
+            if(moves.empty())
+            {
+                break;
+            }
+
+            Move move = moves[random() % moves.size()];
+            position.doMove(move);
+            game.history.addMove(move);
+        }
+
+        return game;
+    }
+
+    static void compareGames(const SavedGame& actual, const SavedGame& expected) {
+        QCOMPARE(actual.history.basePosition().toFen(), expected.history.basePosition().toFen());
+        QVERIFY(actual.history.moves() == expected.history.moves());
+        QVERIFY(actual.settings.white == expected.settings.white);
+        QVERIFY(actual.settings.black == expected.settings.black);
+        QVERIFY(actual.settings.openingBookSeed == expected.settings.openingBookSeed);
+        QCOMPARE(actual.settings.tablebasePath, expected.settings.tablebasePath);
+        QVERIFY(actual.settings.timeControl == expected.settings.timeControl);
+    }
+
+    // A game file with the given version in its header
+    static QByteArray versionedGameFile(uint16_t version, const SavedGame& game) {
+        QByteArray data(GameFileHeader::SIZE, '\0');
+        qToLittleEndian<quint32>(GameFileHeader::MAGIC, data.data());
+        qToLittleEndian<quint16>(version, data.data() + 4);
+        data.append(encodeGameRecord(game));
+        return data;
+    }
+
+    QTemporaryDir m_directory;
+
+private slots:
+    void testGameFile() {
+        SavedGame game = randomGame(1, *Position::fromFen("r3k2r/pppq1ppp/8/8/8/8/PPPQ1PPP/R3K2R w KQkq - 0 1"));
+
+        QString path = m_directory.filePath("game.chessgame");
+        QVERIFY(saveGame(path, game));
+
+        std::optional<SavedGame> loaded = loadGame(path);
+        QVERIFY(loaded);
+        compareGames(*loaded, game);
+
+        // every part of the time control comes back
+        game.settings.timeControl.incrementMs = 1500;
+        game.settings.timeControl.delayMs = 2500;
+        game.settings.timeControl.movesPerSession = 40;
+        QVERIFY(saveGame(path, game));
+
+        loaded = loadGame(path);
+        QVERIFY(loaded);
+        compareGames(*loaded, game);
+    }
+
+    void testOlderVersions() {
+        SavedGame game = randomGame(4);
+
+        QString path = m_directory.filePath("old.chessgame");
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write(versionedGameFile(1, game)) > 0);
+        file.close();
+
+        // older records never have a time control and still load
+        std::optional<SavedGame> loaded = loadGame(path);
+        QVERIFY(loaded);
+        compareGames(*loaded, game);
+
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write(versionedGameFile(GameFileHeader::VERSION + 1, game)) > 0);
+        file.close();
+
+        QVERIFY(!loadGame(path));
+    }
+
+    void testRecordIsCompact() {
+        SavedGame game = randomGame(2);
+        game.settings.tablebasePath.clear();
+        game.settings.timeControl = TimeControl();
+
+        // two bytes per move on top of a few bytes of settings
+        QByteArray record = encodeGameRecord(game);
+        QVERIFY(record.size() <= 2 * game.history.moves().size() + 12);
+
+        // and a few more for a time control
+        game.settings.timeControl = *TimeControl::fromString("40/90+30");
+        QVERIFY(encodeGameRecord(game).size() <= record.size() + 10);
+    }
+
+    void testTruncatedRecords() {
+        QByteArray record = encodeGameRecord(randomGame(3));
+        const uchar* data = reinterpret_cast<const uchar*>(record.constData());
+
+        for (qsizetype size = 0; size < record.size(); ++size) {
+            QVERIFY(!decodeGameRecord(data, size));
+        }
+
+        QVERIFY(decodeGameRecord(data, record.size()));
+    }
+
+    void testArchive() {
+        QVector<SavedGame> games;
+        for (uint32_t seed = 0; seed < 100; ++seed) {
+            games.append(randomGame(seed));
+        }
+
+        QString path = m_directory.filePath("games.chessarchive");
+        QVERIFY(GameArchive::write(path, games));
+
+        GameArchive archive;
+        QVERIFY(archive.open(path));
+        QCOMPARE(archive.gameCount(), size_t(100));
+
+        for (int i : {99, 0, 42}) {
+            std::optional<SavedGame> game = archive.game(i);
+            QVERIFY(game);
+            compareGames(*game, games[i]);
+        }
+
+        QVERIFY(!archive.game(100));
+    }
+
+    void testRejectsOtherFiles() {
+        QString path = m_directory.filePath("game.chessgame");
+        QVERIFY(saveGame(path, randomGame(4)));
+
+        GameArchive archive;
+        QVERIFY(!archive.open(path));
+        QVERIFY(!loadGame(m_directory.filePath("missing.chessgame")));
+    }
+};
+
+QTEST_MAIN(GameFileTest)
+#include "test_gamefile.moc"
@@ -0,0 +1,313 @@
+#include <QBuffer>
+#include <QTcpSocket>
+#include <QTest>
+
+#include "chess/gameserver.h"
+#include "chess/loadgenerator.h"
+#include "chess/networkclient.h"
+#include "chess/networkprotocol.h"
+
+#include <memory>
+
+using namespace Chess;
+
+// Records everything one client receives
+struct ClientLog
+{
+    std::optional<uint32_t> gameId;
+    std::optional<Color> color;
+    bool isWatching = false;
+    bool hasStarted = false;
+    bool hasPlayerLeft = false;
+    int resyncCount = 0;
+    QStringList moves;
+    QStringList errors;
+};
+
+class GameServerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::unique_ptr<NetworkClient> connectClient(ClientLog& log) {
+        auto client = std::make_unique<NetworkClient>();
+
+        connect(client.get(), &NetworkClient::gameJoined, this, [&log](uint32_t gameId, Color color) {
+            log.gameId = gameId;
+            log.color = color;
+        });
+        connect(client.get(), &NetworkClient::watchingGame, this, [&log](uint32_t gameId) {
+            log.gameId = gameId;
+            log.isWatching = true;
+        });
+        connect(client.get(), &NetworkClient::gameStarted, this, [&log]() {
+            log.hasStarted = true;
+        });
+        connect(client.get(), &NetworkClient::moveReceived, this, [&log](const Move& move) {
+            log.moves.append(getUciNotation(move));
+        });
+        connect(client.get(), &NetworkClient::resynchronized, this, [&log]() {
+            log.resyncCount++;
+        });
+        connect(client.get(), &NetworkClient::playerLeft, this, [&log]() {
+            log.hasPlayerLeft = true;
+        });
+        connect(client.get(), &NetworkClient::errorReceived, this, [&log](const QString& message) {
+            log.errors.append(message);
+        });
+
+        client->connectToServer("127.0.0.1", m_server->serverPort());
+        return client;
+    }
+
+    // Connects two clients and starts a game between them, white creates it
+    void startGame(ClientLog& whiteLog, ClientLog& blackLog,
+                   std::unique_ptr<NetworkClient>& white, std::unique_ptr<NetworkClient>& black) {
+        white = connectClient(whiteLog);
+        black = connectClient(blackLog);
+        QTRY_VERIFY(white->isConnected() && black->isConnected());
+
+        white->createGame(Color::White);
+        QTRY_VERIFY(whiteLog.gameId);
+
+        black->joinGame(*whiteLog.gameId);
+        QTRY_VERIFY(whiteLog.hasStarted && blackLog.hasStarted);
+    }
+
+    static void playMove(NetworkClient& client, const char* notation) {
+        std::optional<Move> move = findUciMove(client.position(), notation);
+        QVERIFY(move);
+
+        client.sendMove(*move);
+    }
+
+    // Plays the first legal move until the game has the given number of plies, every move arrives before the next
+    static void playUntil(NetworkClient& white, NetworkClient& black, int ply) {
+        while(white.ply() < ply)
+        {
+            NetworkClient& mover = white.position().currentPlayer() == Color::White ? white : black;
+            NetworkClient& opponent = &mover == &white ? black : white;
+
+            int nextPly = mover.ply() + 1;
+            mover.sendMove(mover.position().getLegalMoves().first());
+            QTRY_COMPARE(opponent.ply(), nextPly);
+        }
+    }
+
+    std::unique_ptr<GameServer> m_server;
+
+private slots:
+    void init() {
+        m_server = std::make_unique<GameServer>(4);
+        QVERIFY(m_server->listen(QHostAddress::LocalHost, 0));
+    }
+
+    void cleanup() {
+        m_server.reset();
+    }
+
+    void testUciNotation() {
+        Position position = *Position::fromFen("8/1P5k/8/8/8/8/8/K7 w - - 0 1");
+
+        std::optional<Move> promotion = findUciMove(position, "b7b8n");
+        QVERIFY(promotion);
+        QCOMPARE(getUciNotation(*promotion), QString("b7b8n"));
+
+        QVERIFY(!findUciMove(position, "b7b8"));
+        QVERIFY(!findUciMove(position, "a1a3"));
+        QVERIFY(!findUciMove(position, "z9a1"));
+    }
+
+    void testMessageFraming() {
+        QByteArray payload("\x01\x02\x03", 3);
+        QByteArray frame = encodeMessage(MessageType::PlayMove, payload);
+        QCOMPARE(frame.size(), 6);
+
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+
+        // nothing until the whole frame is there
+        buffer.write(frame.left(4));
+        buffer.seek(0);
+        QVERIFY(!readMessage(buffer));
+
+        buffer.seek(4);
+        buffer.write(frame.mid(4));
+        buffer.seek(0);
+        std::optional<NetworkMessage> message = readMessage(buffer);
+        QVERIFY(message);
+        QVERIFY(message->type == MessageType::PlayMove);
+        QCOMPARE(message->payload, payload);
+        QVERIFY(buffer.atEnd());
+
+        QBuffer oversized;
+        oversized.setData(encodeMessage(MessageType::Error, QByteArray(MAX_MESSAGE_SIZE, 'x')));
+        oversized.open(QIODevice::ReadOnly);
+        message = readMessage(oversized);
+        QVERIFY(message && message->type == MessageType::Invalid);
+    }
+
+    void testPlayGame() {
+        ClientLog whiteLog, blackLog;
+        std::unique_ptr<NetworkClient> white, black;
+        startGame(whiteLog, blackLog, white, black);
+
+        QVERIFY(whiteLog.color == Color::White);
+        QVERIFY(blackLog.color == Color::Black);
+        QCOMPARE(m_server->gameCount(), 1);
+
+        playMove(*white, "f2f3");
+        QTRY_COMPARE(blackLog.moves, QStringList({"f2f3"}));
+
+        playMove(*black, "e7e5");
+        QTRY_COMPARE(white->ply(), 2);
+
+        // white thinks a while, the server measures it and both clients learn the time
+        QTest::qWait(50);
+        playMove(*white, "g2g4");
+        QTRY_COMPARE(black->ply(), 3);
+        playMove(*black, "d8h4");
+
+        QTRY_COMPARE(whiteLog.moves, QStringList({"e7e5", "d8h4"}));
+        QCOMPARE(blackLog.moves, QStringList({"f2f3", "g2g4"}));
+        QCOMPARE(white->position().hash(), black->position().hash());
+
+        QVERIFY(white->timeUsed(Color::White) >= 50);
+        QCOMPARE(white->timeUsed(Color::White), black->timeUsed(Color::White));
+        QTRY_COMPARE(black->timeUsed(Color::Black), white->timeUsed(Color::Black));
+
+        // the mate ends the game on the server
+        QTRY_COMPARE(m_server->gameCount(), 0);
+        QVERIFY(whiteLog.errors.isEmpty() && blackLog.errors.isEmpty());
+    }
+
+    void testOutOfTurnMoveResynchronizes() {
+        ClientLog whiteLog, blackLog;
+        std::unique_ptr<NetworkClient> white, black;
+        startGame(whiteLog, blackLog, white, black);
+
+        // black's client plays it, the server doesn't
+        playMove(*black, "e2e4");
+        QTRY_COMPARE(blackLog.errors.size(), 1);
+
+        // white's move doesn't fit black's position, black asks for a snapshot
+        playMove(*white, "d2d4");
+        QTRY_COMPARE(blackLog.resyncCount, 1);
+
+        QCOMPARE(black->ply(), 1);
+        QCOMPARE(black->position().hash(), white->position().hash());
+        QVERIFY(blackLog.moves.isEmpty());
+
+        playMove(*black, "d7d5");
+        QTRY_COMPARE(whiteLog.moves, QStringList({"d7d5"}));
+    }
+
+    void testSpectatorJoinsRunningGame() {
+        ClientLog whiteLog, blackLog, spectatorLog;
+        std::unique_ptr<NetworkClient> white, black;
+        startGame(whiteLog, blackLog, white, black);
+
+        playUntil(*white, *black, 5);
+
+        std::unique_ptr<NetworkClient> spectator = connectClient(spectatorLog);
+        QTRY_VERIFY(spectator->isConnected());
+
+        spectator->watchGame(*whiteLog.gameId);
+        QTRY_VERIFY(spectatorLog.hasStarted);
+        QVERIFY(spectatorLog.isWatching);
+        QCOMPARE(spectator->ply(), 5);
+        QCOMPARE(spectator->position().hash(), white->position().hash());
+
+        // past a few checksums, nobody gets out of sync
+        playUntil(*white, *black, 3 * CHECKSUM_INTERVAL + 1);
+        QTRY_COMPARE(spectator->ply(), 3 * CHECKSUM_INTERVAL + 1);
+
+        QCOMPARE(spectatorLog.moves.size(), 3 * CHECKSUM_INTERVAL + 1 - 5);
+        QCOMPARE(spectator->position().hash(), white->position().hash());
+        QCOMPARE(spectatorLog.resyncCount + whiteLog.resyncCount + blackLog.resyncCount, 0);
+
+        // spectators can't play
+        spectator->sendMove(spectator->position().getLegalMoves().first());
+        QTRY_COMPARE(spectatorLog.errors.size(), 1);
+
+        // or end the game by leaving
+        spectator.reset();
+        QTest::qWait(50);
+        QVERIFY(!whiteLog.hasPlayerLeft);
+        QCOMPARE(m_server->gameCount(), 1);
+    }
+
+    void testPlayerLeft() {
+        ClientLog whiteLog, blackLog, spectatorLog;
+        std::unique_ptr<NetworkClient> white, black;
+        startGame(whiteLog, blackLog, white, black);
+
+        std::unique_ptr<NetworkClient> spectator = connectClient(spectatorLog);
+        QTRY_VERIFY(spectator->isConnected());
+        spectator->watchGame(*whiteLog.gameId);
+        QTRY_VERIFY(spectatorLog.hasStarted);
+
+        black.reset();
+
+        QTRY_VERIFY(whiteLog.hasPlayerLeft);
+        QTRY_VERIFY(spectatorLog.hasPlayerLeft);
+        QTRY_COMPARE(m_server->gameCount(), 0);
+    }
+
+    void testJoinFullGame() {
+        ClientLog whiteLog, blackLog, thirdLog;
+        std::unique_ptr<NetworkClient> white, black;
+        startGame(whiteLog, blackLog, white, black);
+
+        std::unique_ptr<NetworkClient> third = connectClient(thirdLog);
+        QTRY_VERIFY(third->isConnected());
+
+        third->joinGame(*whiteLog.gameId);
+        QTRY_COMPARE(thirdLog.errors.size(), 1);
+        QVERIFY(!thirdLog.gameId);
+    }
+
+    void testManyIdleConnections() {
+        // two sockets per connection in this process, stay below the usual limit of 1024 open files
+        static constexpr int CONNECTION_COUNT = 400;
+
+        std::vector<std::unique_ptr<QTcpSocket>> sockets;
+        for (int i = 0; i < CONNECTION_COUNT; ++i) {
+            sockets.push_back(std::make_unique<QTcpSocket>());
+            sockets.back()->connectToHost(QHostAddress::LocalHost, m_server->serverPort());
+        }
+
+        QTRY_COMPARE_WITH_TIMEOUT(m_server->connectionCount(), CONNECTION_COUNT, 10000);
+
+        // idle connections don't keep anyone else from playing
+        ClientLog whiteLog, blackLog;
+        std::unique_ptr<NetworkClient> white, black;
+        startGame(whiteLog, blackLog, white, black);
+
+        sockets.clear();
+        QTRY_COMPARE_WITH_TIMEOUT(m_server->connectionCount(), 2, 10000);
+    }
+
+    void testLoadGenerator() {
+        LoadOptions options;
+        options.port = m_server->serverPort();
+        options.playerCount = 8;
+        options.spectatorCount = 8;
+        options.durationMs = 500;
+        options.maxPly = 20;
+
+        LoadReport report = LoadGenerator(options).run();
+
+        QCOMPARE(report.errorCount, uint64_t(0));
+        QVERIFY(report.gameCount > 4);
+        QVERIFY(report.moveCount > 0);
+        QVERIFY(report.messageCount > report.moveCount);
+        QVERIFY(report.p99LatencyMs >= report.p50LatencyMs);
+        QVERIFY(report.messagesPerSecond() > 0);
+
+        QTRY_COMPARE(m_server->connectionCount(), 0);
+    }
+};
+
+QTEST_MAIN(GameServerTest)
+#include "test_gameserver.moc"
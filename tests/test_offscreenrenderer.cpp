@@ -0,0 +1,326 @@
+#include <QFile>
+#include <QImageReader>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "chess/boardrenderer.h"
+#include "chess/gifwriter.h"
+#include "chess/offscreenrenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <optional>
+#include <random>
+
+using namespace Chess;
+
+class OffscreenRendererTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static Move findMove(const Position& position, QPoint from, QPoint to) {
+        QVector<Move> moves = position.getLegalMoves();
+        auto move = std::find_if(std::begin(moves), std::end(moves), [&](const Move& move) {
+            return move.from == from && move.to == to;
+        });
+
+        assert(move != std::end(moves));
+        return *move;
+    }
+
+    // 1. e4 e5 2. Nf3
+    static MoveHistory openingGame() {
+        MoveHistory history{Position()};
+        Position position;
+
+        for (auto [from, to] : {std::pair{QPoint(4, 6), QPoint(4, 4)}, std::pair{QPoint(4, 1), QPoint(4, 3)}, std::pair{QPoint(6, 7), QPoint(5, 5)}}) {
+            Move move = findMove(position, from, to);
+            history.addMove(move);
+            position.doMove(move);
+        }
+
+        return history;
+    }
+
+    // A pixel near the corner of the square, where no piece is drawn
+    static QColor squareCornerColor(const QImage& image, QPoint square) {
+        QSize squareSize = image.size() / Board::WIDTH;
+        return image.pixelColor(square.x() * squareSize.width() + 2, square.y() * squareSize.height() + 2);
+    }
+
+    // Whether a decoded GIF frame shows the rendered image. The palette of each frame and the
+    // dithering change single pixels, so the images are compared in blocks of 8x8 pixels.
+    static bool framesMatch(const QImage& frame, const QImage& image) {
+        if(frame.size() != image.size())
+        {
+            return false;
+        }
+
+        QImage a = frame.convertToFormat(QImage::Format_RGB32);
+        QImage b = image.convertToFormat(QImage::Format_RGB32);
+
+        for (int blockY = 0; blockY + 8 <= a.height(); blockY += 8) {
+            for (int blockX = 0; blockX + 8 <= a.width(); blockX += 8) {
+                std::array<int, 3> difference = {0, 0, 0};
+
+                for (int y = blockY; y < blockY + 8; ++y) {
+                    for (int x = blockX; x < blockX + 8; ++x) {
+                        QRgb pa = a.pixel(x, y);
+                        QRgb pb = b.pixel(x, y);
+                        difference[0] += qRed(pa) - qRed(pb);
+                        difference[1] += qGreen(pa) - qGreen(pb);
+                        difference[2] += qBlue(pa) - qBlue(pb);
+                    }
+                }
+
+                for (int channel : difference) {
+                    if(std::abs(channel) > 16 * 64)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Decodes the first image of a GIF file exactly like the format specifies, rejecting any stream
+    // that doesn't end with an end code of the width the decoder is at
+    static std::optional<QVector<QRgb>> decodeFirstGifImage(const QByteArray& file) {
+        const uchar* data = reinterpret_cast<const uchar*>(file.constData());
+        qsizetype size = file.size();
+
+        // header and logical screen descriptor, without a global color table
+        qsizetype pos = 13;
+
+        auto readSubBlocks = [&](QByteArray* out) {
+            while(pos < size && data[pos] != 0)
+            {
+                int length = data[pos];
+                if(out)
+                {
+                    out->append(file.mid(pos + 1, length));
+                }
+                pos += length + 1;
+            }
+            pos++;
+        };
+
+        // extensions
+        while(pos < size && data[pos] == 0x21)
+        {
+            pos += 2;
+            readSubBlocks(nullptr);
+        }
+
+        if(pos + 10 > size || data[pos] != 0x2c)
+        {
+            return std::nullopt;
+        }
+
+        int width = data[pos + 5] | data[pos + 6] << 8;
+        int height = data[pos + 7] | data[pos + 8] << 8;
+        int colorCount = 2 << (data[pos + 9] & 0x7);
+        pos += 10;
+
+        QVector<QRgb> colorTable;
+        for (int i = 0; i < colorCount; ++i) {
+            colorTable.append(qRgb(data[pos], data[pos + 1], data[pos + 2]));
+            pos += 3;
+        }
+
+        int minCodeSize = data[pos++];
+        QByteArray codes;
+        readSubBlocks(&codes);
+
+        const uint32_t clearCode = 1 << minCodeSize;
+        const uint32_t endCode = clearCode + 1;
+
+        QVector<QByteArray> table(4096);
+        for (uint32_t i = 0; i < clearCode; ++i) {
+            table[i] = QByteArray(1, static_cast<char>(i));
+        }
+
+        int codeSize = minCodeSize + 1;
+        uint32_t nextCode = endCode + 1;
+        std::optional<uint32_t> previous;
+        QByteArray indices;
+
+        qsizetype bitPos = 0;
+        while(true)
+        {
+            if(bitPos + codeSize > codes.size() * 8)
+            {
+                return std::nullopt;
+            }
+
+            uint32_t code = 0;
+            for (int bit = 0; bit < codeSize; ++bit, ++bitPos) {
+                code |= ((static_cast<uchar>(codes[bitPos / 8]) >> (bitPos % 8)) & 1) << bit;
+            }
+
+            if(code == clearCode)
+            {
+                codeSize = minCodeSize + 1;
+                nextCode = endCode + 1;
+                previous.reset();
+                continue;
+            }
+
+            if(code == endCode)
+            {
+                // nothing may follow the end code but the padding of its last byte
+                bool isComplete = (bitPos + 7) / 8 == codes.size() && indices.size() == width * height;
+                if(!isComplete)
+                {
+                    return std::nullopt;
+                }
+                break;
+            }
+
+            QByteArray entry;
+            if(!previous)
+            {
+                if(code >= clearCode)
+                {
+                    return std::nullopt;
+                }
+                entry = table[code];
+            }
+            else
+            {
+                if(code < nextCode)
+                {
+                    entry = table[code];
+                }
+                else if(code == nextCode)
+                {
+                    entry = table[*previous] + table[*previous][0];
+                }
+                else
+                {
+                    return std::nullopt;
+                }
+
+                if(nextCode < 4096)
+                {
+                    table[nextCode++] = table[*previous] + entry[0];
+                    if(nextCode == (1u << codeSize) && codeSize < 12)
+                    {
+                        codeSize++;
+                    }
+                }
+            }
+
+            indices.append(entry);
+            previous = code;
+        }
+
+        QVector<QRgb> pixels;
+        for (char index : indices) {
+            pixels.append(colorTable[static_cast<uchar>(index)]);
+        }
+
+        return pixels;
+    }
+
+    QTemporaryDir m_directory;
+
+private slots:
+    void initTestCase() {
+        QVERIFY(m_directory.isValid());
+    }
+
+    void testRenderPosition() {
+        Position position = *Position::fromFen("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+
+        RenderOptions options;
+        options.size = QSize(240, 240);
+
+        QImage image = renderPositionImage(position, options);
+        QCOMPARE(image.size(), QSize(240, 240));
+        QCOMPARE(squareCornerColor(image, QPoint(0, 0)), BoardRenderer::LIGHT_COLOR);
+        QCOMPARE(squareCornerColor(image, QPoint(1, 0)), BoardRenderer::DARK_COLOR);
+
+        // viewed from black the corners swap, but the light squares stay light
+        options.viewForPlayer = Color::Black;
+        QImage flipped = renderPositionImage(position, options);
+        QCOMPARE(squareCornerColor(flipped, QPoint(0, 0)), BoardRenderer::LIGHT_COLOR);
+        QVERIFY(flipped != image);
+    }
+
+    void testRenderGameImages() {
+        MoveHistory history = openingGame();
+
+        QVector<QImage> images = renderGameImages(history, RenderOptions());
+        QCOMPARE(images.size(), 4);
+        QVERIFY(images[0] != images[1]);
+    }
+
+    void testRenderFilesInParallel() {
+        MoveHistory history = openingGame();
+
+        OffscreenRenderer renderer(4);
+        for (int i = 0; i < 8; ++i) {
+            renderer.renderPosition(Position(), m_directory.filePath(QString("position_%1.png").arg(i)));
+        }
+        renderer.renderGame(history, m_directory.filePath("game.gif"));
+        renderer.renderGame(history, m_directory.filePath("game.png"));
+        renderer.waitForDone();
+
+        QCOMPARE(renderer.finishedCount(), 10);
+        QCOMPARE(renderer.failedCount(), 0);
+
+        QCOMPARE(QImage(m_directory.filePath("position_7.png")).size(), RenderOptions().size);
+        QVERIFY(QFile::exists(m_directory.filePath("game_003.png")));
+
+        QImageReader reader(m_directory.filePath("game.gif"));
+        QVERIFY(reader.supportsAnimation());
+        QCOMPARE(reader.imageCount(), 4);
+
+        // every frame shows its position
+        QVector<QImage> images = renderGameImages(history, RenderOptions());
+        for (const QImage& image : images) {
+            QImage frame = reader.read();
+            QVERIFY2(!frame.isNull(), qPrintable(reader.errorString()));
+            QVERIFY(framesMatch(frame, image));
+        }
+    }
+
+    void testGifCodeWidths() {
+        // Rows of random pixels of every length up to two changes of the LZW code size,
+        // one of them ends right where the decoder widens its codes
+        std::mt19937 random(1);
+
+        for (int width = 1; width <= 1400; ++width) {
+            QImage image(width, 1, QImage::Format_RGB32);
+            for (int x = 0; x < width; ++x) {
+                int value = random() % 16;
+                image.setPixel(x, 0, qRgb(value * 16, 255 - value * 16, value % 2 * 255));
+            }
+
+            QString path = m_directory.filePath("row.gif");
+            GifWriter writer;
+            QVERIFY(writer.open(path, image.size()));
+            QVERIFY(writer.addFrame(image, 100));
+            QVERIFY(writer.close());
+
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::ReadOnly));
+
+            std::optional<QVector<QRgb>> pixels = decodeFirstGifImage(file.readAll());
+            QVERIFY2(pixels, qPrintable(QString("row of %1 pixels").arg(width)));
+
+            // up to 256 colors are kept exactly
+            for (int x = 0; x < width; ++x) {
+                QCOMPARE((*pixels)[x], image.pixel(x, 0));
+            }
+        }
+    }
+};
+
+QTEST_MAIN(OffscreenRendererTest)
+#include "test_offscreenrenderer.moc"
@@ -0,0 +1,184 @@
+#include <QTest>
+#include <QTemporaryDir>
+
+#include "chess/openingbook.h"
+
+using namespace Chess;
+
+class OpeningBookTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Polyglot numbers squares from a1 = 0 to h8 = 63
+    static uint16_t bookMove(int from, int to, int promotion = 0) {
+        return (promotion << 12) | (from << 6) | to;
+    }
+
+    static int bookSquare(const char* square) {
+        return (square[1] - '1') * 8 + (square[0] - 'a');
+    }
+
+    static uint16_t bookMove(const char* from, const char* to, int promotion = 0) {
+        return bookMove(bookSquare(from), bookSquare(to), promotion);
+    }
+
+    QTemporaryDir m_directory;
+
+private slots:
+    void initTestCase() {
+        QVERIFY(m_directory.isValid());
+    }
+
+    void testPolyglotKeys() {
+        // the test positions of the Polyglot book format specification
+        const std::pair<const char*, uint64_t> positions[] = {
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463b96181691fc9cull},
+            {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823c9b50fd114196ull},
+            {"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756b94461c50fb0ull},
+            {"rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662fafb965db29d4ull},
+            {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22a48b5a8e47ff78ull},
+            {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652a607ca3f242c1ull},
+            {"rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00fdd303c946bdd9ull},
+            {"rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3c8123ea7b067637ull},
+            {"rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5c3f9b829b279560ull},
+        };
+
+        for (const auto& [fen, key] : positions) {
+            QCOMPARE(Position::fromFen(fen)->hash(), key);
+        }
+
+        QCOMPARE(Position().hash(), 0x463b96181691fc9cull);
+    }
+
+    void testDecodeMove() {
+        Position start;
+
+        std::optional<Move> e4 = OpeningBook::decodeMove(start, bookMove("e2", "e4"));
+        QVERIFY(e4);
+        QVERIFY(e4->from == QPoint(4, 6) && e4->to == QPoint(4, 4));
+        QVERIFY(e4->flags & TwoSquareAdvance);
+        QCOMPARE(OpeningBook::encodeMove(*e4), bookMove("e2", "e4"));
+
+        // moves that aren't legal in the position are dropped
+        QVERIFY(!OpeningBook::decodeMove(start, bookMove("e2", "e5")));
+        QVERIFY(!OpeningBook::decodeMove(start, bookMove("e4", "e5")));
+
+        // castling is stored as the king taking its own rook
+        Position castling = *Position::fromFen("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+
+        std::optional<Move> kingSide = OpeningBook::decodeMove(castling, bookMove("e1", "h1"));
+        QVERIFY(kingSide && (kingSide->flags & CastleKingSide));
+        QVERIFY(kingSide->to == QPoint(6, 7));
+        QCOMPARE(OpeningBook::encodeMove(*kingSide), bookMove("e1", "h1"));
+
+        std::optional<Move> queenSide = OpeningBook::decodeMove(castling, bookMove("e1", "a1"));
+        QVERIFY(queenSide && (queenSide->flags & CastleQueenSide));
+        QVERIFY(queenSide->to == QPoint(2, 7));
+        QCOMPARE(OpeningBook::encodeMove(*queenSide), bookMove("e1", "a1"));
+
+        castling.doMove(*kingSide);
+        std::optional<Move> blackQueenSide = OpeningBook::decodeMove(castling, bookMove("e8", "a8"));
+        QVERIFY(blackQueenSide && (blackQueenSide->flags & CastleQueenSide));
+        QVERIFY(blackQueenSide->to == QPoint(2, 0));
+
+        // a king next to its rook just moves there
+        Position kingMove = *Position::fromFen("4k3/8/8/8/8/8/8/4KR2 w - - 0 1");
+        QVERIFY(!OpeningBook::decodeMove(kingMove, bookMove("e1", "f1")));
+        QVERIFY(OpeningBook::decodeMove(kingMove, bookMove("e1", "d1")));
+
+        Position promotion = *Position::fromFen("7k/P7/8/8/8/8/8/K7 w - - 0 1");
+
+        std::optional<Move> queen = OpeningBook::decodeMove(promotion, bookMove("a7", "a8", 4));
+        QVERIFY(queen && (queen->flags & PromotionQueen));
+        QCOMPARE(OpeningBook::encodeMove(*queen), bookMove("a7", "a8", 4));
+
+        std::optional<Move> knight = OpeningBook::decodeMove(promotion, bookMove("a7", "a8", 1));
+        QVERIFY(knight && (knight->flags & PromotionKnight));
+
+        // a promotion needs its piece
+        QVERIFY(!OpeningBook::decodeMove(promotion, bookMove("a7", "a8")));
+    }
+
+    void testFindEntries() {
+        // long runs of duplicate keys, so the binary search lands in the middle of them
+        QVector<BookEntry> entries;
+        for (uint16_t i = 0; i < 100; ++i) {
+            entries.append(BookEntry{.key = 5, .move = i, .weight = 1, .learn = 0});
+            entries.append(BookEntry{.key = 7, .move = i, .weight = 1, .learn = 0});
+        }
+        entries.append(BookEntry{.key = 1, .move = 0, .weight = 1, .learn = 0});
+        entries.append(BookEntry{.key = UINT64_MAX, .move = 0, .weight = 1, .learn = 0});
+
+        QString path = m_directory.filePath("duplicates.bin");
+        QVERIFY(OpeningBook::write(path, entries));
+
+        OpeningBook book;
+        QVERIFY(book.open(path));
+        QCOMPARE(book.entryCount(), size_t(202));
+
+        for (uint64_t key : {5, 7}) {
+            QVector<BookEntry> found = book.findEntries(key);
+            QCOMPARE(found.size(), 100);
+
+            // every entry of the key, in the order they were written
+            for (int i = 0; i < found.size(); ++i) {
+                QCOMPARE(found[i].key, key);
+                QCOMPARE(found[i].move, uint16_t(i));
+            }
+        }
+
+        QCOMPARE(book.findEntries(1).size(), 1);
+        QCOMPARE(book.findEntries(UINT64_MAX).size(), 1);
+        QVERIFY(book.findEntries(0).empty());
+        QVERIFY(book.findEntries(6).empty());
+        QVERIFY(book.findEntries(8).empty());
+    }
+
+    void testWeightedPick() {
+        uint64_t key = Position().hash();
+
+        QVector<BookEntry> entries = {
+            BookEntry{.key = key, .move = bookMove("e2", "e4"), .weight = 3, .learn = 0},
+            BookEntry{.key = key, .move = bookMove("d2", "d4"), .weight = 1, .learn = 0},
+            // never picked, without weight or not legal
+            BookEntry{.key = key, .move = bookMove("g1", "f3"), .weight = 0, .learn = 0},
+            BookEntry{.key = key, .move = bookMove("e2", "e5"), .weight = 100, .learn = 0},
+        };
+
+        QString path = m_directory.filePath("weights.bin");
+        QVERIFY(OpeningBook::write(path, entries));
+
+        OpeningBook book;
+        QVERIFY(book.open(path));
+
+        std::mt19937 random(7);
+        int e4 = 0;
+        int d4 = 0;
+        QVector<Move> picks;
+
+        for (int i = 0; i < 4000; ++i) {
+            std::optional<Move> move = book.pickMove(Position(), random);
+            QVERIFY(move);
+            picks.append(*move);
+
+            e4 += move->to == QPoint(4, 4);
+            d4 += move->to == QPoint(3, 4);
+        }
+
+        QCOMPARE(e4 + d4, 4000);
+        QVERIFY(e4 > 2800 && e4 < 3200);
+
+        // the same seed picks the same moves
+        std::mt19937 replay(7);
+        for (const Move& move : picks) {
+            QVERIFY(book.pickMove(Position(), replay) == move);
+        }
+
+        // positions that aren't in the book
+        QVERIFY(!book.pickMove(*Position::fromFen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"), random));
+    }
+};
+
+QTEST_MAIN(OpeningBookTest)
+#include "test_openingbook.moc"
@@ -0,0 +1,103 @@
+#include <QTest>
+
+#include <random>
+
+#include "chess/evaluation.h"
+#include "chess/pawnhash.h"
+
+using namespace Chess;
+
+class PawnHashTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Positions along a random game from Kiwipete, which has every kind of move
+    static QVector<Position> randomPositions(uint32_t seed, int count) {
+        std::mt19937 random(seed);
+        Position position = *Position::fromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+        QVector<Position> positions;
+        while(positions.size() < count)
+        {
+            QVector<Move> moves = position.getLegalMoves();
+            if(moves.empty())
+            {
+                break;
+            }
+
+            position.doMove(moves[random() % moves.size()]);
+            positions.append(position);
+        }
+
+        return positions;
+    }
+
+private slots:
+    void testPawnKeyOnlyFollowsPawns() {
+        int pawnMoves = 0;
+        int otherMoves = 0;
+
+        for (const Position& position : randomPositions(1, 30)) {
+            for (const Move& move : position.getLegalMoves()) {
+                bool touchesPawns = move.piece.type == PieceType::Pawn || (move.capture && move.capture->type == PieceType::Pawn);
+                Position next = position.nextPosition(move);
+
+                QCOMPARE(next.pawnKey() != position.pawnKey(), touchesPawns);
+
+                pawnMoves += touchesPawns;
+                otherMoves += !touchesPawns;
+            }
+        }
+
+        QVERIFY(pawnMoves > 0);
+        QVERIFY(otherMoves > 0);
+    }
+
+    void testSamePawnsHitTheTable() {
+        PawnHashTable& table = PawnHashTable::forCurrentThread();
+        table.clear();
+        table.resetStats();
+
+        Position position;
+        evaluate(position);
+        QCOMPARE(table.stats().probes, uint64_t(1));
+        QCOMPARE(table.stats().hits, uint64_t(0));
+
+        // a knight move keeps the pawn structure
+        Position next = *Position::fromFen("rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 0 1");
+        QCOMPARE(next.pawnKey(), position.pawnKey());
+
+        evaluate(next);
+        QCOMPARE(table.stats().probes, uint64_t(2));
+        QCOMPARE(table.stats().hits, uint64_t(1));
+        QCOMPARE(table.stats().hitRate(), 0.5);
+    }
+
+    void testCachedEqualsUncached() {
+        PawnHashTable& table = PawnHashTable::forCurrentThread();
+
+        // a tiny table makes different pawn structures replace each other
+        table.resize(4);
+        table.resetStats();
+
+        for (const Position& position : randomPositions(2, 60)) {
+            PawnStructure uncached = analyzePawnStructure(position.board());
+            const PawnStructure& cached = table.probe(position.pawnKey(), position.board());
+
+            QVERIFY(cached.score == uncached.score);
+            QVERIFY(cached.passedPawns == uncached.passedPawns);
+
+            int cachedScore = evaluate(position);
+            table.clear();
+            QCOMPARE(evaluate(position), cachedScore);
+        }
+
+        QVERIFY(table.stats().hits > 0);
+
+        table.resize(PawnHashTable::DEFAULT_ENTRY_COUNT);
+    }
+};
+
+QTEST_MAIN(PawnHashTest)
+#include "test_pawnhash.moc"
@@ -0,0 +1,65 @@
+#include <QApplication>
+#include <QPluginLoader>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "project_hub/pluginprojects.h"
+
+class PluginProjectsTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QString chessPluginPath() {
+        QDir directory(PROJECT_PLUGIN_DIR);
+        for (const QString& fileName : directory.entryList(QDir::Files)) {
+            if(QLibrary::isLibrary(fileName))
+            {
+                return directory.absoluteFilePath(fileName);
+            }
+        }
+
+        return QString();
+    }
+
+private slots:
+    void testDiscoverWithoutLoading() {
+        QString pluginPath = chessPluginPath();
+        QVERIFY(!pluginPath.isEmpty());
+
+        QVector<Project> projects = discoverPluginProjects(PROJECT_PLUGIN_DIR);
+        QCOMPARE(projects.count(), 1);
+        QCOMPARE(projects[0].title, QString("Chess Game"));
+        QCOMPARE(projects[0].type, ProjectType::QtWidgets);
+        QVERIFY(!projects[0].shortDescription.isEmpty());
+
+        QVERIFY(!QPluginLoader(pluginPath).isLoaded());
+
+        projects[0].launch();
+
+        QVERIFY(QPluginLoader(pluginPath).isLoaded());
+
+        QWidgetList windows = QApplication::topLevelWidgets();
+        QVERIFY(std::any_of(windows.begin(), windows.end(), [](QWidget* window) {
+            return window->inherits("Chess::MainWindow");
+        }));
+
+        qDeleteAll(windows);
+    }
+
+    void testSkipsOtherFiles() {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+
+        QFile notAPlugin(directory.filePath(QFileInfo(chessPluginPath()).fileName()));
+        QVERIFY(notAPlugin.open(QIODevice::WriteOnly));
+        notAPlugin.write("not a library");
+        notAPlugin.close();
+
+        QVERIFY(discoverPluginProjects(directory.path()).isEmpty());
+        QVERIFY(discoverPluginProjects(directory.filePath("missing")).isEmpty());
+    }
+};
+
+QTEST_MAIN(PluginProjectsTest)
+#include "test_pluginprojects.moc"
@@ -0,0 +1,135 @@
+#include <QTest>
+
+#include <random>
+
+#include "chess/chess.h"
+
+using namespace Chess;
+
+class PositionTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Everything doMove and undoMove keep up to date, hash() covers the piece key
+    struct IncrementalState
+    {
+        QString fen;
+        Score pieceSquareScore;
+        int phase;
+        uint64_t pawnKey;
+        uint64_t hash;
+        int pieceCount;
+
+        explicit IncrementalState(const Position& position)
+            : fen(position.toFen()),
+            pieceSquareScore(position.pieceSquareScore()),
+            phase(position.phase()),
+            pawnKey(position.pawnKey()),
+            hash(position.hash()),
+            pieceCount(position.pieceCount())
+        {
+        }
+
+        bool operator==(const IncrementalState& other) const {
+            return fen == other.fen && pieceSquareScore == other.pieceSquareScore && phase == other.phase
+                   && pawnKey == other.pawnKey && hash == other.hash && pieceCount == other.pieceCount;
+        }
+    };
+
+    // The state of a position set up from scratch, which computes everything in one go
+    static IncrementalState recomputedState(const Position& position) {
+        return IncrementalState(*Position::fromFen(position.toFen()));
+    }
+
+    // Counts the leaf nodes of the legal move tree, the standard check of a move generator
+    static uint64_t perft(Position& position, int depth) {
+        if(depth == 0)
+        {
+            return 1;
+        }
+
+        uint64_t nodes = 0;
+        for (const Move& move : position.getLegalMoves()) {
+            position.doMove(move);
+            nodes += perft(position, depth - 1);
+            position.undoMove(move);
+        }
+
+        return nodes;
+    }
+
+private slots:
+    void testUndoRestoresIncrementalState() {
+        const char* fens[] = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            // castling both ways for both sides
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            // en passant right away
+            "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+            // promotions and underpromotions with and without captures
+            "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        };
+
+        std::mt19937 random(2024);
+
+        int castles = 0;
+        int enPassants = 0;
+        int promotions = 0;
+
+        for (const char* fen : fens) {
+            for (int game = 0; game < 10; ++game) {
+                Position position = *Position::fromFen(fen);
+
+                for (int ply = 0; ply < 40; ++ply) {
+                    QVector<Move> moves = position.getLegalMoves();
+                    if(moves.empty())
+                    {
+                        break;
+                    }
+
+                    IncrementalState before(position);
+                    QVERIFY2(before == recomputedState(position), qPrintable(before.fen));
+
+                    for (const Move& move : moves) {
+                        castles += (move.flags & (CastleKingSide | CastleQueenSide)) != 0;
+                        enPassants += (move.flags & EnPassant) != 0;
+                        promotions += (move.flags & PromotionAny) != 0;
+
+                        position.doMove(move);
+                        QVERIFY2(IncrementalState(position) == recomputedState(position), qPrintable(position.toFen()));
+
+                        position.undoMove(move);
+                        QVERIFY2(IncrementalState(position) == before, qPrintable(before.fen));
+                    }
+
+                    position.doMove(moves[random() % moves.size()]);
+                }
+            }
+        }
+
+        QVERIFY(castles > 0);
+        QVERIFY(enPassants > 0);
+        QVERIFY(promotions > 0);
+    }
+
+    void testPerft() {
+        // published node counts, deep enough for castling through attacked squares,
+        // blocked double pushes, en passant pins and promotions with check
+        const struct { const char* fen; int depth; uint64_t nodes; } positions[] = {
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281},
+            {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862},
+            {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 4, 43238},
+            {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467},
+            {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379},
+        };
+
+        for (const auto& [fen, depth, nodes] : positions) {
+            Position position = *Position::fromFen(fen);
+            QCOMPARE(perft(position, depth), nodes);
+        }
+    }
+};
+
+QTEST_MAIN(PositionTest)
+#include "test_position.moc"
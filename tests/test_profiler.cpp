@@ -0,0 +1,99 @@
+#include <QTest>
+
+#include "chess/profiler.h"
+
+#include <thread>
+
+using namespace Chess;
+
+// Work the compiler can't drop, so the timed scopes take some time
+static uint64_t spin(int iterations)
+{
+    static volatile uint64_t sink = 0;
+    for (int i = 0; i < iterations; ++i) {
+        sink = sink + i;
+    }
+    return sink;
+}
+
+static void inner()
+{
+    CHESS_PROFILE_SCOPE("test inner");
+    spin(20000);
+}
+
+static void outer()
+{
+    CHESS_PROFILE_SCOPE("test outer");
+    spin(20000);
+
+    for (int i = 0; i < 3; ++i) {
+        inner();
+    }
+}
+
+static std::optional<ProfileEntry> findEntry(const QString& name)
+{
+    for (const ProfileEntry& entry : Profiler::entries()) {
+        if(entry.name == name)
+        {
+            return entry;
+        }
+    }
+
+    return std::nullopt;
+}
+
+class ProfilerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init() {
+        Profiler::reset();
+    }
+
+    void testNestedScopes() {
+        for (int i = 0; i < 2; ++i) {
+            outer();
+        }
+
+        std::optional<ProfileEntry> outerEntry = findEntry("test outer");
+        std::optional<ProfileEntry> innerEntry = findEntry("test inner");
+        QVERIFY(outerEntry && innerEntry);
+
+        QCOMPARE(outerEntry->calls, uint64_t(2));
+        QCOMPARE(innerEntry->calls, uint64_t(6));
+
+        // the inner scopes are charged to the outer one, but not to its self time
+        QVERIFY(innerEntry->selfCycles == innerEntry->cycles);
+        QVERIFY(outerEntry->cycles > innerEntry->cycles);
+        QVERIFY(outerEntry->selfCycles < outerEntry->cycles);
+        QVERIFY(outerEntry->selfCycles + innerEntry->cycles <= outerEntry->cycles);
+    }
+
+    void testThreadsAreSummed() {
+        outer();
+
+        // a thread that ended leaves its counters behind
+        std::thread thread([]() {
+            outer();
+            inner();
+        });
+        thread.join();
+
+        QCOMPARE(findEntry("test outer")->calls, uint64_t(2));
+        QCOMPARE(findEntry("test inner")->calls, uint64_t(7));
+
+        QString report = Profiler::report();
+        QVERIFY(report.contains("test outer"));
+        QVERIFY(report.contains("test inner"));
+
+        Profiler::reset();
+        QCOMPARE(findEntry("test inner")->calls, uint64_t(0));
+        QVERIFY(!Profiler::report().contains("test inner"));
+    }
+};
+
+QTEST_MAIN(ProfilerTest)
+#include "test_profiler.moc"
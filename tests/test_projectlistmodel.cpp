@@ -0,0 +1,98 @@
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+#include <QTest>
+
+#include "project_hub/projectlistmodel.h"
+
+class ProjectListModelTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static Project project(ProjectType type, const QString& title, const QString& shortDescription) {
+        Project project;
+        project.type = type;
+        project.title = title;
+        project.shortDescription = shortDescription;
+        project.description = title + " in detail";
+        return project;
+    }
+
+    const QVector<Project> m_projects = {
+        project(ProjectType::QtWidgets, "Chess", "Play against a bot"),
+        project(ProjectType::Qml, "Clock", "A clock in QML"),
+        project(ProjectType::QtWidgets, "Paint", "Draw with the mouse"),
+    };
+
+private slots:
+    void testRowsAndRoles() {
+        ProjectListModel model(&m_projects);
+        QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+        QCOMPARE(model.rowCount(), 3);
+
+        // a flat list, rows have no children
+        QCOMPARE(model.rowCount(model.index(0)), 0);
+
+        QModelIndex clock = model.index(1);
+        QCOMPARE(clock.data(Qt::DisplayRole).toString(), QString("Clock"));
+        QCOMPARE(clock.data(Qt::ToolTipRole).toString(), QString("Clock in detail"));
+        QCOMPARE(clock.data(ProjectListModel::ShortDescriptionRole).toString(), QString("A clock in QML"));
+        QCOMPARE(clock.data(ProjectListModel::TypeRole).toInt(), static_cast<int>(ProjectType::Qml));
+        QCOMPARE(clock.data(ProjectListModel::ProjectIndexRole).toInt(), 1);
+
+        QCOMPARE(model.index(0).data(ProjectListModel::TypeRole).toInt(), static_cast<int>(ProjectType::QtWidgets));
+
+        // roles the model doesn't know and rows it doesn't have
+        QVERIFY(!clock.data(Qt::DecorationRole).isValid());
+        QVERIFY(!model.data(QModelIndex()).isValid());
+        QVERIFY(!model.index(3).isValid());
+    }
+
+    void testProjectIndices() {
+        ProjectListModel model(&m_projects);
+        QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+        model.setProjectIndices({2, 0});
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(model.rowCount(), 2);
+
+        // rows map to the projects in the given order
+        QCOMPARE(model.index(0).data(ProjectListModel::ProjectIndexRole).toInt(), 2);
+        QCOMPARE(model.index(0).data(Qt::DisplayRole).toString(), QString("Paint"));
+        QCOMPARE(model.index(1).data(ProjectListModel::ProjectIndexRole).toInt(), 0);
+        QCOMPARE(model.index(1).data(Qt::DisplayRole).toString(), QString("Chess"));
+        QVERIFY(!model.index(2).isValid());
+
+        model.setProjectIndices({});
+        QCOMPARE(model.rowCount(), 0);
+
+        model.setProjectIndices({0, 1, 2});
+        QCOMPARE(model.index(1).data(ProjectListModel::ProjectIndexRole).toInt(), 1);
+        QCOMPARE(resetSpy.count(), 3);
+    }
+
+    void testTileSizeIsFixed() {
+        QVector<Project> projects = m_projects;
+        projects.append(project(ProjectType::Qml, QString(500, 'x'), QString(500, 'y')));
+
+        ProjectListModel model(&projects);
+        ProjectTileDelegate delegate;
+        QStyleOptionViewItem option;
+
+        // every tile has the same size whatever its text, and room for the title and the description
+        QSize size = delegate.sizeHint(option, model.index(0));
+        QVERIFY(size.height() > QFontMetrics(option.font).height() * 2);
+
+        for (int row = 0; row < model.rowCount(); ++row) {
+            QCOMPARE(delegate.sizeHint(option, model.index(row)), size);
+        }
+
+        option.rect = QRect(0, 0, 1000, 1000);
+        QCOMPARE(delegate.sizeHint(option, model.index(3)), size);
+    }
+};
+
+QTEST_MAIN(ProjectListModelTest)
+#include "test_projectlistmodel.moc"
@@ -0,0 +1,80 @@
+#include <QTest>
+
+#include "project_hub/projectsearchindex.h"
+
+class ProjectSearchTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static Project project(const QString& title, const QString& shortDescription = QString(), const QString& description = QString()) {
+        Project project;
+        project.type = ProjectType::QtWidgets;
+        project.title = title;
+        project.shortDescription = shortDescription;
+        project.description = description;
+        return project;
+    }
+
+    QVector<Project> m_projects = {
+        project("First Project", "This is my first project"),
+        project("Learn QML", "This is my first QML project"),
+        project("Chess Game", "A networked multiplayer chess game."),
+        project("Board Games", "Collection", "Checkers, chess variants and go"),
+        project("Café Finder", "Maps"),
+    };
+
+private slots:
+    void testNormalize() {
+        QCOMPARE(ProjectSearchIndex::normalize("Café-Finder 2!"), QString("cafe finder 2 "));
+    }
+
+    void testEmptyQuery() {
+        ProjectSearchIndex index(m_projects);
+        QCOMPARE(index.projectCount(), 5);
+        QCOMPARE(index.search(""), QVector<int>({0, 1, 2, 3, 4}));
+        QCOMPARE(index.search("  - "), QVector<int>({0, 1, 2, 3, 4}));
+    }
+
+    void testTitleRanksFirst() {
+        ProjectSearchIndex index(m_projects);
+
+        // the chess game has it in its title, the board games only in the description
+        QCOMPARE(index.search("chess"), QVector<int>({2, 3}));
+        QCOMPARE(index.search("CHESS game"), QVector<int>({2, 3}));
+    }
+
+    void testPrefix() {
+        ProjectSearchIndex index(m_projects);
+
+        QVERIFY(index.search("ch").startsWith({2}));
+        QCOMPARE(index.search("lea"), QVector<int>({1}));
+        QVERIFY(index.search("netw").contains(2));
+    }
+
+    void testFuzzy() {
+        ProjectSearchIndex index(m_projects);
+
+        QVERIFY(index.search("chss").startsWith({2}));
+        QCOMPARE(index.search("cafe"), QVector<int>({4}));
+        QCOMPARE(index.search("qml").first(), 1);
+
+        QVERIFY(index.search("xylophone").isEmpty());
+    }
+
+    void testLargeCatalog() {
+        QVector<Project> projects;
+        for (int i = 0; i < 5000; ++i) {
+            projects.append(project(QString("Tool %1").arg(i), "An internal tool", "Does internal things"));
+        }
+        projects.append(project("Chess Game"));
+
+        ProjectSearchIndex index(projects);
+        QCOMPARE(index.search("chess"), QVector<int>({5000}));
+        QCOMPARE(index.search("tool 4999").first(), 4999);
+        QCOMPARE(index.search("internal").count(), 5000);
+    }
+};
+
+QTEST_MAIN(ProjectSearchTest)
+#include "test_projectsearch.moc"
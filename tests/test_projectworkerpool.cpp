@@ -0,0 +1,159 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLibrary>
+#include <QSignalSpy>
+#include <QTest>
+
+#include "project_hub/processstats.h"
+#include "project_hub/projectworkerpool.h"
+#include "project_hub/tracerecorder.h"
+
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#endif
+
+class ProjectWorkerPoolTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QString chessPluginPath() {
+        QDir directory(PROJECT_PLUGIN_DIR);
+        for (const QString& fileName : directory.entryList(QDir::Files)) {
+            if(QLibrary::isLibrary(fileName))
+            {
+                return directory.absoluteFilePath(fileName);
+            }
+        }
+
+        return QString();
+    }
+
+    static ProjectProcessState stateOf(const ProjectWorkerPool& pool, int id) {
+        for (const ProjectProcess& process : pool.processes()) {
+            if(process.id == id)
+            {
+                return process.state;
+            }
+        }
+
+        return ProjectProcessState::Failed;
+    }
+
+#ifdef Q_OS_UNIX
+    // Launched projects outlive their pool, tests end them like a user closing the window would
+    static bool endProject(qint64 processId) {
+        return ::kill(processId, SIGTERM) == 0;
+    }
+
+    static bool isAlive(qint64 processId) {
+        return ::kill(processId, 0) == 0;
+    }
+#endif
+
+private slots:
+    void testProcessStats() {
+#ifdef Q_OS_LINUX
+        // Burn a little CPU time so there is some to measure
+        volatile uint64_t sum = 0;
+        for (uint64_t i = 0; i < 50000000; ++i) {
+            sum += i;
+        }
+
+        std::optional<ProcessStats> stats = readProcessStats(QCoreApplication::applicationPid());
+        QVERIFY(stats);
+        QVERIFY(stats->cpuTimeMs > 0);
+        QVERIFY(stats->residentBytes > 1024 * 1024);
+#endif
+        QVERIFY(!readProcessStats(-1));
+    }
+
+    void testLaunchInWorker() {
+        TraceRecorder& recorder = TraceRecorder::instance();
+        recorder.setEnabled(true);
+        recorder.clear();
+
+        ProjectWorkerPool pool(HUB_PROGRAM, 1);
+        QCOMPARE(pool.warmWorkerCount(), 1);
+
+        QSignalSpy failures(&pool, &ProjectWorkerPool::launchFailed);
+
+        int id = pool.launch("Chess Game", chessPluginPath());
+        QCOMPARE(pool.processes().count(), 1);
+        QCOMPARE(pool.processes()[0].title, QString("Chess Game"));
+
+        // another worker is started to take the next launch
+        QCOMPARE(pool.warmWorkerCount(), 1);
+
+        QTRY_VERIFY_WITH_TIMEOUT(stateOf(pool, id) == ProjectProcessState::Running, 30000);
+        QVERIFY(pool.latestProcess(chessPluginPath()));
+        QVERIFY(pool.latestProcess(chessPluginPath())->processId > 0);
+        QVERIFY(failures.isEmpty());
+
+        // the launch is traced until the worker reports the project's window on screen
+        QTRY_VERIFY_WITH_TIMEOUT(recorder.toChromeTraceJson().contains("launch until exposed"), 10000);
+        recorder.setEnabled(false);
+
+#ifdef Q_OS_LINUX
+        QTRY_VERIFY_WITH_TIMEOUT(pool.latestProcess(chessPluginPath())->residentBytes > 0, 5000);
+#endif
+
+#ifdef Q_OS_UNIX
+        // the project is gone, the pool remembers how it ended and still has a warm worker
+        QVERIFY(endProject(pool.latestProcess(chessPluginPath())->processId));
+        QTRY_VERIFY_WITH_TIMEOUT(stateOf(pool, id) == ProjectProcessState::Crashed, 5000);
+        QCOMPARE(pool.processes().count(), 1);
+        QCOMPARE(pool.warmWorkerCount(), 1);
+#endif
+    }
+
+    void testProjectsOutliveThePool() {
+#ifdef Q_OS_UNIX
+        qint64 processId = 0;
+        QElapsedTimer timer;
+
+        {
+            ProjectWorkerPool pool(HUB_PROGRAM, 1);
+            int id = pool.launch("Chess Game", chessPluginPath());
+            QTRY_VERIFY_WITH_TIMEOUT(stateOf(pool, id) == ProjectProcessState::Running, 30000);
+
+            processId = pool.latestProcess(chessPluginPath())->processId;
+            timer.start();
+        }
+
+        // the pool neither waited for the project nor ended it
+        QVERIFY(timer.elapsed() < 1000);
+        QTest::qWait(500);
+        QVERIFY(isAlive(processId));
+
+        QVERIFY(endProject(processId));
+        QTRY_VERIFY_WITH_TIMEOUT(!isAlive(processId), 5000);
+#endif
+    }
+
+    void testLaunchFailure() {
+        ProjectWorkerPool pool(HUB_PROGRAM, 0);
+        QSignalSpy failures(&pool, &ProjectWorkerPool::launchFailed);
+
+        int id = pool.launch("Missing", QDir(PROJECT_PLUGIN_DIR).filePath("missing"));
+
+        QTRY_COMPARE_WITH_TIMEOUT(failures.count(), 1, 30000);
+        QCOMPARE(stateOf(pool, id), ProjectProcessState::Failed);
+        QVERIFY(!pool.processes()[0].error.isEmpty());
+
+        // the missing program never starts
+        ProjectWorkerPool brokenPool(QDir(PROJECT_PLUGIN_DIR).filePath("missing"), 0);
+        QSignalSpy brokenFailures(&brokenPool, &ProjectWorkerPool::launchFailed);
+        int brokenId = brokenPool.launch("Chess Game", chessPluginPath());
+        QTRY_COMPARE_WITH_TIMEOUT(brokenFailures.count(), 1, 5000);
+        QCOMPARE(stateOf(brokenPool, brokenId), ProjectProcessState::Failed);
+
+        // a warm worker that can't start doesn't count as one
+        ProjectWorkerPool brokenWarmPool(QDir(PROJECT_PLUGIN_DIR).filePath("missing"), 1);
+        QTRY_COMPARE_WITH_TIMEOUT(brokenWarmPool.warmWorkerCount(), 0, 5000);
+    }
+};
+
+QTEST_MAIN(ProjectWorkerPoolTest)
+#include "test_projectworkerpool.moc"
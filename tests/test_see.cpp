@@ -0,0 +1,59 @@
+#include <QTest>
+
+#include "chess/see.h"
+
+using namespace Chess;
+
+class StaticExchangeTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static int see(const char* fen, const char* move) {
+        Position position = *Position::fromFen(fen);
+        std::optional<Move> legalMove = findUciMove(position, move);
+        return legalMove ? staticExchangeEvaluation(position, *legalMove) : -1;
+    }
+
+private slots:
+    void testUndefendedCapture() {
+        QCOMPARE(see("4k3/8/8/3p4/8/8/8/3RK3 w - - 0 1", "d1d5"), 100);
+        QCOMPARE(see("4k3/8/8/3n4/8/8/8/3QK3 w - - 0 1", "d1d5"), 320);
+    }
+
+    void testDefendedCaptureLosesMaterial() {
+        QCOMPARE(see("4k3/8/2p5/3p4/8/8/8/3QK3 w - - 0 1", "d1d5"), 100 - 900);
+
+        // an even trade
+        QCOMPARE(see("4k3/8/2p5/3n4/8/4N3/8/4K3 w - - 0 1", "e3d5"), 0);
+
+        // a quiet move onto an attacked square just loses the piece
+        QCOMPARE(see("4k3/8/2p5/8/8/8/8/3QK3 w - - 0 1", "d1d5"), -900);
+    }
+
+    void testXRayRecapture() {
+        // without the queen behind the rook, black wins the exchange
+        QCOMPARE(see("3r2k1/8/8/3p4/8/8/3R4/6K1 w - - 0 1", "d2d5"), 100 - 500);
+
+        // the queen recaptures through the square the rook left, so black won't take back
+        QCOMPARE(see("3r2k1/8/8/3p4/8/8/3R4/3Q2K1 w - - 0 1", "d2d5"), 100);
+
+        // the battery works for the defender as well
+        QCOMPARE(see("3q2k1/3r4/8/3p4/8/8/3R4/3Q2K1 w - - 0 1", "d2d5"), 100 - 500);
+    }
+
+    void testKingRecapture() {
+        QCOMPARE(see("6k1/5p2/8/8/8/8/5R2/6K1 w - - 0 1", "f2f7"), 100 - 500);
+
+        // the king can't recapture onto a square the other rook still defends
+        QCOMPARE(see("6k1/5p2/8/8/8/8/5R2/5RK1 w - - 0 1", "f2f7"), 100);
+    }
+
+    void testEnPassant() {
+        QCOMPARE(see("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6"), 100);
+        QCOMPARE(see("4k3/2p5/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6"), 0);
+    }
+};
+
+QTEST_MAIN(StaticExchangeTest)
+#include "test_see.moc"
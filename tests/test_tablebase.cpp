@@ -0,0 +1,96 @@
+#include <QTest>
+#include <QTemporaryDir>
+
+#include "chess/search.h"
+#include "chess/tablebase.h"
+#include "chess/tablebasegenerator.h"
+
+using namespace Chess;
+
+class TablebaseTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static std::optional<Wdl> probeWdl(const char* fen) {
+        std::optional<Position> position = Position::fromFen(fen);
+        return position ? Tablebases::instance().probeWdl(*position) : std::nullopt;
+    }
+
+    QTemporaryDir m_directory;
+
+private slots:
+    void initTestCase() {
+        QVERIFY(m_directory.isValid());
+
+        TablebaseGenerator generator(m_directory.path());
+        QVERIFY(generator.generate("KQvK"));
+        QVERIFY(generator.generate("KRvK"));
+        QVERIFY(generator.generate("KPvK"));
+
+        // KPvK needs the tables of every promotion as well
+        QCOMPARE(Tablebases::instance().load(m_directory.path()), 5);
+        QCOMPARE(Tablebases::instance().maxPieces(), 3);
+    }
+
+    void cleanupTestCase() {
+        Tablebases::instance().unload();
+    }
+
+    void testInvalidSignatures() {
+        TablebaseGenerator generator(m_directory.path());
+        QVERIFY(!generator.generate("KQ"));
+        QVERIFY(!generator.generate("QvK"));
+        QVERIFY(!generator.generate("KQRBvK"));
+    }
+
+    void testWdl() {
+        QVERIFY(probeWdl("k7/8/8/8/8/8/5Q2/K7 w - - 0 1") == Wdl::Win);
+        QVERIFY(probeWdl("7k/8/8/8/8/8/8/K5R1 w - - 0 1") == Wdl::Win);
+
+        // the same material from black's side
+        QVERIFY(probeWdl("8/8/8/8/8/2k5/1q6/K7 w - - 0 1") == Wdl::Loss);
+
+        // stalemate
+        QVERIFY(probeWdl("k7/2Q5/1K6/8/8/8/8/8 b - - 0 1") == Wdl::Draw);
+
+        QVERIFY(probeWdl("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1") == Wdl::Loss);
+        QVERIFY(probeWdl("8/8/8/4k3/8/8/4P3/4K3 w - - 0 1") == Wdl::Draw);
+        QVERIFY(probeWdl("8/8/8/8/8/5k2/4p3/6K1 b - - 0 1") == Wdl::Win);
+
+        // castling rights and missing tables are never probed
+        QVERIFY(probeWdl("4k3/8/8/8/8/8/8/R3K3 w Q - 0 1") == std::nullopt);
+        QVERIFY(probeWdl("4k3/8/8/8/8/8/8/QR2K3 w - - 0 1") == std::nullopt);
+    }
+
+    void testBestMoveMates() {
+        Position position = *Position::fromFen("7k/8/8/8/8/8/8/K5R1 w - - 0 1");
+
+        int plies = 0;
+        while(!position.getLegalMoves().empty() && plies < 100)
+        {
+            std::optional<Move> move = Tablebases::instance().bestMove(position);
+            QVERIFY(move);
+
+            position.doMove(*move);
+            plies++;
+        }
+
+        QVERIFY(position.isKingInCheck());
+        QCOMPARE(position.currentPlayer(), Color::Black);
+    }
+
+    void testSearchUsesTablebases() {
+        Position position = *Position::fromFen("k7/8/8/8/8/8/5Q2/K7 w - - 0 1");
+
+        Search search;
+        SearchResult result = search.search(position, SearchLimits{});
+
+        QVERIFY(result.bestMove);
+        QCOMPARE(result.score, TABLEBASE_WIN_SCORE);
+        QCOMPARE(result.nodes, uint64_t(0));
+    }
+};
+
+QTEST_MAIN(TablebaseTest)
+#include "test_tablebase.moc"
@@ -0,0 +1,91 @@
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "project_hub/tracerecorder.h"
+
+using namespace std::chrono;
+
+class TraceRecorderTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QJsonArray traceEvents(const TraceRecorder& recorder) {
+        QJsonDocument document = QJsonDocument::fromJson(recorder.toChromeTraceJson());
+        return document.object().value("traceEvents").toArray();
+    }
+
+private slots:
+    void testDisabledRecordsNothing() {
+        TraceRecorder recorder;
+        QVERIFY(!recorder.isEnabled());
+
+        auto now = TraceRecorder::Clock::now();
+        recorder.addSpan("span", now, now);
+
+        QCOMPARE(recorder.spanCount(), size_t(0));
+        QVERIFY(traceEvents(recorder).isEmpty());
+    }
+
+    void testChromeTraceFormat() {
+        TraceRecorder recorder(16, true);
+
+        auto start = TraceRecorder::processStart() + milliseconds(5);
+        recorder.addSpan("first paint", start, start + microseconds(1500), "Project Hub");
+
+        QJsonArray events = traceEvents(recorder);
+        QCOMPARE(events.count(), 1);
+
+        QJsonObject event = events[0].toObject();
+        QCOMPARE(event["name"].toString(), QString("first paint"));
+        QCOMPARE(event["ph"].toString(), QString("X"));
+        QCOMPARE(event["ts"].toDouble(), 5000.0);
+        QCOMPARE(event["dur"].toDouble(), 1500.0);
+        QCOMPARE(event["args"].toObject()["detail"].toString(), QString("Project Hub"));
+        QVERIFY(event.contains("pid"));
+        QVERIFY(event.contains("tid"));
+    }
+
+    void testRingBufferKeepsNewest() {
+        TraceRecorder recorder(3, true);
+
+        static const char* names[] = {"a", "b", "c", "d", "e"};
+        for (int i = 0; i < 5; ++i) {
+            auto start = TraceRecorder::processStart() + milliseconds(i);
+            recorder.addSpan(names[i], start, start);
+        }
+
+        QCOMPARE(recorder.spanCount(), size_t(3));
+
+        QJsonArray events = traceEvents(recorder);
+        QCOMPARE(events.count(), 3);
+        QCOMPARE(events[0].toObject()["name"].toString(), QString("c"));
+        QCOMPARE(events[1].toObject()["name"].toString(), QString("d"));
+        QCOMPARE(events[2].toObject()["name"].toString(), QString("e"));
+
+        recorder.clear();
+        QCOMPARE(recorder.spanCount(), size_t(0));
+    }
+
+    void testWriteChromeTrace() {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+
+        TraceRecorder recorder(16, true);
+        auto now = TraceRecorder::Clock::now();
+        recorder.addSpan("launch call", now, now + milliseconds(2), "Chess Game");
+
+        QString path = directory.filePath("trace.json");
+        QVERIFY(recorder.writeChromeTrace(path));
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), recorder.toChromeTraceJson());
+    }
+};
+
+QTEST_MAIN(TraceRecorderTest)
+#include "test_tracerecorder.moc"